@@ -23,6 +23,9 @@
 /* ========================================================================== */
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <ti/drv/enet/enet.h>
+#include <ti/drv/enet/include/phy/enetphy.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +38,30 @@ extern "C" {
 /*! \brief Number of LEDs available in the LAN8720 PHY. */
 #define LAN8720_LED_NUM       (4U)
 
+/*! \brief Maximum number of fragments accepted by Ethernet_sendPacketSg(). */
+#define ETHERNET_TX_FRAG_MAX  (4U)
+
+/*! \brief Number of released RX buffers batched before the free queue is refilled. */
+#define ETHERNET_RX_REFILL_BATCH  (8U)
+
+/*! \brief Maximum number of RX channels per port. */
+#define ETHERNET_CHAN_MAX  (4U)
+
+/*! \brief Set to 1 to record latency histograms of the send, receive and
+ *         MDIO paths. Compiled out, and free of any cost, by default. */
+#ifndef LAN8720_CFG_LATENCY_HIST
+#define LAN8720_CFG_LATENCY_HIST  (0)
+#endif
+
+/*! \brief Number of log2 buckets of a latency histogram. */
+#define ETHERNET_LAT_BUCKET_NUM  (32U)
+
+/*! \brief Maximum number of register updates in a configuration plan. */
+#define LAN8720_CFG_PLAN_MAX  (8U)
+
+/*! \brief Flag set in Lan8720_CfgOp::reg for extended (MMD) registers. */
+#define LAN8720_CFG_OP_EXT    (0x8000U)
+
 /* ========================================================================== */
 /*                         Structures and Enums                               */
 /* ========================================================================== */
@@ -130,6 +157,590 @@ typedef struct LAN8720_Cfg_s
     LAN8720_LedMode ledMode[LAN8720_LED_NUM];
 } LAN8720_Cfg;
 
+/*!
+ * \brief Register update of a configuration plan.
+ */
+typedef struct Lan8720_CfgOp_s
+{
+    /*! Register address, ORed with #LAN8720_CFG_OP_EXT for extended registers */
+    uint16_t reg;
+
+    /*! Bits updated; 0xFFFF overwrites the register without reading it */
+    uint16_t mask;
+
+    /*! New value of the updated bits */
+    uint16_t val;
+} Lan8720_CfgOp;
+
+/*!
+ * \brief Register write plan of a LAN8720_Cfg.
+ *
+ * Holds one update per register, in ascending address order, with the
+ * settings of all fields sharing a register merged. The plan only depends
+ * on the configuration, so it can be built once and kept as a constant.
+ */
+typedef struct Lan8720_CfgPlan_s
+{
+    /*! Number of valid entries in \c ops */
+    uint32_t num;
+
+    /*! Register updates */
+    Lan8720_CfgOp ops[LAN8720_CFG_PLAN_MAX];
+} Lan8720_CfgPlan;
+
+/*!
+ * \brief PHY register shadow cache counters.
+ */
+typedef struct Lan8720_ShadowStats_s
+{
+    /*! Register reads served from the shadow */
+    uint32_t hits;
+
+    /*! Reads of shadowed registers that had to go over MDIO */
+    uint32_t misses;
+
+    /*! Writes skipped because the register already held the value */
+    uint32_t skippedWrites;
+
+    /*! Number of times the shadow was invalidated by a reset */
+    uint32_t invalidations;
+} Lan8720_ShadowStats;
+
+/*!
+ * \brief MDIO transaction counters.
+ */
+typedef struct Lan8720_MdioStats_s
+{
+    /*! Number of MDIO read frames */
+    uint32_t reads;
+
+    /*! Number of MDIO write frames */
+    uint32_t writes;
+} Lan8720_MdioStats;
+
+/*!
+ * \brief Operations of the asynchronous MDIO request queue.
+ */
+typedef enum Lan8720_MdioOp_e
+{
+    /*! Read a clause 22 register */
+    LAN8720_MDIO_OP_READ = 0,
+
+    /*! Write a clause 22 register */
+    LAN8720_MDIO_OP_WRITE,
+
+    /*! Read-modify-write a clause 22 register */
+    LAN8720_MDIO_OP_RMW,
+
+    /*! Read an extended (MMD) register */
+    LAN8720_MDIO_OP_EXT_READ,
+
+    /*! Write an extended (MMD) register */
+    LAN8720_MDIO_OP_EXT_WRITE,
+
+    /*! Read-modify-write an extended (MMD) register */
+    LAN8720_MDIO_OP_EXT_RMW,
+} Lan8720_MdioOp;
+
+/*!
+ * \brief Completion callback of an asynchronous MDIO request.
+ *
+ * Called from Lan8720_mdioQueueIsr(), so usually in interrupt context.
+ *
+ * \param cbArg   Argument given when the request was posted
+ * \param status  ENETPHY_SOK, or ENETPHY_EFAIL if the PHY did not acknowledge
+ * \param val     Value read, or value written by a read-modify-write
+ */
+typedef void (*Lan8720_MdioCb)(void *cbArg, int32_t status, uint16_t val);
+
+/*!
+ * \brief Transmit fragment descriptor (iovec-style).
+ *
+ * A frame is described as a list of fragments, e.g. a protocol header
+ * followed by the payload, which are gathered into one DMA packet.
+ */
+typedef struct Ethernet_TxFrag_s
+{
+    /*! Pointer to the fragment data */
+    const void *buf;
+
+    /*! Fragment length in bytes */
+    uint32_t len;
+} Ethernet_TxFrag;
+
+/*!
+ * \brief Transmit priority classes of the TX pacing queues.
+ *
+ * While the link is paced, frames of a higher class always leave before
+ * frames of a lower one.
+ */
+typedef enum Ethernet_TxPrio_e
+{
+    ETHERNET_TX_PRIO_NORMAL = 0U,  /*!< Default class of the transmit APIs */
+    ETHERNET_TX_PRIO_HIGH   = 1U,  /*!< Control traffic, e.g. PTP or keep-alives */
+    ETHERNET_TX_PRIO_NUM    = 2U
+} Ethernet_TxPrio;
+
+/*!
+ * \brief Frame descriptor used by the burst transmit and receive APIs.
+ */
+typedef struct Ethernet_Frame_s
+{
+    /*! Pointer to the frame data */
+    void *buf;
+
+    /*! Capacity of \c buf in bytes (receive only) */
+    uint32_t size;
+
+    /*! Frame length in bytes */
+    uint32_t len;
+} Ethernet_Frame;
+
+/*!
+ * \brief DMA transmit buffer loaned to the caller.
+ *
+ * Filled in by Ethernet_acquireTxBuffer(). The caller builds the frame in
+ * place in \c data and hands it back with Ethernet_submitTxBuffer(), or
+ * returns it unused with Ethernet_releaseTxBuffer().
+ */
+typedef struct Ethernet_TxBuf_s
+{
+    /*! Driver-private DMA packet handle */
+    void *pkt;
+
+    /*! Start of the DMA packet buffer */
+    uint8_t *data;
+
+    /*! Capacity of \c data in bytes */
+    uint32_t size;
+} Ethernet_TxBuf;
+
+/*!
+ * \brief Received frame loaned to the caller.
+ *
+ * Filled in by Ethernet_receiveLoan(). The frame is read in place from the
+ * DMA packet buffer and must be given back with Ethernet_releaseRxPacket().
+ */
+typedef struct Ethernet_RxBuf_s
+{
+    /*! Driver-private DMA packet handle */
+    void *pkt;
+
+    /*! Start of the received frame */
+    const uint8_t *data;
+
+    /*! Frame length in bytes */
+    uint32_t len;
+} Ethernet_RxBuf;
+
+/*!
+ * \brief Receive mode of the adaptive RX engine.
+ */
+typedef enum Ethernet_RxMode_e
+{
+    ETHERNET_RX_MODE_INTR = 0U,  /*!< Sleeping until the next RX interrupt */
+    ETHERNET_RX_MODE_POLL = 1U   /*!< Busy polling with RX interrupts masked */
+} Ethernet_RxMode;
+
+/*!
+ * \brief Adaptive RX engine parameters.
+ */
+typedef struct Ethernet_RxPollCfg_s
+{
+    /*! Maximum number of frames processed per poll iteration. With a single
+     *  RX channel, the DMA is only polled while fewer frames than this wait
+     *  for the application. */
+    uint32_t budget;
+
+    /*! Consecutive empty polls before falling back to interrupt mode */
+    uint32_t maxEmptyPolls;
+} Ethernet_RxPollCfg;
+
+/*!
+ * \brief Adaptive RX engine counters.
+ */
+typedef struct Ethernet_RxPollStats_s
+{
+    /*! Time spent waiting for interrupts, in microseconds */
+    uint64_t intrModeUs;
+
+    /*! Time spent busy polling, in microseconds */
+    uint64_t pollModeUs;
+
+    /*! Number of switches from interrupt to polling mode */
+    uint32_t intrToPoll;
+
+    /*! Number of switches from polling to interrupt mode */
+    uint32_t pollToIntr;
+
+    /*! Number of poll iterations */
+    uint32_t polls;
+
+    /*! Number of poll iterations that found no frame */
+    uint32_t emptyPolls;
+
+    /*! Number of frames processed in polling mode */
+    uint32_t pktsPolled;
+} Ethernet_RxPollStats;
+
+/*!
+ * \brief Data path counters used to measure the transmit and receive paths.
+ */
+typedef struct Ethernet_PerfStats_s
+{
+    /*! Frames submitted for transmission */
+    uint32_t txFrames;
+
+    /*! Bytes submitted for transmission */
+    uint64_t txBytes;
+
+    /*! Bytes copied by the driver on the transmit path */
+    uint64_t txBytesCopied;
+
+    /*! Frames delivered to the application */
+    uint32_t rxFrames;
+
+    /*! Bytes delivered to the application */
+    uint64_t rxBytes;
+
+    /*! Bytes copied by the driver on the receive path */
+    uint64_t rxBytesCopied;
+
+    /*! Frames dropped because the DMA refused them */
+    uint32_t txDrops;
+
+    /*! Frames truncated to the DMA packet size on transmit */
+    uint32_t txTruncated;
+
+    /*! Frames truncated to the caller buffer on receive */
+    uint32_t rxTruncated;
+} Ethernet_PerfStats;
+
+/*!
+ * \brief TX packet pool counters of one core.
+ */
+typedef struct Ethernet_PoolStats_s
+{
+    /*! Number of packets carved for the pool */
+    uint32_t size;
+
+    /*! Packets currently free */
+    uint32_t freeCnt;
+
+    /*! Lowest number of free packets observed */
+    uint32_t minFree;
+
+    /*! Allocations that found the pool empty */
+    uint32_t allocFail;
+
+    /*! Times the free count dropped below the low watermark */
+    uint32_t lowWmCrossings;
+} Ethernet_PoolStats;
+
+/*!
+ * \brief TX completion reclamation counters.
+ */
+typedef struct Ethernet_TxReclaimStats_s
+{
+    /*! Packets submitted to the DMA and not reclaimed yet */
+    uint32_t inFlight;
+
+    /*! Highest in-flight depth observed */
+    uint32_t maxInFlight;
+
+    /*! Reclaim passes that returned at least one packet */
+    uint32_t reclaims;
+
+    /*! Packets returned to the pool */
+    uint32_t pktsReclaimed;
+
+    /*! Shortest submit-to-reclaim time, in microseconds */
+    uint32_t latMinUs;
+
+    /*! Longest submit-to-reclaim time, in microseconds */
+    uint32_t latMaxUs;
+
+    /*! Sum of submit-to-reclaim times, in microseconds */
+    uint64_t latSumUs;
+} Ethernet_TxReclaimStats;
+
+/*!
+ * \brief TX pacing counters.
+ */
+typedef struct Ethernet_TxPaceStats_s
+{
+    /*! Rate frames are released to the DMA at, in kbit/s, 0 while the link
+     *  is down and frames are submitted directly */
+    uint32_t rateKbps;
+
+    /*! Frames waiting in each priority queue */
+    uint32_t queued[ETHERNET_TX_PRIO_NUM];
+
+    /*! Highest depth of each priority queue */
+    uint32_t maxQueued[ETHERNET_TX_PRIO_NUM];
+
+    /*! Frames dropped because their priority queue was full */
+    uint32_t drops[ETHERNET_TX_PRIO_NUM];
+
+    /*! Release passes stopped by the token bucket */
+    uint32_t throttled;
+
+    /*! Release passes stopped by the DMA queue depth limit */
+    uint32_t hwFull;
+} Ethernet_TxPaceStats;
+
+/*!
+ * \brief RX channel counters.
+ */
+typedef struct Ethernet_ChanStats_s
+{
+    /*! Frames steered to the channel */
+    uint32_t steered;
+
+    /*! Frames taken by the channel consumer */
+    uint32_t rxFrames;
+
+    /*! Bytes taken by the channel consumer */
+    uint64_t rxBytes;
+
+    /*! Times the consumer slept on an empty channel and was woken */
+    uint32_t wakeups;
+
+    /*! Highest number of frames waiting for the consumer */
+    uint32_t maxBacklog;
+} Ethernet_ChanStats;
+
+/*!
+ * \brief Negotiated link parameters.
+ *
+ * Obtained with Ethernet_getLinkParams() once auto-negotiation completed,
+ * kept by the application in non-volatile storage and passed back through
+ * Ethernet_PortCfg at the next boot to skip the auto-negotiation wait.
+ */
+typedef struct Ethernet_LinkParams_s
+{
+    /*! Link partner abilities, as read from ANLPAR */
+    uint16_t partnerAbility;
+
+    /*! Resolved speed and duplex, PHY_SCS_SPEED_INDI bits of the special
+     *  control/status register */
+    uint16_t speedIndi;
+} Ethernet_LinkParams;
+
+/*!
+ * \brief Link bring-up timings of a port.
+ *
+ * Times are in microseconds since the port initialization started, 0 if
+ * the event did not happen yet.
+ */
+typedef struct Ethernet_BootStats_s
+{
+    /*! Link was forced from cached parameters */
+    bool fastLink;
+
+    /*! Forced link did not come up and auto-negotiation was used instead */
+    bool fallback;
+
+    /*! Re-check of the forced link found a partner different from the
+     *  cache, and the link was auto-negotiated */
+    bool partnerChanged;
+
+    /*! First link up */
+    uint32_t linkUpUs;
+
+    /*! First frame transmitted */
+    uint32_t firstTxUs;
+
+    /*! First frame received */
+    uint32_t firstRxUs;
+} Ethernet_BootStats;
+
+/*!
+ * \brief Binary trace events.
+ *
+ * Values are part of the trace format decoded by
+ * script_j784s4/lan8720_trace.py and must not be renumbered.
+ */
+typedef enum Ethernet_TraceEvent_e
+{
+    ETHERNET_TRACE_TX            = 1U,  /*!< Frame submitted: len, status */
+    ETHERNET_TRACE_TX_BURST      = 2U,  /*!< Burst submitted: len = bytes, arg = frames */
+    ETHERNET_TRACE_TX_ALLOC_FAIL = 3U,  /*!< No TX packet available */
+    ETHERNET_TRACE_TX_RECLAIM    = 4U,  /*!< Completions reclaimed: arg = packets */
+    ETHERNET_TRACE_RX            = 5U,  /*!< Frame received: len */
+    ETHERNET_TRACE_CHAN_RX       = 6U,  /*!< Frame consumed from a channel: len, arg = channel */
+    ETHERNET_TRACE_DEV_EVENT     = 7U,  /*!< Device task woken: arg = event mask */
+    ETHERNET_TRACE_LINK          = 8U   /*!< Link change: arg = 1 if up */
+} Ethernet_TraceEvent;
+
+/*!
+ * \brief Binary trace record, 16 bytes.
+ */
+typedef struct Ethernet_TraceRec_s
+{
+    /*! Low 32 bits of the time in microseconds */
+    uint32_t timeUs;
+
+    /*! Event, one of #Ethernet_TraceEvent */
+    uint16_t event;
+
+    /*! MAC port of the traced port */
+    uint8_t port;
+
+    /*! Event status, 0 on success */
+    int8_t status;
+
+    /*! Length in bytes */
+    uint32_t len;
+
+    /*! Event specific argument */
+    uint32_t arg;
+} Ethernet_TraceRec;
+
+/*!
+ * \brief Operations timed by the latency histograms.
+ */
+typedef enum Ethernet_LatOp_e
+{
+    ETHERNET_LAT_SEND       = 0U,  /*!< Ethernet_sendPacket() */
+    ETHERNET_LAT_RECEIVE    = 1U,  /*!< Ethernet_receivePacket() */
+    ETHERNET_LAT_MDIO_READ  = 2U,  /*!< One MDIO read frame */
+    ETHERNET_LAT_MDIO_WRITE = 3U,  /*!< One MDIO write frame */
+    ETHERNET_LAT_EXT_RMW    = 4U,  /*!< Extended register read-modify-write */
+    ETHERNET_LAT_OP_NUM     = 5U   /*!< Number of timed operations */
+} Ethernet_LatOp;
+
+/*!
+ * \brief Latency histogram of one operation.
+ *
+ * Latencies are in ticks of the timestamp source: CPU cycles from the PMU
+ * cycle counter on the R5F, nanoseconds in a host build. Bucket \c n
+ * counts latencies in [2^(n-1), 2^n), bucket 0 counts zero and the last
+ * bucket also takes anything longer.
+ */
+typedef struct Ethernet_LatHist_s
+{
+    /*! Number of samples */
+    uint32_t count;
+
+    /*! Shortest latency */
+    uint32_t min;
+
+    /*! Longest latency */
+    uint32_t max;
+
+    /*! Sum of all latencies */
+    uint64_t sum;
+
+    /*! Samples per log2 bucket */
+    uint32_t bucket[ETHERNET_LAT_BUCKET_NUM];
+} Ethernet_LatHist;
+
+/*!
+ * \brief Port bring-up states, advanced by Ethernet_initTick().
+ */
+typedef enum Ethernet_InitState_e
+{
+    ETHERNET_INIT_RESET      = 0U,  /*!< PHY soft reset to be issued */
+    ETHERNET_INIT_WAIT_RESET = 1U,  /*!< Waiting for the PHY reset to complete */
+    ETHERNET_INIT_CONFIG     = 2U,  /*!< PHY to be configured */
+    ETHERNET_INIT_AUTONEG    = 3U,  /*!< Waiting for the link to come up */
+    ETHERNET_INIT_LINK_UP    = 4U,  /*!< Link came up, bring-up complete */
+    ETHERNET_INIT_FAILED     = 5U,  /*!< PHY reset or configuration failed */
+    ETHERNET_INIT_STATE_NUM  = 6U   /*!< Number of bring-up states */
+} Ethernet_InitState;
+
+/*!
+ * \brief Port bring-up profile.
+ *
+ * Times are in microseconds since Ethernet_initAsync() was called, 0 for
+ * states not entered or not left yet.
+ */
+typedef struct Ethernet_InitProfile_s
+{
+    /*! Current bring-up state */
+    Ethernet_InitState state;
+
+    /*! Time each state was entered */
+    uint32_t entryUs[ETHERNET_INIT_STATE_NUM];
+
+    /*! Time each state was left */
+    uint32_t exitUs[ETHERNET_INIT_STATE_NUM];
+} Ethernet_InitProfile;
+
+/*!
+ * \brief Port statistics snapshot returned by Ethernet_getStats().
+ */
+typedef struct Ethernet_Stats_s
+{
+    /*! Time the snapshot was taken, in microseconds */
+    uint64_t timeUs;
+
+    /*! Data path counters summed over all cores */
+    Ethernet_PerfStats perf;
+
+    /*! TX allocations that found the pool empty, all cores */
+    uint32_t txAllocFail;
+
+    /*! Free TX packets, all cores */
+    uint32_t txPoolFree;
+
+    /*! TX completion reclamation counters */
+    Ethernet_TxReclaimStats txReclaim;
+
+    /*! Frames steered to the RX channels and not consumed yet */
+    uint32_t rxBacklog;
+
+    /*! Link state at the last PHY check */
+    uint8_t linkUp;
+
+    /*! PHY symbol errors counted since the port was brought up */
+    uint32_t symbolErrors;
+
+    /*! PHY symbol errors per second over the last sampling period */
+    uint32_t symbolErrorRate;
+} Ethernet_Stats;
+
+/*!
+ * \brief Per-port driver context.
+ *
+ * Opaque handle returned by Ethernet_init(). Each port owns its DMA queues,
+ * packet pools and statistics, so ports can be driven concurrently from
+ * different tasks.
+ */
+typedef struct Lan8720_Ctx_s Lan8720_Ctx;
+
+/*!
+ * \brief Port configuration passed to Ethernet_init().
+ */
+typedef struct Ethernet_PortCfg_s
+{
+    /*! Enet instance the port belongs to, shared by all its ports */
+    Enet_Handle hEnet;
+
+    /*! MAC port the LAN8720 is attached to */
+    Enet_MacPort macPort;
+
+    /*! MDIO address of the LAN8720 */
+    uint32_t phyAddr;
+
+    /*! Interface between the MAC port and the LAN8720, MII or RMII */
+    EnetPhy_Mii mii;
+
+    /*! Number of RX channels, 1 to #ETHERNET_CHAN_MAX. With more than one,
+     *  received frames are steered to the channels by flow hash; with one
+     *  they are read with Ethernet_receivePacket() and the like */
+    uint32_t numChans;
+
+    /*! Link parameters cached from a previous boot, NULL to always
+     *  auto-negotiate */
+    const Ethernet_LinkParams *linkParams;
+
+    /*! LAN8720 configuration applied when the PHY is configured, NULL to
+     *  only set the MII mode */
+    const LAN8720_Cfg *phyCfg;
+} Ethernet_PortCfg;
+
 /* ========================================================================== */
 /*                          Function Declarations                             */
 /* ========================================================================== */
@@ -144,6 +755,759 @@ typedef struct LAN8720_Cfg_s
  */
 void Lan8720_initCfg(LAN8720_Cfg *cfg);
 
+/*!
+ * \brief Build the register write plan of a LAN8720 configuration.
+ *
+ * Fields with an out-of-range value are left out of the plan.
+ *
+ * \param cfg   LAN8720 configuration, NULL to only set the MII mode
+ * \param mii   MAC interface mode
+ * \param plan  Filled in with the plan
+ *
+ * \return ENETPHY_SOK, or ENETPHY_EINVALIDPARAMS if a field was left out.
+ */
+int32_t Lan8720_buildCfgPlan(const LAN8720_Cfg *cfg, EnetPhy_Mii mii, Lan8720_CfgPlan *plan);
+
+/*!
+ * \brief Install a precomputed register write plan for a PHY.
+ *
+ * The plan is applied by the PHY config hook instead of one built from
+ * the extended configuration, e.g. a constant plan generated offline with
+ * Lan8720_buildCfgPlan() for a fixed board configuration. A later
+ * Lan8720_reconfigure() of the PHY replaces it.
+ *
+ * \param phyAddr  MDIO address of the PHY
+ * \param plan     Plan to apply, kept by reference; NULL to go back to
+ *                 building it
+ */
+void Lan8720_setCfgPlan(uint32_t phyAddr, const Lan8720_CfgPlan *plan);
+
+/*!
+ * \brief Change the configuration of a running LAN8720.
+ *
+ * The two configurations are diffed and only the registers whose settings
+ * changed are written. LED modes, GPIO mux and output impedance are applied
+ * live; any other change needs a soft restart of the PHY, which drops the
+ * link for as long as it takes to come back up, and is done here. The new
+ * configuration is also what the PHY config hook applies from then on,
+ * with the MII mode already in use.
+ *
+ * \param hPhy       PHY handle
+ * \param oldCfg     Configuration currently applied, NULL if unknown in
+ *                   which case every setting is written
+ * \param newCfg     Configuration to apply
+ * \param restarted  Set to true if the PHY was restarted, may be NULL
+ *
+ * \return ENETPHY_SOK, or ENETPHY_EINVALIDPARAMS if \c oldCfg or \c newCfg
+ *         has an out-of-range field, in which case nothing is written.
+ */
+int32_t Lan8720_reconfigure(EnetPhy_Handle hPhy, const LAN8720_Cfg *oldCfg,
+                            const LAN8720_Cfg *newCfg, bool *restarted);
+
+/*!
+ * \brief Read a run of consecutive extended registers.
+ *
+ * Sets the MMD window up once and reads the registers in its
+ * post-increment data mode, so a run of \c count registers costs
+ * \c count + 3 MDIO frames where single accesses would cost 4 each.
+ * Shadowed registers in the run are refreshed.
+ *
+ * \param hPhy   PHY handle
+ * \param reg    Address of the first extended register
+ * \param vals   Filled in with \c count register values
+ * \param count  Number of registers
+ *
+ * \return ENETPHY_SOK, ENETPHY_EINVALIDPARAMS if the run is empty or goes
+ *         past the last extended register, or the status of the first
+ *         failed MDIO read.
+ */
+int32_t Lan8720_readExtRegs(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *vals, uint32_t count);
+
+/*!
+ * \brief Write a run of consecutive extended registers.
+ *
+ * Same MDIO cost as Lan8720_readExtRegs(). Shadowed registers in the run
+ * are updated, or invalidated if their write failed.
+ *
+ * \param hPhy   PHY handle
+ * \param reg    Address of the first extended register
+ * \param vals   \c count values to write
+ * \param count  Number of registers
+ *
+ * \return ENETPHY_SOK, ENETPHY_EINVALIDPARAMS if the run is empty or goes
+ *         past the last extended register, or the status of the first
+ *         failed MDIO write.
+ */
+int32_t Lan8720_writeExtRegs(EnetPhy_Handle hPhy, uint32_t reg, const uint16_t *vals,
+                             uint32_t count);
+
+/*!
+ * \brief Get the register shadow cache counters of a PHY.
+ *
+ * \param phyAddr  MDIO address of the PHY
+ * \param stats    Filled in with the counters
+ */
+void Lan8720_getShadowStats(uint32_t phyAddr, Lan8720_ShadowStats *stats);
+
+/*!
+ * \brief Get the MDIO transaction counters of a PHY.
+ *
+ * Counts every MDIO frame issued by this driver for the PHY, which makes
+ * it possible to compare the cost of configuration sequences.
+ *
+ * \param phyAddr  MDIO address of the PHY
+ * \param stats    Filled in with the counters
+ */
+void Lan8720_getMdioStats(uint32_t phyAddr, Lan8720_MdioStats *stats);
+
+/*!
+ * \brief Set up the asynchronous MDIO request queue.
+ *
+ * The queue drives USER_GROUP[1] of the MDIO controller directly, leaving
+ * group 0 to the blocking accesses of the Enet LLD. Each frame is started
+ * by setting the GO bit and the next one is issued from the completion
+ * interrupt, so no caller ever waits on the bus. The user interrupt of the
+ * controller must be routed to Lan8720_mdioQueueIsr().
+ *
+ * \param mdioBaseAddr  Base address of the MDIO controller
+ *
+ * \return ENETPHY_SOK, or ENETPHY_EPERM if the user group is busy.
+ */
+int32_t Lan8720_openMdioQueue(uintptr_t mdioBaseAddr);
+
+/*!
+ * \brief Post an asynchronous MDIO request.
+ *
+ * Requests complete in posting order. Extended register requests use the
+ * MMD window of the PHY, which they share with the blocking extended
+ * register accesses of the driver: each side waits for the other to finish
+ * its sequence on the same PHY, so the two can be mixed freely.
+ *
+ * \param phyAddr  MDIO address of the PHY
+ * \param op       Operation
+ * \param reg      Register address
+ * \param mask     Bits modified by a read-modify-write, ignored otherwise
+ * \param val      Value to write
+ * \param cb       Completion callback, may be NULL
+ * \param cbArg    Argument passed to the callback
+ *
+ * \return ENETPHY_SOK, ENETPHY_EALLOC if the queue is full or ENETPHY_EPERM
+ *         if it was not opened.
+ */
+int32_t Lan8720_postMdio(uint32_t phyAddr, Lan8720_MdioOp op, uint32_t reg,
+                         uint16_t mask, uint16_t val, Lan8720_MdioCb cb, void *cbArg);
+
+/*!
+ * \brief MDIO user access interrupt handler.
+ *
+ * Completes the frame in flight and starts the next one. Does nothing
+ * while a frame is still on the bus, so it can also be polled.
+ */
+void Lan8720_mdioQueueIsr(void);
+
+/*!
+ * \brief Initialize a port configuration with the default MAC port, PHY
+ *        address and RMII.
+ *
+ * \param cfg  Port configuration; \c hEnet must still be set by the caller
+ */
+void Ethernet_initPortCfg(Ethernet_PortCfg *cfg);
+
+/*!
+ * \brief Initialize the Ethernet driver and the LAN8720 PHY of one port.
+ *
+ * May be called once per port; ports on the same Enet instance and MDIO
+ * bus share them. Any active fast MDIO mode is dropped since the new PHY
+ * does not have preamble bypass enabled yet.
+ *
+ * Runs the bring-up of Ethernet_initAsync() until auto-negotiation is
+ * started, sleeping while the PHY resets. If the bring-up fails, the
+ * context and its TX packets are released again; the RX buffers stay with
+ * the DMA of the MAC port.
+ *
+ * \param cfg  Port configuration
+ *
+ * \return Port context, or NULL if the configuration is invalid, all
+ *         contexts are in use or the PHY could not be reset or configured.
+ */
+Lan8720_Ctx *Ethernet_init(const Ethernet_PortCfg *cfg);
+
+/*!
+ * \brief Start the initialization of one port without waiting on the PHY.
+ *
+ * Sets up the Enet instance, DMA queues and packet pools and returns with
+ * the PHY bring-up in #ETHERNET_INIT_RESET. The bring-up is then advanced
+ * by Ethernet_initTick(), which Ethernet_deviceMain() calls, so several
+ * PHYs can be brought up in parallel from one task.
+ *
+ * \param cfg  Port configuration
+ *
+ * \return Port context, or NULL if the configuration is invalid or all
+ *         contexts are in use.
+ */
+Lan8720_Ctx *Ethernet_initAsync(const Ethernet_PortCfg *cfg);
+
+/*!
+ * \brief Advance the bring-up of a port by at most one step.
+ *
+ * Never blocks. Call periodically, every few milliseconds while the state
+ * is before #ETHERNET_INIT_AUTONEG. Once the link is being negotiated it
+ * also supervises the link.
+ *
+ * \param ctx  Port context
+ *
+ * \return The bring-up state after the step.
+ */
+Ethernet_InitState Ethernet_initTick(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief Get the bring-up profile of a port.
+ *
+ * \param ctx      Port context
+ * \param profile  Filled in with the state and its timestamps
+ */
+void Ethernet_getInitProfile(Lan8720_Ctx *ctx, Ethernet_InitProfile *profile);
+
+/*!
+ * \brief Configure the LAN8720 PHY and start auto-negotiation.
+ *
+ * Applies the MII mode and the LAN8720 configuration of the port first,
+ * which a PHY reset leaves at their defaults. With cached link parameters
+ * in the port configuration, the cached speed and duplex are forced
+ * instead so the link comes up without waiting for auto-negotiation. The
+ * device task then falls back to auto-negotiation if the forced link does
+ * not come up, or if it counted more than ETHERNET_CFG_LINK_VERIFY_SYM_ERRS
+ * symbol errors after a few seconds; otherwise the forced link is kept.
+ * Building the driver with ETHERNET_CFG_LINK_RECHECK_ANEG set to 1
+ * re-checks the partner with auto-negotiation instead, which briefly drops
+ * the link.
+ *
+ * \param ctx  Port context
+ *
+ * \return 0 on success, -1 if the configuration is invalid or could not be
+ *         written to the PHY.
+ */
+int Ethernet_config(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief Transmit a frame held in one contiguous buffer.
+ *
+ * \param ctx   Port context
+ * \param data  Pointer to the frame data
+ * \param len   Frame length in bytes
+ *
+ * \return 0 on success, -1 if no DMA packet was available or if the TX
+ *         pacing queue was full.
+ */
+int Ethernet_sendPacket(Lan8720_Ctx *ctx, const void *data, size_t len);
+
+/*!
+ * \brief Transmit a frame held in one contiguous buffer with a given
+ * priority.
+ *
+ * Once the link is up, frames are released to the DMA at the negotiated
+ * rate and only a few are kept in the DMA queue at any time. The excess
+ * waits in one software queue per priority class, so a high priority
+ * frame only waits behind the frames already handed to the DMA.
+ *
+ * \param ctx   Port context
+ * \param data  Pointer to the frame data
+ * \param len   Frame length in bytes
+ * \param prio  Priority class
+ *
+ * \return 0 on success, -1 on invalid arguments, if no DMA packet was
+ *         available or if the queue of \c prio was full.
+ */
+int Ethernet_sendPacketPrio(Lan8720_Ctx *ctx, const void *data, size_t len, Ethernet_TxPrio prio);
+
+/*!
+ * \brief Transmit a frame described by a list of fragments.
+ *
+ * The fragments are gathered directly into the DMA packet buffer, without
+ * any intermediate staging copy.
+ *
+ * \param ctx       Port context
+ * \param frags     Array of fragment descriptors
+ * \param numFrags  Number of fragments, at most #ETHERNET_TX_FRAG_MAX
+ *
+ * \return 0 on success, -1 on invalid arguments, if no DMA packet was
+ *         available or if the TX pacing queue was full.
+ */
+int Ethernet_sendPacketSg(Lan8720_Ctx *ctx, const Ethernet_TxFrag *frags, uint32_t numFrags);
+
+/*!
+ * \brief Transmit a batch of frames with a single DMA queue submission.
+ *
+ * Frames are accepted in order until the DMA packet supply runs out or
+ * the TX pacing queue is full. The caller should retry the remaining
+ * frames later.
+ *
+ * \param ctx     Port context
+ * \param frames  Array of frames; only \c buf and \c len are used
+ * \param count   Number of frames in \c frames
+ *
+ * \return Number of frames accepted for transmission.
+ */
+uint32_t Ethernet_sendBurst(Lan8720_Ctx *ctx, const Ethernet_Frame *frames, uint32_t count);
+
+/*!
+ * \brief Borrow a DMA transmit buffer to build a frame in place.
+ *
+ * \param ctx    Port context
+ * \param txBuf  Filled in with the loaned buffer
+ *
+ * \return 0 on success, -1 if no DMA packet was available.
+ */
+int Ethernet_acquireTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf);
+
+/*!
+ * \brief Submit a buffer obtained with Ethernet_acquireTxBuffer().
+ *
+ * Ownership of the buffer passes back to the driver.
+ *
+ * \param ctx    Port context
+ * \param txBuf  Loaned buffer
+ * \param len    Number of bytes written to \c txBuf->data
+ *
+ * \return 0 on success, -1 on invalid arguments or if the TX pacing queue
+ *         was full.
+ */
+int Ethernet_submitTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf, size_t len);
+
+/*!
+ * \brief Return an unused buffer obtained with Ethernet_acquireTxBuffer().
+ *
+ * \param ctx    Port context
+ * \param txBuf  Loaned buffer
+ */
+void Ethernet_releaseTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf);
+
+/*!
+ * \brief Receive a frame into a caller-provided buffer.
+ *
+ * \param ctx     Port context
+ * \param buffer  Destination buffer
+ * \param maxLen  Size of \c buffer in bytes
+ *
+ * \return Number of bytes received, or -1 if no frame was available.
+ */
+int Ethernet_receivePacket(Lan8720_Ctx *ctx, void *buffer, size_t maxLen);
+
+/*!
+ * \brief Receive a batch of frames into caller-provided buffers.
+ *
+ * Every frame retrieved from the DMA RX queue is delivered, up to
+ * \c maxFrames; any excess is kept for the next call. Frames longer than
+ * \c frames[i].size are truncated. The DMA buffers are recycled to the RX
+ * free queue in one batch.
+ *
+ * \param ctx        Port context
+ * \param frames     Array of frames; \c buf and \c size are set by the
+ *                   caller, \c len is filled in by the driver
+ * \param maxFrames  Number of entries in \c frames
+ *
+ * \return Number of frames received.
+ */
+uint32_t Ethernet_receiveBurst(Lan8720_Ctx *ctx, Ethernet_Frame *frames, uint32_t maxFrames);
+
+/*!
+ * \brief Receive frames without copying them out of the DMA buffers.
+ *
+ * Each returned entry is a read-only view of a DMA packet buffer which
+ * stays owned by the caller until it is passed to Ethernet_releaseRxPacket().
+ *
+ * \param ctx        Port context
+ * \param rxBufs     Array filled in with the loaned frames
+ * \param maxFrames  Number of entries in \c rxBufs
+ *
+ * \return Number of frames loaned.
+ */
+uint32_t Ethernet_receiveLoan(Lan8720_Ctx *ctx, Ethernet_RxBuf *rxBufs, uint32_t maxFrames);
+
+/*!
+ * \brief Give back a frame obtained with Ethernet_receiveLoan().
+ *
+ * Released buffers are returned to the DMA RX free queue in batches of
+ * #ETHERNET_RX_REFILL_BATCH. May run concurrently with the device task,
+ * which hands back a short batch on its idle wakeups.
+ *
+ * \param ctx    Port context
+ * \param rxBuf  Loaned frame
+ */
+void Ethernet_releaseRxPacket(Lan8720_Ctx *ctx, Ethernet_RxBuf *rxBuf);
+
+/*!
+ * \brief Get the PHY link status.
+ *
+ * \param ctx  Port context
+ *
+ * \return 1 if the link is up, 0 otherwise.
+ */
+uint8_t Ethernet_getStatus(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief Get the result of the last completed auto-negotiation.
+ *
+ * \param ctx     Port context
+ * \param params  Filled in with the negotiated parameters
+ *
+ * \return 0 on success, -1 if no auto-negotiation completed on the port.
+ */
+int Ethernet_getLinkParams(Lan8720_Ctx *ctx, Ethernet_LinkParams *params);
+
+/*!
+ * \brief Change the LAN8720 configuration of a running port.
+ *
+ * Writes only what differs from the configuration currently applied, see
+ * Lan8720_reconfigure(). Must not run concurrently with the device task,
+ * which shares the MDIO bus.
+ *
+ * \param ctx  Port context
+ * \param cfg  New configuration
+ *
+ * \return 0 if the changes were applied live, 1 if the PHY had to be
+ *         restarted, -1 on error.
+ */
+int Ethernet_reconfigurePhy(Lan8720_Ctx *ctx, const LAN8720_Cfg *cfg);
+
+/*!
+ * \brief Get the link bring-up timings of a port.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the timings
+ */
+void Ethernet_getBootStats(Lan8720_Ctx *ctx, Ethernet_BootStats *stats);
+
+/*!
+ * \brief Enable MDIO preamble suppression (fast MDIO).
+ *
+ * Sets the Management Data Preamble Bypass bit of every open LAN8720 and
+ * makes the MDIO controller omit the 32-bit preamble, which roughly halves
+ * the length of every management frame. All open ports must sit on the
+ * given MDIO bus. Falls back to the standard preamble if the controller
+ * does not support it or a PHY stops answering correctly. A PHY reset or
+ * opening a further port drops back to the standard preamble and clears
+ * the bypass bit in every open PHY.
+ *
+ * \param mdioBaseAddr  Base address of the MDIO controller registers
+ *
+ * \return 0 on success, -1 if fast MDIO could not be enabled.
+ */
+int Ethernet_enableFastMdio(uintptr_t mdioBaseAddr);
+
+/*!
+ * \brief Restore the standard MDIO preamble.
+ */
+void Ethernet_disableFastMdio(void);
+
+/*!
+ * \brief Monitor the link of a port with the MDIO controller.
+ *
+ * The controller polls the PHY in hardware, so Ethernet_getStatus()
+ * becomes a register read and a stable link costs no MDIO traffic nor CPU
+ * time. Up to two ports also get the MDIO link interrupt, which must then
+ * be routed to Ethernet_mdioLinkIsr().
+ *
+ * On a host build, \c mdioBaseAddr may point to a zeroed CSL_mdioRegs in
+ * RAM; setting its ALIVE, LINK and LINK_INT_RAW bits and calling
+ * Ethernet_mdioLinkIsr() then plays the part of the controller.
+ *
+ * \param ctx           Port context
+ * \param mdioBaseAddr  Base address of the MDIO controller
+ *
+ * \return 0 on success, -1 if the controller does not see the PHY.
+ */
+int Ethernet_enableHwLinkPoll(Lan8720_Ctx *ctx, uintptr_t mdioBaseAddr);
+
+/*!
+ * \brief Stop monitoring the link of a port with the MDIO controller.
+ *
+ * \param ctx  Port context
+ */
+void Ethernet_disableHwLinkPoll(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief MDIO link interrupt handler.
+ *
+ * Call from the link interrupt of the MDIO controller. Acknowledges it and
+ * wakes the device task of the ports whose link changed.
+ */
+void Ethernet_mdioLinkIsr(void);
+
+/*!
+ * \brief PHY interrupt handler.
+ *
+ * Call from the interrupt connected to the nINT pin of the port's LAN8720.
+ * Wakes the device task, which reads and clears the PHY interrupt source.
+ *
+ * \param ctx  Port context
+ */
+void Ethernet_phyIsr(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief DMA RX completion callback.
+ *
+ * Register as the notify callback of the RX channel so that received
+ * frames wake the device task.
+ *
+ * \param cbArg  Port context
+ */
+void Ethernet_rxNotify(void *cbArg);
+
+/*!
+ * \brief DMA TX completion callback.
+ *
+ * Register as the notify callback of the TX channel so that completed
+ * packets are reclaimed by the device task.
+ *
+ * \param cbArg  Port context
+ */
+void Ethernet_txNotify(void *cbArg);
+
+/*!
+ * \brief Reclaim completed TX packets into the packet pool.
+ *
+ * Called by the device task on TX completion events and when a sender
+ * finds its pool below the low watermark, or from the sender itself in
+ * polled mode. May also be called by the application, from any core; the
+ * retrieval from the DMA and the counters are serialized across cores by
+ * the TX lock.
+ *
+ * \param ctx  Port context
+ *
+ * \return Number of packets reclaimed.
+ */
+uint32_t Ethernet_reclaimTx(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief Get the TX completion counters.
+ *
+ * The average reclaim latency is \c latSumUs / \c pktsReclaimed.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the counters
+ */
+void Ethernet_getTxReclaimStats(Lan8720_Ctx *ctx, Ethernet_TxReclaimStats *stats);
+
+/*!
+ * \brief Get the TX pacing counters.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the counters
+ */
+void Ethernet_getTxPaceStats(Lan8720_Ctx *ctx, Ethernet_TxPaceStats *stats);
+
+/*!
+ * \brief Set the adaptive RX engine parameters.
+ *
+ * Zero values are rejected and the previous parameters are kept.
+ *
+ * \param ctx  Port context
+ * \param cfg  Budget and empty-poll threshold
+ */
+void Ethernet_setRxPollCfg(Lan8720_Ctx *ctx, const Ethernet_RxPollCfg *cfg);
+
+/*!
+ * \brief Get the adaptive RX engine counters.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the counters
+ */
+void Ethernet_getRxPollStats(Lan8720_Ctx *ctx, Ethernet_RxPollStats *stats);
+
+/*!
+ * \brief Get the data path counters.
+ *
+ * Together with Lan8720_getMdioStats() this gives frames, bytes, bytes
+ * copied and MDIO transactions for a measurement window. The counters are
+ * kept per core and summed here.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the counters
+ */
+void Ethernet_getPerfStats(Lan8720_Ctx *ctx, Ethernet_PerfStats *stats);
+
+/*!
+ * \brief Clear the data path counters.
+ *
+ * \param ctx  Port context
+ */
+void Ethernet_resetPerfStats(Lan8720_Ctx *ctx);
+
+/*!
+ * \brief Get the data path counters of one core.
+ *
+ * \param ctx      Port context
+ * \param coreIdx  Core index, as for Ethernet_getPoolStats()
+ * \param stats    Filled in with the counters, zeroed for an invalid core
+ */
+void Ethernet_getCoreStats(Lan8720_Ctx *ctx, uint32_t coreIdx, Ethernet_PerfStats *stats);
+
+/*!
+ * \brief Take a snapshot of all the counters of a port.
+ *
+ * Reads no PHY register: the symbol error counter is sampled by the
+ * device task once per sampling period. Cheap enough to be polled by a
+ * monitoring task.
+ *
+ * \param ctx    Port context
+ * \param stats  Filled in with the snapshot
+ */
+void Ethernet_getStats(Lan8720_Ctx *ctx, Ethernet_Stats *stats);
+
+/*!
+ * \brief Set the TX packet pool watermarks.
+ *
+ * The pool is flagged as under pressure when its free count drops below
+ * \c lowWm and the flag clears once it is back at \c highWm.
+ *
+ * \param ctx     Port context
+ * \param lowWm   Low watermark, in packets
+ * \param highWm  High watermark, in packets
+ *
+ * \return 0 on success, -1 on invalid watermarks.
+ */
+int Ethernet_setPoolWatermarks(Lan8720_Ctx *ctx, uint32_t lowWm, uint32_t highWm);
+
+/*!
+ * \brief Get the TX packet pool counters of a core.
+ *
+ * \param ctx      Port context
+ * \param coreIdx  Pool index
+ * \param stats    Filled in with the counters
+ */
+void Ethernet_getPoolStats(Lan8720_Ctx *ctx, uint32_t coreIdx, Ethernet_PoolStats *stats);
+
+/*!
+ * \brief Compute the flow hash of a frame.
+ *
+ * Covers the MAC addresses, the IPv4/IPv6 addresses and protocol, and the
+ * TCP/UDP ports of unfragmented packets, so all frames of a flow hash
+ * alike.
+ *
+ * \param frame  Frame data, starting at the destination MAC address
+ * \param len    Frame length in bytes
+ *
+ * \return Flow hash.
+ */
+uint32_t Ethernet_flowHash(const uint8_t *frame, uint32_t len);
+
+/*!
+ * \brief Get the RX channel a frame's flow is steered to.
+ *
+ * Sending a flow from the worker of this channel keeps it on one core and
+ * in order in both directions.
+ *
+ * \param ctx    Port context
+ * \param frame  Frame data
+ * \param len    Frame length in bytes
+ *
+ * \return Channel index.
+ */
+uint32_t Ethernet_flowChannel(Lan8720_Ctx *ctx, const void *frame, uint32_t len);
+
+/*!
+ * \brief Receive frames handed to an RX channel by the device task.
+ *
+ * Frames are taken from a lock-free single-producer/single-consumer ring
+ * filled from the RX completion path; the call only blocks, if \c wait is
+ * set, while the ring is empty. At most one task may consume a channel.
+ * Each frame must be given back with Ethernet_releaseChanPacket(). Only
+ * for ports with more than one channel.
+ *
+ * \param ctx        Port context
+ * \param chIdx      Channel index
+ * \param rxBufs     Array filled in with the loaned frames
+ * \param maxFrames  Number of entries in \c rxBufs
+ * \param wait       Block until at least one frame is available
+ *
+ * \return Number of frames loaned.
+ */
+uint32_t Ethernet_receiveChan(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_RxBuf *rxBufs,
+                              uint32_t maxFrames, bool wait);
+
+/*!
+ * \brief Give back a frame obtained with Ethernet_receiveChan().
+ *
+ * The device task recycles the buffers once #ETHERNET_RX_REFILL_BATCH of
+ * them are back, or after a short idle time.
+ *
+ * \param ctx    Port context
+ * \param chIdx  Channel the frame was received on
+ * \param rxBuf  Loaned frame
+ */
+void Ethernet_releaseChanPacket(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_RxBuf *rxBuf);
+
+/*!
+ * \brief RX channel worker task entry point.
+ *
+ * Default consumer of a channel, for applications that do not call
+ * Ethernet_receiveChan() themselves. Run one task per channel on the core
+ * the channel is pinned to.
+ *
+ * \param ctx    Port context
+ * \param chIdx  Channel index
+ */
+void Ethernet_chanMain(Lan8720_Ctx *ctx, uint32_t chIdx);
+
+/*!
+ * \brief Get the counters of an RX channel.
+ *
+ * \param ctx    Port context
+ * \param chIdx  Channel index
+ * \param stats  Filled in with the counters
+ */
+void Ethernet_getChanStats(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_ChanStats *stats);
+
+/*!
+ * \brief Get the binary trace ring.
+ *
+ * The ring starts with four 32-bit words (magic, record size and record
+ * count as two 16-bit halves, number of records written, reserved)
+ * followed by the #Ethernet_TraceRec records. It can be dumped as is and
+ * decoded offline with script_j784s4/lan8720_trace.py. Which events are
+ * recorded follows ENET_CFG_TRACE_LEVEL: failures from WARN, link changes
+ * from INFO and per-packet events from DEBUG only.
+ *
+ * \param size  Filled in with the size of the ring in bytes, 0 if tracing
+ *              is compiled out
+ *
+ * \return Start of the ring, NULL if tracing is compiled out.
+ */
+const void *Ethernet_getTrace(uint32_t *size);
+
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+/*!
+ * \brief Get the latency histogram of an operation.
+ *
+ * Histograms are shared by all ports. Updates are not atomic, so a sample
+ * may rarely be lost when two cores time the same operation at once.
+ *
+ * \param op    Timed operation
+ * \param hist  Filled in with the histogram, zeroed for an invalid op
+ */
+void Ethernet_getLatencyHist(Ethernet_LatOp op, Ethernet_LatHist *hist);
+
+/*!
+ * \brief Clear all latency histograms.
+ */
+void Ethernet_resetLatencyHist(void);
+
+/*!
+ * \brief Print all non-empty latency histograms on the console.
+ */
+void Ethernet_dumpLatencyHist(void);
+#endif
+
+/*!
+ * \brief Ethernet device task entry point.
+ *
+ * Initializes the port and services it forever. Run one task per port.
+ *
+ * \param cfg  Port configuration
+ */
+void Ethernet_deviceMain(const Ethernet_PortCfg *cfg);
+
 #ifdef __cplusplus
 }
 #endif
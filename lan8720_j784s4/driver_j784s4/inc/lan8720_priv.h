@@ -137,6 +137,8 @@ extern "C" {
 #define PHY_SCS_AUTODONE              (1U << 12)   /*!< Auto-negotiation done indication */
 #define PHY_SCS_ENABLE_4B5B           (1U << 6)    /*!< Enable 4B/5B encoding/decoding */
 #define PHY_SCS_SPEED_INDI            ((1U << 4) | (1U << 3))
+#define PHY_SCS_SPEED_100             (1U << 3)    /*!< Resolved speed is 100 Mbps */
+#define PHY_SCS_FULL_DUPLEX           (1U << 4)    /*!< Resolved duplex is full */
 #define PHY_SCS_SCRAMBLE_DISABLE      (0U)         /*!< Enable data scrambling*/
 
 /* LED Control Register */
@@ -147,7 +149,10 @@ extern "C" {
  * ------------------------------------------------------------------------- */
 
 /* RMII Control Register for enabling RMII mode and clock delay adjustments */ 
-#define LAN8720_RMIICTL          (0x32U)  /*!< RMII Control Register */  // Note: Renamed to RMIICTL to reflect RMII usage in code\n#define RMIICTL_RMIIEN          (1U << 7) /*!< Enable RMII mode */\n#define RMIICTL_TXCLKDLY        (1U << 1) /*!< Enable TX clock delay */\n#define RMIICTL_RXCLKDLY        (1U << 0) /*!< Enable RX clock delay */
+#define LAN8720_RMIICTL          (0x32U)  /*!< RMII Control Register */
+#define RMIICTL_RMIIEN           (1U << 7) /*!< Enable RMII mode */
+#define RMIICTL_TXCLKDLY         (1U << 1) /*!< Enable TX clock delay */
+#define RMIICTL_RXCLKDLY         (1U << 0) /*!< Enable RX clock delay */
 
 /* Viterbi Module Configuration Register (for idle threshold settings) */
 #define LAN8720_VTMCFG           (0x53U)  /*!< VTM Configuration Register */
@@ -208,14 +213,6 @@ extern "C" {
 #define RMIIDCTL_DELAY_MAX      (4000U) /* 4.00 ns */
 #define RMIIDCTL_DELAY_STEP     (250U)  /* 0.25 ns */
 
-/* Header Definitions Needed to be Considered - Not Configured */
-/* Clock delay definitions (in arbitrary units, e.g., picoseconds) */
-#define RMIICTL_TXCLKDLY                (1000U)
-#define RMIICTL_RXCLKDLY                (1000U)
-
-/* RGMII/RMII Delay Control Register */
-#define LAN8720_RMIIDCTL                (0x86U)
-
 /* TX FIFO depth definitions (using a 16-bit field in PHYCR) */
 #define PHYCR_TXFIFODEPTH_MASK          (0xC000U)
 #define PHYCR_TXFIFODEPTH_3B            (0x0000U)  /* 3 bytes/nibbles depth */
@@ -239,15 +236,14 @@ extern "C" {
 /* FLD Threshold Configuration */
 #define FLDTHRCFG_FLDTHR_MASK           (0x0007U)
 
-/* RGMII (RMII) mode enabling macro */
-#define RMIICTL_RMIIEN                   (1U << 7)
-
 /* Example IOCTL command for setting MAC port state */
 #define ENET_IOCTL_SET_MAC_PORT_STATE    (0x1000U)
 
 #define ENET_DMA_DIR_TX                  (0x1000U)
 
-#ifdef __cplusplus\n
+#define ENET_DMA_DIR_RX                  (0x2000U)
+
+#ifdef __cplusplus
 }
 #endif
 #endif /* LAN8720_PRIV_H_ */
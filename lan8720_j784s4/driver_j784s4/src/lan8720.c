@@ -19,6 +19,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <assert.h>
 #include <ti/drv/enet/include/phy/lan8720.h>         /* Public LAN8720 definitions */
 #include "lan8720_priv.h"                            /* LAN8720 register definitions and macros */
 #include "enetphy_priv.h"                            /* Common PHY definitions */
@@ -29,6 +30,16 @@
 #include <ti/drv/enet/include/phy/enetphy.h>
 #include <ti/csl/cslr_mdio.h>
 #include <ti/drv/enet/priv/core/enet_trace_priv.h>
+#include <ti/osal/SemaphoreP.h>
+#include <ti/osal/TaskP.h>
+#include <ti/osal/TimerP.h>
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+#if defined(__ARM_ARCH_7R__)
+#include <ti/csl/arch/r5/csl_arm_r5_pmu.h>
+#else
+#include <time.h>
+#endif
+#endif
 
 
 /* ========================================================================== */
@@ -36,9 +47,248 @@
 /* ========================================================================== */
 #define ENET_MAC_PORT          ENET_MAC_PORT_1
 #define ENET_PHY_ADDR          0x01
+
+/* Maximum number of ports driven at the same time */
+#ifndef ETHERNET_CFG_PORT_NUM
+#define ETHERNET_CFG_PORT_NUM  (4U)
+#endif
 #define ENET_TX_PKT_SIZE       1500
 #define ENET_RX_PKT_SIZE       1500
 
+/* Event-driven device task: PHY interrupts and DMA RX completions wake the
+ * worker instead of the 1-second poll. Set to 0 for boards without the PHY
+ * nINT line wired. */
+#ifndef ETHERNET_CFG_EVENT_MODE
+#define ETHERNET_CFG_EVENT_MODE  (1)
+#endif
+
+/* Device task events */
+#define ETHERNET_EVENT_PHY     (1U << 0)
+#define ETHERNET_EVENT_RX      (1U << 1)
+#define ETHERNET_EVENT_TX      (1U << 2)
+#define ETHERNET_EVENT_RECYCLE (1U << 3)
+#define ETHERNET_EVENT_LINK    (1U << 4)
+
+/* Number of MDIO user groups, each able to monitor the link of one PHY */
+#define ETHERNET_MDIO_USER_GROUP_NUM  (2U)
+
+/* PHY interrupt sources serviced by the device task */
+#define ETHERNET_PHY_INTR_MASK (INTERRUPT_SOURCE_INT4 | INTERRUPT_SOURCE_INT6 | INTERRUPT_SOURCE_INT7)
+
+/* Pre-allocated packet pools, sized at build time. The TX pool size is per
+ * core and must be a power of two. */
+#ifndef ETHERNET_CFG_TX_POOL_SIZE
+#define ETHERNET_CFG_TX_POOL_SIZE    (32U)
+#endif
+#ifndef ETHERNET_CFG_RX_POOL_SIZE
+#define ETHERNET_CFG_RX_POOL_SIZE    (32U)
+#endif
+#ifndef ETHERNET_CFG_POOL_CORE_NUM
+#define ETHERNET_CFG_POOL_CORE_NUM   (2U)
+#endif
+
+#if ((ETHERNET_CFG_TX_POOL_SIZE & (ETHERNET_CFG_TX_POOL_SIZE - 1U)) != 0U)
+#error "ETHERNET_CFG_TX_POOL_SIZE must be a power of two"
+#endif
+
+/* Slots of each RX channel ring. A ring holding the whole RX pool can
+ * never overflow, which keeps the producer free of any drop path. */
+#ifndef ETHERNET_CFG_RX_RING_SIZE
+#define ETHERNET_CFG_RX_RING_SIZE    (32U)
+#endif
+
+#if ((ETHERNET_CFG_RX_RING_SIZE & (ETHERNET_CFG_RX_RING_SIZE - 1U)) != 0U)
+#error "ETHERNET_CFG_RX_RING_SIZE must be a power of two"
+#endif
+#if (ETHERNET_CFG_RX_RING_SIZE < ETHERNET_CFG_RX_POOL_SIZE)
+#error "ETHERNET_CFG_RX_RING_SIZE must hold the whole RX pool"
+#endif
+
+/* Times a channel consumer finding its ring empty yields and looks again
+ * before it sleeps on the ring semaphore. While frames keep coming this
+ * saves the producer a semaphore post and the consumer a sleep and wakeup
+ * for every batch. */
+#ifndef ETHERNET_CFG_RX_RING_SPINS
+#define ETHERNET_CFG_RX_RING_SPINS   (4U)
+#endif
+
+/* Longest time buffers released by a channel consumer, fewer than
+ * ETHERNET_RX_REFILL_BATCH, wait before the device task recycles them */
+#ifndef ETHERNET_CFG_RX_RECYCLE_IDLE_MS
+#define ETHERNET_CFG_RX_RECYCLE_IDLE_MS  (10U)
+#endif
+
+/* Cache line size used to keep producer and consumer state apart */
+#ifndef ETHERNET_CFG_CACHE_LINE_SIZE
+#define ETHERNET_CFG_CACHE_LINE_SIZE (64U)
+#endif
+#define ETHERNET_CACHE_ALIGNED       __attribute__((aligned(ETHERNET_CFG_CACHE_LINE_SIZE)))
+
+/* Default TX pool watermarks */
+#define ETHERNET_POOL_LOW_WM_DEFAULT   (ETHERNET_CFG_TX_POOL_SIZE / 4U)
+#define ETHERNET_POOL_HIGH_WM_DEFAULT  ((ETHERNET_CFG_TX_POOL_SIZE * 3U) / 4U)
+
+/* Owning pool and index in it of a TX packet, kept in its appPriv field */
+#define ETHERNET_TX_PKT_TAG(core, idx)  ((void *)(uintptr_t)(((core) << 16U) | (idx)))
+#define ETHERNET_TX_PKT_CORE(pkt)       ((uint32_t)(uintptr_t)(pkt)->appPriv >> 16U)
+#define ETHERNET_TX_PKT_IDX(pkt)        ((uint32_t)(uintptr_t)(pkt)->appPriv & 0xFFFFU)
+
+/* Adaptive RX engine defaults */
+#define ETHERNET_RX_POLL_BUDGET_DEFAULT      (16U)
+#define ETHERNET_RX_POLL_MAX_EMPTY_DEFAULT   (4U)
+
+/* Fast link-up: time allowed for a link forced from cached parameters to
+ * come up before falling back to auto-negotiation, and time the forced
+ * link runs before the partner is re-checked. The re-check keeps the link
+ * up unless the symbol error counter grew by more than
+ * ETHERNET_CFG_LINK_VERIFY_SYM_ERRS meanwhile, in which case the link is
+ * auto-negotiated after all; set ETHERNET_CFG_LINK_RECHECK_ANEG to 1 to
+ * always re-check with auto-negotiation, which drops the link while it
+ * runs */
+#ifndef ETHERNET_CFG_FAST_LINK_TIMEOUT_MS
+#define ETHERNET_CFG_FAST_LINK_TIMEOUT_MS    (500U)
+#endif
+#ifndef ETHERNET_CFG_LINK_RECHECK_MS
+#define ETHERNET_CFG_LINK_RECHECK_MS         (5000U)
+#endif
+#ifndef ETHERNET_CFG_LINK_RECHECK_ANEG
+#define ETHERNET_CFG_LINK_RECHECK_ANEG       (0U)
+#endif
+#ifndef ETHERNET_CFG_LINK_VERIFY_SYM_ERRS
+#define ETHERNET_CFG_LINK_VERIFY_SYM_ERRS    (10U)
+#endif
+
+/* Time allowed for the PHY soft reset to complete */
+#ifndef ETHERNET_CFG_RESET_TIMEOUT_MS
+#define ETHERNET_CFG_RESET_TIMEOUT_MS        (100U)
+#endif
+
+/* Sampling period of the PHY symbol error counter */
+#ifndef ETHERNET_CFG_STATS_SAMPLE_MS
+#define ETHERNET_CFG_STATS_SAMPLE_MS         (1000U)
+#endif
+
+/* Link supervision period while the bring-up or a forced link is pending */
+#define ETHERNET_LINK_TICK_MS                (20U)
+
+/* Number of frames loaned per receive call while draining */
+#define ETHERNET_RX_DRAIN_BATCH              (8U)
+
+/* TX pacing. With the link up, frames are released to the DMA through a
+ * token bucket filled at the negotiated rate and holding BURST_US worth of
+ * traffic, with at most HW_DEPTH frames in flight. The excess waits in one
+ * software queue per priority, each holding at most QUEUE_LEN frames. */
+#ifndef ETHERNET_CFG_TX_PACE_HW_DEPTH
+#define ETHERNET_CFG_TX_PACE_HW_DEPTH        (4U)
+#endif
+#ifndef ETHERNET_CFG_TX_PACE_QUEUE_LEN
+#define ETHERNET_CFG_TX_PACE_QUEUE_LEN       (16U)
+#endif
+#ifndef ETHERNET_CFG_TX_PACE_BURST_US
+#define ETHERNET_CFG_TX_PACE_BURST_US        (2000U)
+#endif
+
+/* Device task period while frames wait in the pacing queues */
+#define ETHERNET_TX_PACE_TICK_MS             (1U)
+
+/* Line rates in bytes per millisecond, and the share of it usable on a
+ * half-duplex link once collisions and backoff are accounted for */
+#define ETHERNET_TX_RATE_10M                 (1250U)
+#define ETHERNET_TX_RATE_100M                (12500U)
+#define ETHERNET_TX_HALF_DUPLEX_PCT          (80U)
+
+/* Wire cost of a frame: padding to the minimum size, then preamble, SFD,
+ * FCS and inter-frame gap */
+#define ETHERNET_TX_MIN_FRAME_LEN            (60U)
+#define ETHERNET_TX_WIRE_OVERHEAD            (24U)
+
+/* Ethertypes and IP protocols parsed by the flow hash */
+#define ETHERNET_ETHERTYPE_VLAN              (0x8100U)
+#define ETHERNET_ETHERTYPE_IPV4              (0x0800U)
+#define ETHERNET_ETHERTYPE_IPV6              (0x86DDU)
+#define ETHERNET_IP_PROTO_TCP                (6U)
+#define ETHERNET_IP_PROTO_UDP                (17U)
+
+/* FNV-1a parameters of the flow hash */
+#define ETHERNET_FNV_OFFSET                  (0x811C9DC5U)
+#define ETHERNET_FNV_PRIME                   (0x01000193U)
+
+/* Binary trace ring. Records follow the ENETTRACE levels: failures from
+ * WARN, link changes from INFO, per-packet events from DEBUG, so
+ * production builds record nothing on the packet path. */
+#ifndef ETHERNET_CFG_TRACE_SIZE
+#define ETHERNET_CFG_TRACE_SIZE    (256U)
+#endif
+#define ETHERNET_TRACE_MAGIC       (0x4C4E5452U)  /* "LNTR" */
+
+#if ((ETHERNET_CFG_TRACE_SIZE & (ETHERNET_CFG_TRACE_SIZE - 1U)) != 0U)
+#error "ETHERNET_CFG_TRACE_SIZE must be a power of two"
+#endif
+
+#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_WARN)
+#define ETHERNET_TRACE_ENABLED     (1)
+#define ETHERNET_TRACE_WARN(ctx, event, len, status, arg) \
+    Ethernet_trace((ctx), (event), (len), (status), (arg))
+#else
+#define ETHERNET_TRACE_ENABLED     (0)
+#define ETHERNET_TRACE_WARN(ctx, event, len, status, arg) do { } while (0)
+#endif
+
+#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_INFO)
+#define ETHERNET_TRACE_INFO(ctx, event, len, status, arg) \
+    Ethernet_trace((ctx), (event), (len), (status), (arg))
+#else
+#define ETHERNET_TRACE_INFO(ctx, event, len, status, arg) do { } while (0)
+#endif
+
+#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_DEBUG)
+#define ETHERNET_TRACE_DBG(ctx, event, len, status, arg) \
+    Ethernet_trace((ctx), (event), (len), (status), (arg))
+#else
+#define ETHERNET_TRACE_DBG(ctx, event, len, status, arg) do { } while (0)
+#endif
+
+/* Latency histograms: a timestamp is taken at the start of an operation
+ * and the elapsed ticks recorded at its end. Expand to nothing when the
+ * histograms are compiled out. */
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+#define ETHERNET_LAT_BEGIN(t)      uint32_t t = Ethernet_latNow()
+#define ETHERNET_LAT_END(op, t)    Ethernet_latRecord((op), Ethernet_latNow() - (t))
+#else
+#define ETHERNET_LAT_BEGIN(t)
+#define ETHERNET_LAT_END(op, t)
+#endif
+
+/* Number of addressable PHYs on an MDIO bus */
+#define LAN8720_PHY_ADDR_NUM   (32U)
+
+/* Number of extended register addresses, which the MMD window holds in
+ * 16 bits */
+#define LAN8720_EXT_REG_NUM    (0x10000U)
+
+/* Maximum number of distinct registers in one extended RMW batch */
+#define LAN8720_EXT_BATCH_MAX      (16U)
+
+/* Largest register gap bridged by a post-increment read run; restarting
+ * the MMD window costs three MDIO frames, each skipped register one */
+#define LAN8720_EXT_RUN_GAP_MAX    (2U)
+
+/* Depth of the asynchronous MDIO request queue, must be a power of two */
+#ifndef LAN8720_CFG_MDIO_QUEUE_SIZE
+#define LAN8720_CFG_MDIO_QUEUE_SIZE  (16U)
+#endif
+
+/* MDIO user group driven by the asynchronous request queue; group 0 is
+ * left to the blocking accesses of the Enet LLD */
+#define LAN8720_MDIO_QUEUE_GROUP     (1U)
+
+/* Number of registers mirrored in the per-PHY shadow */
+#define LAN8720_SHADOW_REG_NUM     (3U)
+#define LAN8720_SHADOW_EXTREG_NUM  (8U)
+
+/* Number of configuration registers that can be changed with the link up */
+#define LAN8720_LIVE_REG_NUM       (3U)
+
 /* LAN8720 version identification */
 #define LAN8720_OUI      (0x000001C1U)
 #define LAN8720_MODEL    (0x27U)
@@ -47,14 +297,361 @@
 /* ========================================================================== */
 /*                            Global Variables                                */
 /* ========================================================================== */
-Enet_Handle hEnet;
-Enet_IoctlPrms prms;
-Enet_MacPort macPort = ENET_MAC_PORT;
-EnetPhy_Cfg phyCfg = { .phyAddr = ENET_PHY_ADDR };
 
-/* Transmit and receive buffers */
-static uint8_t txBuffer[ENET_TX_PKT_SIZE];
-static uint8_t rxBuffer[ENET_RX_PKT_SIZE];
+/* Per-core TX packet pool. The free list is a ring indexed by free-running
+ * counters: tail is only advanced by Ethernet_allocTxPkt() on the owning
+ * core, head only by Ethernet_poolPut() under the TX lock, from whichever
+ * context and core hands the packet back; the lock is shared by all cores
+ * so head has one writer at a time. Packets are tagged with their pool and
+ * always return to it, so a pool never holds more than it was carved with. */
+typedef struct Ethernet_PktPool_s
+{
+    EnetDma_Pkt *ring[ETHERNET_CFG_TX_POOL_SIZE];
+    /* Submission time in microseconds of each packet, by index */
+    uint32_t sentUs[ETHERNET_CFG_TX_POOL_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t lowWm;
+    uint32_t highWm;
+    bool belowLowWm;
+    Ethernet_PoolStats stats;
+} Ethernet_PktPool;
+
+/* Lock-free single-producer/single-consumer ring of DMA packets. head is
+ * only written by the producer and tail only by the consumer, each on its
+ * own cache line together with a cached copy of the other index, so the
+ * per-packet path takes no lock and rarely touches the remote line. */
+typedef struct Ethernet_Ring_s
+{
+    /* Producer side */
+    uint32_t head ETHERNET_CACHE_ALIGNED;
+    uint32_t tailCache;
+
+    /* Consumer side */
+    uint32_t tail ETHERNET_CACHE_ALIGNED;
+    uint32_t headCache;
+    uint32_t wakeups;
+
+    /* Set by a consumer about to sleep on sem, NULL sem if it never does */
+    uint32_t waiting ETHERNET_CACHE_ALIGNED;
+    SemaphoreP_Handle sem;
+
+    EnetDma_Pkt *slot[ETHERNET_CFG_RX_RING_SIZE] ETHERNET_CACHE_ALIGNED;
+} Ethernet_Ring;
+
+/* Software RX channel. Frames are steered to a channel by flow hash and
+ * consumed by the worker task of the channel, on the core it runs on. */
+typedef struct Ethernet_Chan_s
+{
+    /* Steered frames, device task to consumer */
+    Ethernet_Ring rxRing;
+
+    /* Consumed frames, consumer back to the device task */
+    Ethernet_Ring freeRing;
+
+    /* Counters of the device task side */
+    uint32_t steered ETHERNET_CACHE_ALIGNED;
+    uint32_t recycled;
+    uint32_t maxBacklog;
+
+    /* Counters of the consumer side */
+    Ethernet_ChanStats stats ETHERNET_CACHE_ALIGNED;
+} Ethernet_Chan;
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+/* Adaptive RX engine state */
+typedef struct Ethernet_RxPoll_s
+{
+    Ethernet_RxMode mode;
+    uint32_t emptyPolls;
+    uint64_t modeStartUs;
+    Ethernet_RxPollCfg cfg;
+    Ethernet_RxPollStats stats;
+} Ethernet_RxPoll;
+#endif
+
+/* Link bring-up progress of a port */
+typedef enum
+{
+    ETHERNET_LINK_ANEG,     /* Auto-negotiating */
+    ETHERNET_LINK_FORCED,   /* Forced from cached parameters, link not up yet */
+    ETHERNET_LINK_VERIFY,   /* Forced link up, partner re-check pending */
+    ETHERNET_LINK_RECHECK,  /* Auto-negotiating to re-check the partner */
+    ETHERNET_LINK_DONE      /* Auto-negotiated, or forced link verified */
+} Ethernet_LinkState;
+
+typedef struct Ethernet_Link_s
+{
+    Ethernet_LinkState state;
+    uint64_t stateStartUs;
+    uint64_t lastTickUs;
+    uint8_t linkUp;
+    Ethernet_LinkParams cached;
+    /* Symbol error counter when the forced link came up */
+    uint16_t symErrBase;
+} Ethernet_Link;
+
+/* Data path counters of one core. Each core only updates its own copy,
+ * without atomics, and readers sum them. */
+typedef struct Ethernet_CoreStats_s
+{
+    Ethernet_PerfStats perf ETHERNET_CACHE_ALIGNED;
+} Ethernet_CoreStats;
+
+/* Rate sampler of the PHY symbol error counter. The 16-bit counter rolls
+ * over, so only differences between samples are used. */
+typedef struct Ethernet_SymErr_s
+{
+    uint64_t sampleUs;
+    uint16_t last;
+    uint32_t total;
+    uint32_t rate;
+    /* Counter read posted on the asynchronous MDIO queue */
+    bool pending;
+} Ethernet_SymErr;
+
+/* TX pacing state. Tokens are counted in thousandths of a byte so that a
+ * rate in bytes per millisecond refills them exactly per microsecond.
+ * rateBpms is 0 while the link is down, frames then go straight to the
+ * DMA. Shared by the sending tasks and the device task, updated under the
+ * TX lock. */
+typedef struct Ethernet_TxPace_s
+{
+    uint32_t rateBpms;
+    uint64_t tokens;
+    uint64_t depth;
+    uint64_t lastUs;
+    EnetDma_PktQ queue[ETHERNET_TX_PRIO_NUM];
+    /* Queue entries promised by Ethernet_paceReserve() to frames still
+     * being copied */
+    uint32_t reserved[ETHERNET_TX_PRIO_NUM];
+    Ethernet_TxPaceStats stats;
+} Ethernet_TxPace;
+
+/* Per-port driver context. Everything a port touches on its data path
+ * lives here, so ports can be driven concurrently from different tasks. */
+struct Lan8720_Ctx_s
+{
+    bool inUse;
+    Enet_Handle hEnet;
+    Enet_MacPort macPort;
+    Enet_IoctlPrms prms;
+    EnetPhy_Cfg phyCfg;
+    EnetPhy_Handle hPhy;
+    EnetPhy_Mii mii;
+
+    /* LAN8720 configuration currently applied, if one was given */
+    LAN8720_Cfg phyExtCfg;
+    bool phyExtCfgSet;
+
+    /* MDIO controller polling the link in hardware, NULL if not enabled,
+     * and the user group raising link interrupts for the PHY (-1 if none) */
+    CSL_mdioRegs *linkMdioRegs;
+    int32_t linkGroup;
+
+    /* Packets retrieved from the DMA but not yet handed to the application,
+     * and loaned RX packets released by the application, waiting to be
+     * recycled. Shared with the device task, see Ethernet_rxLock(). */
+    EnetDma_PktQ rxPendQueue;
+    EnetDma_PktQ rxReleaseQueue;
+
+    Ethernet_PktPool txPool[ETHERNET_CFG_POOL_CORE_NUM];
+
+    /* RX channels; with a single channel frames are processed in place */
+    uint32_t numChans;
+    Ethernet_Chan chan[ETHERNET_CHAN_MAX];
+
+    /* Data path counters, one copy per core */
+    Ethernet_CoreStats coreStats[ETHERNET_CFG_POOL_CORE_NUM];
+    Ethernet_SymErr symErr;
+
+    /* TX completion reclamation counters. The submission time of a packet
+     * in flight is kept by its pool. */
+    Ethernet_TxReclaimStats txReclaim;
+    Ethernet_TxPace txPace;
+
+    /* Cross-core part of the TX lock, see Ethernet_txLock() */
+    bool txLock ETHERNET_CACHE_ALIGNED;
+
+    /* Cross-core part of the RX lock, see Ethernet_rxLock() */
+    bool rxLock ETHERNET_CACHE_ALIGNED;
+
+    /* Port and link bring-up, timed from initUs */
+    uint64_t initUs;
+    uint64_t initStateUs;
+    Ethernet_InitProfile init;
+    Ethernet_Link link;
+    Ethernet_BootStats bootStats;
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    /* Pending device task events, posted from interrupt context */
+    volatile uint32_t events;
+    SemaphoreP_Handle eventSem;
+    Ethernet_RxPoll rxPoll;
+#endif
+};
+
+static Lan8720_Ctx ethCtx[ETHERNET_CFG_PORT_NUM];
+
+/* Enet LLD initialized, done once for all ports */
+static bool enetInitDone = false;
+
+/* MDIO controller running without preamble, NULL when fast MDIO is off.
+ * The preamble is a property of the bus, shared by every port on it. */
+static CSL_mdioRegs *fastMdioRegs = NULL;
+
+#if (ETHERNET_TRACE_ENABLED == 1)
+/* Binary trace ring, shared by all ports. head counts the records ever
+ * written; a writer reserves a slot with one atomic increment and fills it
+ * with plain stores. Kept global so it can be found in a memory dump. */
+typedef struct Ethernet_Trace_s
+{
+    uint32_t magic;
+    uint16_t recSize;
+    uint16_t numRecs;
+    uint32_t head;
+    uint32_t rsvd;
+    Ethernet_TraceRec rec[ETHERNET_CFG_TRACE_SIZE];
+} Ethernet_Trace;
+
+Ethernet_Trace gEthernetTrace =
+{
+    .magic   = ETHERNET_TRACE_MAGIC,
+    .recSize = (uint16_t)sizeof(Ethernet_TraceRec),
+    .numRecs = (uint16_t)ETHERNET_CFG_TRACE_SIZE,
+};
+#endif
+
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+/* Latency histograms, one per timed operation, shared by all ports */
+static Ethernet_LatHist ethLatHist[ETHERNET_LAT_OP_NUM];
+static bool ethLatInitDone = false;
+
+static const char *const ethLatOpName[ETHERNET_LAT_OP_NUM] =
+{
+    "send",
+    "receive",
+    "mdio read",
+    "mdio write",
+    "ext rmw",
+};
+#endif
+
+/* Shadow of the PHY configuration registers, one per MDIO address */
+typedef struct Lan8720_Shadow_s
+{
+    uint16_t val[LAN8720_SHADOW_REG_NUM];
+    uint16_t extVal[LAN8720_SHADOW_EXTREG_NUM];
+    uint32_t validMask;
+    uint32_t extValidMask;
+    Lan8720_ShadowStats stats;
+} Lan8720_Shadow;
+
+static Lan8720_Shadow lan8720Shadow[LAN8720_PHY_ADDR_NUM];
+
+/* MDIO transaction counters, one per MDIO address */
+static Lan8720_MdioStats lan8720MdioStats[LAN8720_PHY_ADDR_NUM];
+
+/* Pending extended register read-modify-write */
+typedef struct Lan8720_ExtRmw_s
+{
+    uint16_t reg;
+    uint16_t mask;
+    uint16_t val;
+    uint16_t data;
+} Lan8720_ExtRmw;
+
+/* Batch of extended register read-modify-writes, merged per register */
+typedef struct Lan8720_ExtBatch_s
+{
+    EnetPhy_Handle hPhy;
+    bool open;
+    uint32_t num;
+    Lan8720_ExtRmw ops[LAN8720_EXT_BATCH_MAX];
+} Lan8720_ExtBatch;
+
+/* Batch collecting Lan8720_rmwExtReg() calls, one per MDIO address */
+static Lan8720_ExtBatch lan8720ExtBatch[LAN8720_PHY_ADDR_NUM];
+
+/* Register plan applied by the config hook, one per MDIO address */
+typedef struct Lan8720_PlanSlot_s
+{
+    /* Plan installed with Lan8720_setCfgPlan(), used as is when set */
+    const Lan8720_CfgPlan *fixed;
+    /* Extended configuration and MII mode the cached plan was built from */
+    const void *srcCfg;
+    EnetPhy_Mii mii;
+    bool valid;
+    Lan8720_CfgPlan plan;
+} Lan8720_PlanSlot;
+
+static Lan8720_PlanSlot lan8720Plan[LAN8720_PHY_ADDR_NUM];
+
+/* Asynchronous MDIO request */
+typedef struct Lan8720_MdioReq_s
+{
+    Lan8720_MdioCb cb;
+    void *cbArg;
+    uint8_t phyAddr;
+    uint8_t op;
+    /* Next frame of the request */
+    uint8_t step;
+    uint16_t reg;
+    uint16_t mask;
+    uint16_t val;
+    /* Value read, then value written by a read-modify-write */
+    uint16_t data;
+} Lan8720_MdioReq;
+
+/* Asynchronous MDIO request queue; the request at tail is on the bus
+ * while busy is set */
+typedef struct Lan8720_MdioQueue_s
+{
+    CSL_mdioRegs *regs;
+    uint32_t head;
+    uint32_t tail;
+    bool busy;
+    Lan8720_MdioReq req[LAN8720_CFG_MDIO_QUEUE_SIZE];
+} Lan8720_MdioQueue;
+
+static Lan8720_MdioQueue lan8720MdioQueue;
+
+/* PHYs whose MMD window is in use, one bit per MDIO address, either by a
+ * blocking access sequence or by the extended request of the queue on the
+ * bus. Changed with interrupts disabled. */
+static uint32_t lan8720MmdBusy;
+
+/* Plan registers whose settings take effect while the link is up. Any
+ * other one (MII mode, clock shifts and delays, FIFO depth, Viterbi
+ * threshold) is only picked up by the PHY after a soft restart. */
+static const uint16_t lan8720LiveRegs[LAN8720_LIVE_REG_NUM] =
+{
+    LAN8720_LEDCR1,
+    LAN8720_IOMUXCFG | LAN8720_CFG_OP_EXT,
+    LAN8720_GPIOMUXCTRL | LAN8720_CFG_OP_EXT,
+};
+
+/* Clause 22 registers mirrored in the shadow. BMCR and ANAR are left out
+ * as the EnetPhy state machine writes them directly. */
+static const uint16_t lan8720ShadowRegs[LAN8720_SHADOW_REG_NUM] =
+{
+    LAN8720_LEDCR1,
+    LAN8720_PHYCR,
+    LAN8720_CFG3,
+};
+
+/* Extended (MMD) configuration registers mirrored in the shadow */
+static const uint16_t lan8720ShadowExtRegs[LAN8720_SHADOW_EXTREG_NUM] =
+{
+    LAN8720_RMIICTL,
+    LAN8720_VTMCFG,
+    LAN8720_FLDTHRCFG,
+    LAN8720_RMIIDCTL,
+    LAN8720_LOOPCR,
+    LAN8720_DSPFFECFG,
+    LAN8720_IOMUXCFG,
+    LAN8720_GPIOMUXCTRL,
+};
 
 /* ========================================================================== */
 /*                   PHY Driver Interface Function Prototypes                 */
@@ -69,499 +666,5002 @@ static void Lan8720_printRegs(EnetPhy_Handle hPhy);
 #endif
 
 /* Extended internal helper functions */
-static void Lan8720_setMiiMode(EnetPhy_Handle hPhy, EnetPhy_Mii mii);
-static void Lan8720_setVtmIdleThresh(EnetPhy_Handle hPhy, uint32_t idleThresh);
-static void Lan8720_setDspFFE(EnetPhy_Handle hPhy);
+static void Lan8720_setMiiMode(Lan8720_CfgPlan *plan, EnetPhy_Mii mii);
+static void Lan8720_setVtmIdleThresh(Lan8720_CfgPlan *plan, uint32_t idleThresh);
 static void Lan8720_fixFldStrap(EnetPhy_Handle hPhy);
-static void Lan8720_setLoopbackCfg(EnetPhy_Handle hPhy, bool enable);
-static void Lan8720_enableAutoMdix(EnetPhy_Handle hPhy, bool enable);
-static void Lan8720_setClkShift(EnetPhy_Handle hPhy, bool txShiftEn, bool rxShiftEn);
-static int32_t Lan8720_setTxFifoDepth(EnetPhy_Handle hPhy, uint8_t depth);
-static int32_t Lan8720_setClkDelay(EnetPhy_Handle hPhy, uint32_t txDelay, uint32_t rxDelay);
-static int32_t Lan8720_setOutputImpedance(EnetPhy_Handle hPhy, uint32_t impedance);
-static void Lan8720_setGpioMux(EnetPhy_Handle hPhy, LAN8720_Gpio0Mode gpio0Mode, LAN8720_Gpio1Mode gpio1Mode);
-static void Lan8720_setLedMode(EnetPhy_Handle hPhy, const LAN8720_LedMode *ledMode);
+static void Lan8720_setClkShift(Lan8720_CfgPlan *plan, bool txShiftEn, bool rxShiftEn);
+static int32_t Lan8720_setTxFifoDepth(Lan8720_CfgPlan *plan, uint8_t depth);
+static int32_t Lan8720_setClkDelay(Lan8720_CfgPlan *plan, uint32_t txDelay, uint32_t rxDelay);
+static int32_t Lan8720_setOutputImpedance(Lan8720_CfgPlan *plan, uint32_t impedance);
+static void Lan8720_setGpioMux(Lan8720_CfgPlan *plan, LAN8720_Gpio0Mode gpio0Mode, LAN8720_Gpio1Mode gpio1Mode);
+static void Lan8720_setLedMode(Lan8720_CfgPlan *plan, const LAN8720_LedMode *ledMode);
+static void Lan8720_addCfgOp(Lan8720_CfgPlan *plan, uint32_t reg, uint16_t mask, uint16_t val);
+static const Lan8720_CfgPlan *Lan8720_getCfgPlan(EnetPhy_Handle hPhy, const EnetPhy_Cfg *cfg, EnetPhy_Mii mii);
+static void Lan8720_applyCfgPlan(EnetPhy_Handle hPhy, const Lan8720_CfgPlan *plan);
+static void Lan8720_storeCfgPlan(Lan8720_PlanSlot *slot, const Lan8720_CfgPlan *plan,
+                                 EnetPhy_Mii mii);
 static void Lan8720_restart(EnetPhy_Handle hPhy);
 static void Lan8720_rmwExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val);
 
+/* Shadowed register access */
+static int32_t Lan8720_shadowIdx(const uint16_t *regs, uint32_t num, uint32_t reg);
+static void Lan8720_invalidateShadow(EnetPhy_Handle hPhy);
+static int32_t Lan8720_readReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+static int32_t Lan8720_writeReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+static void Lan8720_rmwReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val);
+static int32_t Lan8720_readExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+static int32_t Lan8720_writeExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+static int32_t Lan8720_mmdRead(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+static int32_t Lan8720_mmdWrite(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+static int32_t Lan8720_mmdRmw(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val,
+                              uint16_t *data);
+static int32_t Lan8720_mdioRead(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+static int32_t Lan8720_mdioWrite(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+static void Lan8720_mmdLock(EnetPhy_Handle hPhy);
+static void Lan8720_mmdUnlock(EnetPhy_Handle hPhy);
+
+/* Batched extended register access */
+static void Lan8720_beginExtBatch(EnetPhy_Handle hPhy);
+static int32_t Lan8720_commitExtBatch(EnetPhy_Handle hPhy);
+static void Lan8720_addExtBatch(Lan8720_ExtBatch *batch, uint32_t reg, uint16_t mask, uint16_t val);
+
+/* Asynchronous MDIO request queue */
+static bool Lan8720_mdioNextFrame(Lan8720_MdioReq *req, uint32_t *frame);
+static void Lan8720_mdioStartReq(Lan8720_MdioQueue *q);
+static void Lan8720_setShadow(uint32_t phyAddr, bool ext, uint32_t reg, const uint16_t *val);
+
+/* Ethernet driver internal helpers */
+static void Ethernet_configPhy(EnetPhy_Handle hPhy);
+static Lan8720_Ctx *Ethernet_findCtx(uint32_t phyAddr);
+static void Ethernet_setInitState(Lan8720_Ctx *ctx, Ethernet_InitState state);
+static void Ethernet_startAutoNeg(EnetPhy_Handle hPhy);
+static void Ethernet_forceLink(EnetPhy_Handle hPhy, const Ethernet_LinkParams *params);
+#if (ETHERNET_CFG_LINK_RECHECK_ANEG == 0)
+static bool Ethernet_verifyForcedLink(Lan8720_Ctx *ctx);
+#endif
+static void Ethernet_setLinkState(Lan8720_Ctx *ctx, Ethernet_LinkState state);
+static bool Ethernet_linkPending(Lan8720_Ctx *ctx);
+static uint8_t Ethernet_linkTick(Lan8720_Ctx *ctx);
+static uint32_t Ethernet_bootTimeUs(Lan8720_Ctx *ctx);
+static int Ethernet_sendFrags(Lan8720_Ctx *ctx, const Ethernet_TxFrag *frags, uint32_t numFrags,
+                             Ethernet_TxPrio prio);
+static int Ethernet_submitTxPkt(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt, size_t len,
+                                Ethernet_TxPrio prio, uint32_t reserved);
+static int Ethernet_submitTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue, uint32_t bytes);
+static void Ethernet_reportFirstTx(Lan8720_Ctx *ctx, bool wasFirst);
+static uint32_t Ethernet_paceReserve(Lan8720_Ctx *ctx, Ethernet_TxPrio prio, uint32_t count);
+static uint32_t Ethernet_paceTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue, uint32_t bytes,
+                                    Ethernet_TxPrio prio, uint32_t reserved);
+static void Ethernet_paceTx(Lan8720_Ctx *ctx);
+static void Ethernet_setTxRate(Lan8720_Ctx *ctx, uint8_t linkUp);
+static bool Ethernet_txBacklog(Lan8720_Ctx *ctx);
+static void Ethernet_fillRxPendQ(Lan8720_Ctx *ctx, uint32_t wanted);
+static void Ethernet_takeRxPendQ(Lan8720_Ctx *ctx, EnetDma_PktQ *rxQueue, uint32_t maxPkts);
+static void Ethernet_submitRxReleaseQ(Lan8720_Ctx *ctx);
+static void Ethernet_refillRxFreeQ(Lan8720_Ctx *ctx);
+static uint32_t Ethernet_drainRx(Lan8720_Ctx *ctx, uint32_t budget);
+static void Ethernet_initChans(Lan8720_Ctx *ctx, uint32_t numChans);
+static void Ethernet_releaseCtx(Lan8720_Ctx *ctx);
+static void Ethernet_recycleChanRx(Lan8720_Ctx *ctx);
+static void Ethernet_ringInit(Ethernet_Ring *ring, bool blocking);
+static uint32_t Ethernet_ringPut(Ethernet_Ring *ring, EnetDma_PktQ *pktQueue);
+static uint32_t Ethernet_ringGet(Ethernet_Ring *ring, EnetDma_Pkt **pkts, uint32_t maxPkts);
+static uint32_t Ethernet_ringWait(Ethernet_Ring *ring, EnetDma_Pkt **pkts, uint32_t maxPkts);
+static uint32_t Ethernet_ringCount(Ethernet_Ring *ring);
+static uint32_t Ethernet_coreIdx(void);
+static inline uintptr_t Ethernet_txLock(Lan8720_Ctx *ctx);
+static inline void Ethernet_txUnlock(Lan8720_Ctx *ctx, uintptr_t key);
+static inline uintptr_t Ethernet_rxLock(Lan8720_Ctx *ctx);
+static inline void Ethernet_rxUnlock(Lan8720_Ctx *ctx, uintptr_t key);
+static inline Ethernet_PerfStats *Ethernet_perfStats(Lan8720_Ctx *ctx);
+static void Ethernet_sampleStats(Lan8720_Ctx *ctx);
+static void Ethernet_updateSymErr(Ethernet_SymErr *symErr, uint16_t cnt);
+static void Ethernet_symErrDone(void *cbArg, int32_t status, uint16_t val);
+static void Ethernet_initPools(Lan8720_Ctx *ctx);
+static EnetDma_Pkt *Ethernet_allocTxPkt(Lan8720_Ctx *ctx);
+static inline Ethernet_PktPool *Ethernet_txPktPool(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt);
+static void Ethernet_poolPut(Ethernet_PktPool *pool, EnetDma_Pkt *pTxPkt);
+static void Ethernet_freeTxPkt(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt);
+static uint32_t Ethernet_freeTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue);
+static void Ethernet_setMdioPreamble(CSL_mdioRegs *mdioRegs, bool enable);
+static void Ethernet_setPreambleBypass(bool enable);
+#if (ETHERNET_TRACE_ENABLED == 1)
+static inline void Ethernet_trace(Lan8720_Ctx *ctx, uint32_t event, uint32_t len,
+                                  int32_t status, uint32_t arg);
+#endif
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+static void Ethernet_latInit(void);
+static inline uint32_t Ethernet_latNow(void);
+static void Ethernet_latRecord(Ethernet_LatOp op, uint32_t ticks);
+#endif
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+static void Ethernet_postEvent(Lan8720_Ctx *ctx, uint32_t event);
+static uint32_t Ethernet_waitEvents(Lan8720_Ctx *ctx, uint32_t timeout);
+static uint32_t Ethernet_takeEvents(Lan8720_Ctx *ctx);
+static void Ethernet_enablePhyIntr(Lan8720_Ctx *ctx);
+static uint8_t Ethernet_handlePhyEvent(Lan8720_Ctx *ctx);
+static void Ethernet_setRxMode(Lan8720_Ctx *ctx, Ethernet_RxMode mode);
+static void Ethernet_rxPoll(Lan8720_Ctx *ctx, uint8_t linkUp);
+static bool Ethernet_chanRxOut(Lan8720_Ctx *ctx);
+#endif
+
 /* ========================================================================== */
 /*                     Ethernet Driver Public Functions                       */
 /* ========================================================================== */
 
 /**
- *  \brief Initializes the Ethernet driver and LAN8720 PHY.
+ *  \brief Fills a port configuration with the default port, PHY address
+ *  and RMII.
  */
-void Ethernet_init(void)
+void Ethernet_initPortCfg(Ethernet_PortCfg *cfg)
 {
-    Enet_init();
-    Enet_open(hEnet, &prms);
-    Enet_ioctl(hEnet, ENET_IOCTL_SET_MAC_PORT_STATE, &macPort, &prms);
-    EnetPhy_open(hEnet, ENET_MAC_PORT, &phyCfg);
-    Ethernet_config();
-    printf("Ethernet Initialized Successfully\n");
+    if (cfg != NULL)
+    {
+        memset(cfg, 0, sizeof(*cfg));
+        cfg->macPort = ENET_MAC_PORT;
+        cfg->phyAddr = ENET_PHY_ADDR;
+        cfg->mii = ENETPHY_MAC_MII_RMII;
+        cfg->numChans = 1U;
+    }
 }
 
 /**
- *  \brief Configures the LAN8720 PHY.
+ *  \brief Initializes the Ethernet driver and LAN8720 PHY of one port.
+ *
+ *  Runs the bring-up until auto-negotiation is started.
  *
- *  Reads PHY ID registers, prints them, and enables auto-negotiation.
+ *  \param cfg Port configuration.
+ *  \return The port context, or NULL if no context is left or the PHY
+ *          bring-up failed.
  */
-void Ethernet_config(void)
+Lan8720_Ctx *Ethernet_init(const Ethernet_PortCfg *cfg)
 {
-    uint16_t phyId1 = 0, phyId2 = 0;
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_PHYID1, &phyId1);
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_PHYID2, &phyId2);
-    printf("LAN8720 PHY ID1: 0x%x, PHY ID2: 0x%x\n", phyId1, phyId2);
+    Lan8720_Ctx *ctx = Ethernet_initAsync(cfg);
 
-    /* Enable auto-negotiation */
-    uint16_t ctrlReg = BMCR_AUTO_NEG_ENABLE | BMCR_RESTART_AUTO_NEG;
-    lan8720_write_reg(ENET_PHY_ADDR, LAN8720_BMCR, ctrlReg);
+    Ethernet_InitState state = ETHERNET_INIT_FAILED;
+
+    if (ctx != NULL)
+    {
+        state = Ethernet_initTick(ctx);
+        while (state < ETHERNET_INIT_AUTONEG)
+        {
+            EnetOsal_sleep(1U);
+            state = Ethernet_initTick(ctx);
+        }
+    }
+    if ((ctx != NULL) && (state == ETHERNET_INIT_FAILED))
+    {
+        Ethernet_releaseCtx(ctx);
+        ctx = NULL;
+    }
+    return ctx;
 }
 
 /**
- *  \brief Transmits an Ethernet packet.
+ *  \brief Starts the initialization of one port.
  *
- *  This function accepts a pointer to arbitrary data and its length.
- *  It copies the data into a DMA packet and submits it for transmission.
+ *  The Enet LLD is initialized on the first call, and each Enet instance is
+ *  opened by the first port that uses it. The PHY is left to
+ *  Ethernet_initTick().
  *
- *  \param data Pointer to the data to be transmitted.
- *  \param len  Length of the data in bytes.
+ *  \param cfg Port configuration.
+ *  \return The port context, or NULL if no context is left.
  */
-int Ethernet_sendPacket(const void *data, size_t len)
+Lan8720_Ctx *Ethernet_initAsync(const Ethernet_PortCfg *cfg)
 {
-    if (len > ENET_TX_PKT_SIZE)
+    Lan8720_Ctx *ctx = NULL;
+    bool enetOpen = false;
+    uintptr_t key;
+    uint32_t i;
+
+    if ((cfg == NULL) || (cfg->phyAddr >= LAN8720_PHY_ADDR_NUM) ||
+        (cfg->numChans == 0U) || (cfg->numChans > ETHERNET_CHAN_MAX))
     {
-        len = ENET_TX_PKT_SIZE;
+        return NULL;
     }
-    memcpy(txBuffer, data, len);
 
-    EnetDma_PktQ txQueue;
-    EnetDma_Pkt *pTxPkt = EnetDma_allocPkt(hEnet, ENET_DMA_DIR_TX);
-    if (pTxPkt == NULL)
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+    Ethernet_latInit();
+#endif
+    /* The new PHY does not have the preamble bypass bit set yet */
+    Ethernet_disableFastMdio();
+
+    key = EnetOsal_disableAllIntr();
+    for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
     {
-        printf("Failed to allocate TX packet\n");
-        return -1;
+        if (ethCtx[i].inUse && (ethCtx[i].hEnet == cfg->hEnet))
+        {
+            enetOpen = true;
+        }
+        else if (!ethCtx[i].inUse && (ctx == NULL))
+        {
+            ctx = &ethCtx[i];
+        }
     }
-    memcpy(pTxPkt->bufPtr, txBuffer, len);
-    EnetDma_submitTxPktQ(hEnet, ENET_MAC_PORT, &txQueue);
-    printf("Packet transmitted (%u bytes)\n", (unsigned)len);
-    return 0;
-}
+    if (ctx != NULL)
+    {
+        memset(ctx, 0, sizeof(*ctx));
+        ctx->inUse = true;
+    }
+    EnetOsal_restoreAllIntr(key);
 
-/**
- *  \brief Receives an Ethernet packet.
- *
- *  This function attempts to retrieve a received packet and copies the data
- *  into the provided buffer up to maxLen bytes.
- *
- *  \param buffer Pointer to a buffer where the received data will be stored.
- *  \param maxLen Maximum number of bytes to copy.
- *  \return Number of bytes received, or -1 if no packet was available.
- */
-int Ethernet_receivePacket(void *buffer, size_t maxLen)
-{
-    EnetDma_PktQ rxQueue;
-    EnetDma_Pkt *pRxPkt;
-    EnetDma_retrieveRxPktQ(hEnet, ENET_MAC_PORT, &rxQueue);
-    if (EnetDma_isPktQEmpty(&rxQueue))
+    if (ctx == NULL)
     {
-        return -1;  /* No packet available */
+        printf("No Ethernet port context left\n");
+        return NULL;
     }
-    pRxPkt = EnetDma_getNextPkt(&rxQueue);
-    if (pRxPkt == NULL)
+
+    ctx->initUs = TimerP_getTimeInUsecs();
+    Ethernet_setInitState(ctx, ETHERNET_INIT_RESET);
+    ctx->hEnet = cfg->hEnet;
+    ctx->macPort = cfg->macPort;
+    ctx->mii = cfg->mii;
+    ctx->phyCfg.phyAddr = cfg->phyAddr;
+    /* The context may be reused with another configuration at the same
+     * address, so the cached plan is built again */
+    lan8720Plan[cfg->phyAddr].valid = false;
+    if (cfg->phyCfg != NULL)
     {
-        return -1;
+        ctx->phyExtCfg = *cfg->phyCfg;
+        ctx->phyExtCfgSet = true;
+        EnetPhy_setExtendedCfg(&ctx->phyCfg, &ctx->phyExtCfg, sizeof(LAN8720_Cfg));
+    }
+    ctx->txReclaim.latMinUs = UINT32_MAX;
+    ctx->linkGroup = -1;
+
+    /* Set before the PHY is opened, its config hook honours the forced link */
+    if ((cfg->linkParams != NULL) &&
+        ((cfg->linkParams->partnerAbility & ANLPAR_SELECTOR_FIELD) == 1U))
+    {
+        ctx->link.cached = *cfg->linkParams;
+        ctx->bootStats.fastLink = true;
+        Ethernet_setLinkState(ctx, ETHERNET_LINK_FORCED);
     }
-    size_t rxLen = strlen((char *)pRxPkt->bufPtr);
-    if (rxLen > maxLen)
+    else
     {
-        rxLen = maxLen;
+        Ethernet_setLinkState(ctx, ETHERNET_LINK_ANEG);
     }
-    memcpy(buffer, pRxPkt->bufPtr, rxLen);
-    EnetDma_freePkt(hEnet, pRxPkt);
-    printf("Packet received (%u bytes)\n", (unsigned)rxLen);
-    return (int)rxLen;
-}
 
-/**
- *  \brief Retrieves the Ethernet link status.
- *
- *  \return 1 if the link is up, 0 otherwise.
- */
-uint8_t Ethernet_getStatus(void)
-{
-    uint16_t statusReg = 0;
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMSR, &statusReg);
-    return (statusReg & BMSR_LINK_STATUS) ? 1 : 0;
+    if (!enetInitDone)
+    {
+        Enet_init();
+        enetInitDone = true;
+    }
+    EnetQueue_initQ(&ctx->rxPendQueue);
+    EnetQueue_initQ(&ctx->rxReleaseQueue);
+    EnetQueue_initQ(&ctx->txPace.queue[ETHERNET_TX_PRIO_NORMAL]);
+    EnetQueue_initQ(&ctx->txPace.queue[ETHERNET_TX_PRIO_HIGH]);
+    if (!enetOpen)
+    {
+        Enet_open(ctx->hEnet, &ctx->prms);
+    }
+    Enet_ioctl(ctx->hEnet, ENET_IOCTL_SET_MAC_PORT_STATE, &ctx->macPort, &ctx->prms);
+    Ethernet_initPools(ctx);
+    Ethernet_initChans(ctx, cfg->numChans);
+    ctx->hPhy = EnetPhy_open(ctx->hEnet, ctx->macPort, &ctx->phyCfg);
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    {
+        SemaphoreP_Params semPrms;
+
+        ctx->rxPoll.mode = ETHERNET_RX_MODE_INTR;
+        ctx->rxPoll.cfg.budget = ETHERNET_RX_POLL_BUDGET_DEFAULT;
+        ctx->rxPoll.cfg.maxEmptyPolls = ETHERNET_RX_POLL_MAX_EMPTY_DEFAULT;
+
+        SemaphoreP_Params_init(&semPrms);
+        semPrms.mode = SemaphoreP_Mode_BINARY;
+        ctx->events = 0U;
+        ctx->eventSem = SemaphoreP_create(0U, &semPrms);
+    }
+#endif
+    return ctx;
 }
 
 /**
- *  \brief Main device function for managing Ethernet tasks.
+ *  \brief Advances the PHY bring-up of a port by at most one step.
  *
- *  This function initializes the driver and then continuously polls for received packets.
- *  In a real system, this may be integrated with an RTOS task or interrupt service routine.
+ *  \return The bring-up state after the step.
  */
-void Ethernet_deviceMain(void)
+Ethernet_InitState Ethernet_initTick(Lan8720_Ctx *ctx)
 {
-    Ethernet_init();
-    while (1)
+    uint64_t elapsedUs = TimerP_getTimeInUsecs() - ctx->initStateUs;
+
+    switch (ctx->init.state)
     {
-        if (Ethernet_getStatus())
-        {
-            uint8_t rxData[ENET_RX_PKT_SIZE] = {0};
-            int ret = Ethernet_receivePacket(rxData, ENET_RX_PKT_SIZE);
-            if (ret > 0)
+        case ETHERNET_INIT_RESET:
+            Lan8720_reset(ctx->hPhy);
+            Ethernet_setInitState(ctx, ETHERNET_INIT_WAIT_RESET);
+            break;
+
+        case ETHERNET_INIT_WAIT_RESET:
+            if (Lan8720_isResetComplete(ctx->hPhy))
             {
-                printf("Received Data: %s\n", rxData);
+                Ethernet_setInitState(ctx, ETHERNET_INIT_CONFIG);
             }
-        }
-        /* Add delay or yield to RTOS scheduler as needed */
-        EnetOsal_sleep(1000U); /* Sleep for 1000ms; replace with your system's delay function */
+            else if (elapsedUs >= (ETHERNET_CFG_RESET_TIMEOUT_MS * 1000U))
+            {
+                printf("PHY %u reset timed out\n", (unsigned)ctx->phyCfg.phyAddr);
+                Ethernet_setInitState(ctx, ETHERNET_INIT_FAILED);
+            }
+            break;
+
+        case ETHERNET_INIT_CONFIG:
+            /* The reset cleared the MII mode and the LAN8720 configuration */
+            if (Ethernet_config(ctx) != 0)
+            {
+                printf("PHY %u configuration failed\n", (unsigned)ctx->phyCfg.phyAddr);
+                Ethernet_setInitState(ctx, ETHERNET_INIT_FAILED);
+                break;
+            }
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+            /* The reset cleared the interrupt mask */
+            Ethernet_enablePhyIntr(ctx);
+#endif
+            /* A forced link is timed from when it is actually forced */
+            Ethernet_setLinkState(ctx, ctx->link.state);
+            /* Symbol errors are counted from here on */
+            Lan8720_readReg(ctx->hPhy, LAN8720_SYMBOL_ERROR_COUNTER, &ctx->symErr.last);
+            ctx->symErr.sampleUs = TimerP_getTimeInUsecs();
+            printf("Ethernet port %u (PHY %u) Initialized Successfully\n",
+                   (unsigned)ctx->macPort, (unsigned)ctx->phyCfg.phyAddr);
+            Ethernet_setInitState(ctx, ETHERNET_INIT_AUTONEG);
+            break;
+
+        case ETHERNET_INIT_AUTONEG:
+        case ETHERNET_INIT_LINK_UP:
+            /* Moves to ETHERNET_INIT_LINK_UP on the first link up */
+            Ethernet_linkTick(ctx);
+            break;
+
+        default:
+            break;
     }
+    return ctx->init.state;
 }
 
-/* ========================================================================== */
-/*                    PHY Driver Interface Implementations                    */
-/* ========================================================================== */
+/**
+ *  \brief Returns the bring-up profile of a port.
+ */
+void Ethernet_getInitProfile(Lan8720_Ctx *ctx, Ethernet_InitProfile *profile)
+{
+    *profile = ctx->init;
+}
+
+/**
+ *  \brief Configures the LAN8720 PHY of a port.
+ *
+ *  Applies the register plan of the port's MII mode and LAN8720
+ *  configuration, reads PHY ID registers, prints them, and enables
+ *  auto-negotiation, or forces the cached speed and duplex for a fast
+ *  link-up.
+ *
+ *  \return 0 on success, -1 on failure.
+ */
+int Ethernet_config(Lan8720_Ctx *ctx)
+{
+    return (Lan8720_config(ctx->hPhy, &ctx->phyCfg, ctx->mii) == ENETPHY_SOK) ? 0 : -1;
+}
+
+/**
+ *  \brief Transmits an Ethernet packet.
+ *
+ *  This function accepts a pointer to arbitrary data and its length.
+ *  The data is copied once, straight into the DMA packet buffer.
+ *
+ *  \param data Pointer to the data to be transmitted.
+ *  \param len  Length of the data in bytes.
+ */
+int Ethernet_sendPacket(Lan8720_Ctx *ctx, const void *data, size_t len)
+{
+    return Ethernet_sendPacketPrio(ctx, data, len, ETHERNET_TX_PRIO_NORMAL);
+}
+
+/**
+ *  \brief Transmits an Ethernet packet with a given priority.
+ *
+ *  \param data Pointer to the data to be transmitted.
+ *  \param len  Length of the data in bytes.
+ *  \param prio Priority class of the frame.
+ *  \return 0 on success, -1 on failure.
+ */
+int Ethernet_sendPacketPrio(Lan8720_Ctx *ctx, const void *data, size_t len, Ethernet_TxPrio prio)
+{
+    Ethernet_TxFrag frag;
+    int ret;
+    ETHERNET_LAT_BEGIN(t0);
+
+    frag.buf = data;
+    frag.len = (uint32_t)len;
+    ret = Ethernet_sendFrags(ctx, &frag, 1U, prio);
+    ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_TX, (uint32_t)len, ret, 0U);
+    ETHERNET_LAT_END(ETHERNET_LAT_SEND, t0);
+    return ret;
+}
+
+/**
+ *  \brief Transmits an Ethernet packet built from several fragments.
+ *
+ *  The fragments are gathered directly into the DMA packet buffer, so each
+ *  byte of the frame is copied exactly once. Frames longer than
+ *  ENET_TX_PKT_SIZE are truncated.
+ *
+ *  \param frags    Array of fragment descriptors.
+ *  \param numFrags Number of fragments.
+ *  \return 0 on success, -1 on failure.
+ */
+int Ethernet_sendPacketSg(Lan8720_Ctx *ctx, const Ethernet_TxFrag *frags, uint32_t numFrags)
+{
+    return Ethernet_sendFrags(ctx, frags, numFrags, ETHERNET_TX_PRIO_NORMAL);
+}
+
+/**
+ *  \brief Transmits a batch of Ethernet packets.
+ *
+ *  Reserves room in the pacing queue first, so that only frames that will
+ *  be accepted are copied, then allocates and fills one DMA packet per
+ *  frame, chains them into a single queue and submits the whole batch with
+ *  one EnetDma_submitTxPktQ() call. Filling stops at the first allocation
+ *  failure so that the caller can apply backpressure and retry the
+ *  remaining frames.
+ *
+ *  \param frames Array of frames to transmit.
+ *  \param count  Number of frames.
+ *  \return Number of frames accepted for transmission.
+ */
+uint32_t Ethernet_sendBurst(Lan8720_Ctx *ctx, const Ethernet_Frame *frames, uint32_t count)
+{
+    Ethernet_PerfStats *perf;
+    EnetDma_PktQ txQueue;
+    EnetDma_Pkt *pTxPkt;
+    uint32_t accepted;
+    uint32_t reserved;
+    uint32_t bytes = 0U;
+    uint32_t now;
+    size_t len;
+
+    if ((frames == NULL) || (count == 0U))
+    {
+        return 0U;
+    }
+
+    perf = Ethernet_perfStats(ctx);
+    reserved = Ethernet_paceReserve(ctx, ETHERNET_TX_PRIO_NORMAL, count);
+    now = (uint32_t)TimerP_getTimeInUsecs();
+    EnetQueue_initQ(&txQueue);
+    for (accepted = 0U; accepted < reserved; accepted++)
+    {
+        pTxPkt = Ethernet_allocTxPkt(ctx);
+        if (pTxPkt == NULL)
+        {
+            break;
+        }
+
+        len = frames[accepted].len;
+        if (len > ENET_TX_PKT_SIZE)
+        {
+            len = ENET_TX_PKT_SIZE;
+            perf->txTruncated++;
+        }
+        memcpy(pTxPkt->bufPtr, frames[accepted].buf, len);
+        pTxPkt->userBufLen = (uint32_t)len;
+        Ethernet_txPktPool(ctx, pTxPkt)->sentUs[ETHERNET_TX_PKT_IDX(pTxPkt)] = now;
+        EnetQueue_enq(&txQueue, &pTxPkt->node);
+        bytes += (uint32_t)len;
+    }
+
+    /* Also gives back the reservation left unused by a short pool. The
+     * reserved frames are all taken, or all dropped on a DMA error. */
+    accepted = Ethernet_paceTxPktQ(ctx, &txQueue, bytes, ETHERNET_TX_PRIO_NORMAL, reserved);
+    if (accepted > 0U)
+    {
+        perf->txBytesCopied += bytes;
+    }
+    ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_TX_BURST, bytes, (accepted < count) ? -1 : 0, accepted);
+    return accepted;
+}
+
+/**
+ *  \brief Loans a DMA packet buffer to the caller.
+ *
+ *  The caller builds the frame in place and passes it to
+ *  Ethernet_submitTxBuffer(), avoiding any copy on the transmit path.
+ *
+ *  \param txBuf Filled in with the loaned buffer.
+ *  \return 0 on success, -1 on failure.
+ */
+int Ethernet_acquireTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf)
+{
+    EnetDma_Pkt *pTxPkt;
+
+    if (txBuf == NULL)
+    {
+        return -1;
+    }
+
+    pTxPkt = Ethernet_allocTxPkt(ctx);
+    if (pTxPkt == NULL)
+    {
+        ETHERNET_TRACE_WARN(ctx, ETHERNET_TRACE_TX_ALLOC_FAIL, 0U, -1, 0U);
+        return -1;
+    }
+
+    txBuf->pkt  = pTxPkt;
+    txBuf->data = pTxPkt->bufPtr;
+    txBuf->size = ENET_TX_PKT_SIZE;
+    return 0;
+}
+
+/**
+ *  \brief Submits a loaned buffer for transmission.
+ *
+ *  \param txBuf Buffer obtained from Ethernet_acquireTxBuffer().
+ *  \param len   Number of bytes written into the buffer.
+ *  \return 0 on success, -1 on failure.
+ */
+int Ethernet_submitTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf, size_t len)
+{
+    EnetDma_Pkt *pTxPkt;
+
+    if ((txBuf == NULL) || (txBuf->pkt == NULL) || (len > txBuf->size))
+    {
+        return -1;
+    }
+
+    pTxPkt = (EnetDma_Pkt *)txBuf->pkt;
+    txBuf->pkt  = NULL;
+    txBuf->data = NULL;
+    return Ethernet_submitTxPkt(ctx, pTxPkt, len, ETHERNET_TX_PRIO_NORMAL, 0U);
+}
+
+/**
+ *  \brief Returns an unused loaned buffer to the driver.
+ *
+ *  \param txBuf Buffer obtained from Ethernet_acquireTxBuffer().
+ */
+void Ethernet_releaseTxBuffer(Lan8720_Ctx *ctx, Ethernet_TxBuf *txBuf)
+{
+    if ((txBuf != NULL) && (txBuf->pkt != NULL))
+    {
+        Ethernet_freeTxPkt(ctx, (EnetDma_Pkt *)txBuf->pkt);
+        txBuf->pkt  = NULL;
+        txBuf->data = NULL;
+    }
+}
+
+/**
+ *  \brief Receives an Ethernet packet.
+ *
+ *  This function attempts to retrieve a received packet and copies the data
+ *  into the provided buffer up to maxLen bytes.
+ *
+ *  \param buffer Pointer to a buffer where the received data will be stored.
+ *  \param maxLen Maximum number of bytes to copy.
+ *  \return Number of bytes received, or -1 if no packet was available.
+ */
+int Ethernet_receivePacket(Lan8720_Ctx *ctx, void *buffer, size_t maxLen)
+{
+    Ethernet_Frame frame;
+    uint32_t count;
+    ETHERNET_LAT_BEGIN(t0);
+
+    frame.buf  = buffer;
+    frame.size = (uint32_t)maxLen;
+    frame.len  = 0U;
+    count = Ethernet_receiveBurst(ctx, &frame, 1U);
+    ETHERNET_LAT_END(ETHERNET_LAT_RECEIVE, t0);
+    if (count == 0U)
+    {
+        return -1;  /* No packet available */
+    }
+    ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_RX, frame.len, 0, 0U);
+    return (int)frame.len;
+}
+
+/**
+ *  \brief Receives a batch of Ethernet packets.
+ *
+ *  Drains the packets retrieved from the DMA RX queue into the caller's
+ *  frame array, using the DMA packet length rather than the buffer
+ *  contents. Packets that do not fit in the array stay pending for the
+ *  next call. All consumed buffers are recycled to the RX free queue with a
+ *  single EnetDma_submitRxPktQ() call.
+ *
+ *  \param frames    Array of caller-provided frame buffers.
+ *  \param maxFrames Number of entries in the array.
+ *  \return Number of frames received.
+ */
+uint32_t Ethernet_receiveBurst(Lan8720_Ctx *ctx, Ethernet_Frame *frames, uint32_t maxFrames)
+{
+    Ethernet_PerfStats *perf;
+    EnetDma_PktQ rxQueue;
+    EnetDma_PktQ freeQueue;
+    EnetDma_Pkt *pRxPkt;
+    uint32_t count = 0U;
+    uint32_t len;
+    uintptr_t key;
+
+    if ((frames == NULL) || (maxFrames == 0U))
+    {
+        return 0U;
+    }
+
+    Ethernet_takeRxPendQ(ctx, &rxQueue, maxFrames);
+
+    perf = Ethernet_perfStats(ctx);
+    EnetQueue_initQ(&freeQueue);
+    while (count < maxFrames)
+    {
+        pRxPkt = (EnetDma_Pkt *)EnetQueue_deq(&rxQueue);
+        if (pRxPkt == NULL)
+        {
+            break;
+        }
+
+        len = pRxPkt->userBufLen;
+        if (len > frames[count].size)
+        {
+            len = frames[count].size;
+            perf->rxTruncated++;
+        }
+        memcpy(frames[count].buf, pRxPkt->bufPtr, len);
+        frames[count].len = len;
+        perf->rxBytes += pRxPkt->userBufLen;
+        perf->rxBytesCopied += len;
+        EnetQueue_enq(&freeQueue, &pRxPkt->node);
+        count++;
+    }
+
+    if (count > 0U)
+    {
+        perf->rxFrames += count;
+        key = Ethernet_rxLock(ctx);
+        EnetDma_submitRxPktQ(ctx->hEnet, ctx->macPort, &freeQueue);
+        Ethernet_rxUnlock(ctx, key);
+    }
+    return count;
+}
+
+/**
+ *  \brief Receives Ethernet packets without copying them.
+ *
+ *  Hands out read-only views of the DMA packet buffers so that the protocol
+ *  stack can parse headers in place. Each loaned packet must be returned
+ *  with Ethernet_releaseRxPacket().
+ *
+ *  \param rxBufs    Array filled in with the loaned frames.
+ *  \param maxFrames Number of entries in the array.
+ *  \return Number of frames loaned.
+ */
+uint32_t Ethernet_receiveLoan(Lan8720_Ctx *ctx, Ethernet_RxBuf *rxBufs, uint32_t maxFrames)
+{
+    Ethernet_PerfStats *perf;
+    EnetDma_PktQ rxQueue;
+    EnetDma_Pkt *pRxPkt;
+    uint32_t bytes = 0U;
+    uint32_t count = 0U;
+
+    if ((rxBufs == NULL) || (maxFrames == 0U))
+    {
+        return 0U;
+    }
+
+    Ethernet_takeRxPendQ(ctx, &rxQueue, maxFrames);
+
+    while (count < maxFrames)
+    {
+        pRxPkt = (EnetDma_Pkt *)EnetQueue_deq(&rxQueue);
+        if (pRxPkt == NULL)
+        {
+            break;
+        }
+
+        rxBufs[count].pkt  = pRxPkt;
+        rxBufs[count].data = pRxPkt->bufPtr;
+        rxBufs[count].len  = pRxPkt->userBufLen;
+        bytes += pRxPkt->userBufLen;
+        count++;
+    }
+    perf = Ethernet_perfStats(ctx);
+    perf->rxFrames += count;
+    perf->rxBytes += bytes;
+    return count;
+}
+
+/**
+ *  \brief Returns a loaned packet to the driver.
+ *
+ *  The packet is queued for recycling; the RX free queue is refilled once
+ *  ETHERNET_RX_REFILL_BATCH packets have been released, or on the next
+ *  receive call.
+ *
+ *  \param rxBuf Frame obtained from Ethernet_receiveLoan().
+ */
+void Ethernet_releaseRxPacket(Lan8720_Ctx *ctx, Ethernet_RxBuf *rxBuf)
+{
+    EnetDma_Pkt *pRxPkt;
+    uintptr_t key;
+    bool refill;
+
+    if ((rxBuf == NULL) || (rxBuf->pkt == NULL))
+    {
+        return;
+    }
+
+    pRxPkt = (EnetDma_Pkt *)rxBuf->pkt;
+    rxBuf->pkt  = NULL;
+    rxBuf->data = NULL;
+    key = Ethernet_rxLock(ctx);
+    EnetQueue_enq(&ctx->rxReleaseQueue, &pRxPkt->node);
+    refill = (EnetQueue_getQCount(&ctx->rxReleaseQueue) >= ETHERNET_RX_REFILL_BATCH);
+    Ethernet_rxUnlock(ctx, key);
+    if (refill)
+    {
+        Ethernet_refillRxFreeQ(ctx);
+    }
+}
+
+/**
+ *  \brief Retrieves the Ethernet link status.
+ *
+ *  \return 1 if the link is up, 0 otherwise.
+ */
+uint8_t Ethernet_getStatus(Lan8720_Ctx *ctx)
+{
+    uint16_t statusReg = 0;
+
+    if (ctx->linkMdioRegs != NULL)
+    {
+        /* Kept up to date by the MDIO controller, no MDIO access needed */
+        return ((CSL_REG32_RD(&ctx->linkMdioRegs->LINK_REG) &
+                 (1U << ctx->phyCfg.phyAddr)) != 0U) ? 1 : 0;
+    }
+    Lan8720_readReg(ctx->hPhy, LAN8720_BMSR, &statusReg);
+    return (statusReg & BMSR_LINK_STATUS) ? 1 : 0;
+}
+
+/**
+ *  \brief Returns the result of the last completed auto-negotiation.
+ *
+ *  \return 0 on success, -1 if auto-negotiation has not completed.
+ */
+int Ethernet_getLinkParams(Lan8720_Ctx *ctx, Ethernet_LinkParams *params)
+{
+    uint16_t statusReg = 0U, anlpar = 0U, scs = 0U;
+
+    Lan8720_readReg(ctx->hPhy, LAN8720_BMSR, &statusReg);
+    if ((statusReg & (BMSR_LINK_STATUS | BMSR_AUTO_NEG_COMPLETE)) !=
+        (BMSR_LINK_STATUS | BMSR_AUTO_NEG_COMPLETE))
+    {
+        return -1;
+    }
+    Lan8720_readReg(ctx->hPhy, LAN8720_ANLPAR, &anlpar);
+    Lan8720_readReg(ctx->hPhy, LAN8720_SPECIAL_CTRL_STATUS, &scs);
+    params->partnerAbility = anlpar;
+    params->speedIndi = scs & PHY_SCS_SPEED_INDI;
+    return 0;
+}
+
+/**
+ *  \brief Changes the LAN8720 configuration of a running port.
+ *
+ *  \return 0 if the changes were applied live, 1 if the PHY had to be
+ *          restarted, -1 on error.
+ */
+int Ethernet_reconfigurePhy(Lan8720_Ctx *ctx, const LAN8720_Cfg *cfg)
+{
+    bool restarted = false;
+
+    if ((ctx == NULL) || (cfg == NULL) ||
+        (Lan8720_reconfigure(ctx->hPhy, ctx->phyExtCfgSet ? &ctx->phyExtCfg : NULL,
+                             cfg, &restarted) != ENETPHY_SOK))
+    {
+        return -1;
+    }
+    ctx->phyExtCfg = *cfg;
+    if (!ctx->phyExtCfgSet)
+    {
+        /* Handed to the PHY driver so that its config hook keeps it */
+        ctx->phyExtCfgSet = true;
+        EnetPhy_setExtendedCfg(&ctx->phyCfg, &ctx->phyExtCfg, sizeof(LAN8720_Cfg));
+    }
+    return restarted ? 1 : 0;
+}
+
+/**
+ *  \brief Returns the link bring-up timings of a port.
+ */
+void Ethernet_getBootStats(Lan8720_Ctx *ctx, Ethernet_BootStats *stats)
+{
+    *stats = ctx->bootStats;
+}
+
+/**
+ *  \brief Enables MDIO preamble suppression.
+ *
+ *  The preamble is dropped by the MDIO controller for the whole bus, so the
+ *  Management Data Preamble Bypass bit is first set in every open PHY,
+ *  which still accepts frames with a preamble. The controller capability is
+ *  detected by reading back its PREAMBLE control bit, and the new mode is
+ *  verified by reading each PHY identifier without preamble. Any failure
+ *  restores the standard framing on all sides.
+ *
+ *  \param mdioBaseAddr Base address of the MDIO controller.
+ *  \return 0 on success, -1 if preamble suppression is not usable.
+ */
+int Ethernet_enableFastMdio(uintptr_t mdioBaseAddr)
+{
+    CSL_mdioRegs *mdioRegs = (CSL_mdioRegs *)mdioBaseAddr;
+    uint16_t phyId1[ETHERNET_CFG_PORT_NUM], phyId2[ETHERNET_CFG_PORT_NUM];
+    uint16_t chkId1 = 0U, chkId2 = 0U;
+    bool verified = true;
+    uint32_t i;
+
+    if (mdioRegs == NULL)
+    {
+        return -1;
+    }
+    if (fastMdioRegs != NULL)
+    {
+        return 0;
+    }
+
+    /* Reference identifiers, read with the standard preamble */
+    for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+    {
+        phyId1[i] = 0U;
+        phyId2[i] = 0U;
+        if (ethCtx[i].inUse && (ethCtx[i].hPhy != NULL))
+        {
+            Lan8720_readReg(ethCtx[i].hPhy, LAN8720_PHYID1, &phyId1[i]);
+            Lan8720_readReg(ethCtx[i].hPhy, LAN8720_PHYID2, &phyId2[i]);
+        }
+    }
+    Ethernet_setPreambleBypass(true);
+
+    Ethernet_setMdioPreamble(mdioRegs, false);
+    if (CSL_REG32_FEXT(&mdioRegs->CONTROL_REG, MDIO_CONTROL_REG_PREAMBLE) == 0U)
+    {
+        /* Controller cannot drop the preamble */
+        Ethernet_setPreambleBypass(false);
+        printf("Fast MDIO not supported by the MDIO controller\n");
+        return -1;
+    }
+
+    for (i = 0U; (i < ETHERNET_CFG_PORT_NUM) && verified; i++)
+    {
+        if (ethCtx[i].inUse && (ethCtx[i].hPhy != NULL))
+        {
+            Lan8720_readReg(ethCtx[i].hPhy, LAN8720_PHYID1, &chkId1);
+            Lan8720_readReg(ethCtx[i].hPhy, LAN8720_PHYID2, &chkId2);
+            verified = (chkId1 == phyId1[i]) && (chkId2 == phyId2[i]);
+        }
+    }
+    if (!verified)
+    {
+        Ethernet_setMdioPreamble(mdioRegs, true);
+        Ethernet_setPreambleBypass(false);
+        printf("Fast MDIO verification failed, using standard preamble\n");
+        return -1;
+    }
+
+    fastMdioRegs = mdioRegs;
+    printf("Fast MDIO enabled\n");
+    return 0;
+}
+
+/**
+ *  \brief Restores the standard MDIO preamble.
+ */
+void Ethernet_disableFastMdio(void)
+{
+    if (fastMdioRegs != NULL)
+    {
+        /* The PHYs accept both framings while the bypass bit is set */
+        Ethernet_setMdioPreamble(fastMdioRegs, true);
+        fastMdioRegs = NULL;
+        Ethernet_setPreambleBypass(false);
+    }
+}
+
+/**
+ *  \brief Hands link monitoring of a port over to the MDIO controller.
+ *
+ *  The controller polls the BMSR of every PHY answering on the bus and
+ *  mirrors the link bits in its LINK register. The PHY is also selected in
+ *  a free user group, with LINKSEL cleared so the state comes from MDIO
+ *  polling rather than the MLINK pin, so that link changes raise the MDIO
+ *  link interrupt. With both groups taken, the port still reads its link
+ *  from the LINK register and is told of changes by the PHY interrupt.
+ *
+ *  \param ctx          Port context.
+ *  \param mdioBaseAddr Base address of the MDIO controller, or of a
+ *                      CSL_mdioRegs block in RAM standing in for it.
+ *  \return 0 on success, -1 if the controller does not see the PHY.
+ */
+int Ethernet_enableHwLinkPoll(Lan8720_Ctx *ctx, uintptr_t mdioBaseAddr)
+{
+    CSL_mdioRegs *mdioRegs = (CSL_mdioRegs *)mdioBaseAddr;
+    uint32_t phyAddr;
+    bool used;
+    int32_t group = -1;
+    uint32_t g, i;
+
+    if ((ctx == NULL) || (mdioRegs == NULL))
+    {
+        return -1;
+    }
+    if (ctx->linkMdioRegs != NULL)
+    {
+        return 0;
+    }
+
+    phyAddr = ctx->phyCfg.phyAddr;
+    if ((CSL_REG32_RD(&mdioRegs->ALIVE_REG) & (1U << phyAddr)) == 0U)
+    {
+        printf("PHY %u not polled by the MDIO controller\n", (unsigned)phyAddr);
+        return -1;
+    }
+
+    for (g = 0U; (g < ETHERNET_MDIO_USER_GROUP_NUM) && (group < 0); g++)
+    {
+        used = false;
+        for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+        {
+            if (ethCtx[i].inUse && (ethCtx[i].linkMdioRegs != NULL) &&
+                (ethCtx[i].linkGroup == (int32_t)g))
+            {
+                used = true;
+            }
+        }
+        if (!used)
+        {
+            group = (int32_t)g;
+        }
+    }
+
+    if (group >= 0)
+    {
+        CSL_REG32_WR(&mdioRegs->USER_GROUP[group].USER_PHY_SEL_REG,
+                     ((phyAddr << CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_PHYADR_MON_SHIFT) &
+                      CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_PHYADR_MON_MASK) |
+                     CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKINT_ENABLE_MASK);
+        CSL_REG32_WR(&mdioRegs->LINK_INT_RAW_REG, 1U << group);
+        CSL_REG32_WR(&mdioRegs->LINK_INT_MASK_SET_REG, 1U << group);
+    }
+
+    ctx->linkGroup = group;
+    ctx->linkMdioRegs = mdioRegs;
+    printf("Port %u link monitored by the MDIO controller (%s)\n", (unsigned)ctx->macPort,
+           (group >= 0) ? "link interrupt" : "PHY interrupt");
+    return 0;
+}
+
+/**
+ *  \brief Goes back to reading the link state from the PHY.
+ */
+void Ethernet_disableHwLinkPoll(Lan8720_Ctx *ctx)
+{
+    CSL_mdioRegs *mdioRegs = ctx->linkMdioRegs;
+
+    if (mdioRegs == NULL)
+    {
+        return;
+    }
+    if (ctx->linkGroup >= 0)
+    {
+        CSL_REG32_WR(&mdioRegs->LINK_INT_MASK_CLEAR_REG, 1U << ctx->linkGroup);
+        CSL_REG32_WR(&mdioRegs->USER_GROUP[ctx->linkGroup].USER_PHY_SEL_REG, 0U);
+        CSL_REG32_WR(&mdioRegs->LINK_INT_RAW_REG, 1U << ctx->linkGroup);
+    }
+    ctx->linkMdioRegs = NULL;
+    ctx->linkGroup = -1;
+}
+
+/**
+ *  \brief MDIO link interrupt handler.
+ *
+ *  To be called from the MDIO controller link interrupt, shared by all
+ *  ports. Acknowledges the user groups that fired and wakes the device
+ *  task of their ports.
+ */
+void Ethernet_mdioLinkIsr(void)
+{
+    CSL_mdioRegs *mdioRegs;
+    uint32_t raw;
+    uint32_t i;
+
+    for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+    {
+        mdioRegs = ethCtx[i].linkMdioRegs;
+        if (!ethCtx[i].inUse || (mdioRegs == NULL) || (ethCtx[i].linkGroup < 0))
+        {
+            continue;
+        }
+        raw = CSL_REG32_RD(&mdioRegs->LINK_INT_RAW_REG) & (1U << ethCtx[i].linkGroup);
+        if (raw != 0U)
+        {
+            CSL_REG32_WR(&mdioRegs->LINK_INT_RAW_REG, raw);
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+            Ethernet_postEvent(&ethCtx[i], ETHERNET_EVENT_LINK);
+#endif
+        }
+    }
+}
+
+/**
+ *  \brief PHY interrupt handler.
+ *
+ *  To be called from the interrupt wired to the LAN8720 nINT pin. Only
+ *  wakes the device task; the interrupt source register is read (and
+ *  thereby cleared) from task context since it needs MDIO access.
+ */
+void Ethernet_phyIsr(Lan8720_Ctx *ctx)
+{
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    Ethernet_postEvent(ctx, ETHERNET_EVENT_PHY);
+#endif
+}
+
+/**
+ *  \brief DMA RX completion callback.
+ *
+ *  To be registered as the notify callback of the RX channel/flow.
+ *
+ *  \param cbArg Port context.
+ */
+void Ethernet_rxNotify(void *cbArg)
+{
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    Ethernet_postEvent((Lan8720_Ctx *)cbArg, ETHERNET_EVENT_RX);
+#endif
+}
+
+/**
+ *  \brief DMA TX completion callback.
+ *
+ *  To be registered as the notify callback of the TX channel. Completed
+ *  packets are reclaimed by the device task.
+ *
+ *  \param cbArg Port context.
+ */
+void Ethernet_txNotify(void *cbArg)
+{
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    Ethernet_postEvent((Lan8720_Ctx *)cbArg, ETHERNET_EVENT_TX);
+#endif
+}
+
+/**
+ *  \brief Reclaims completed TX packets.
+ *
+ *  Retrieves every packet the DMA has finished with in one call and returns
+ *  each to the pool it was taken from. Runs from the device task on
+ *  a TX completion event or when a sender signals that its pool runs low.
+ *  Without the device task to signal, in polled mode, senders call it from
+ *  the allocation path instead, on any core. The retrieval, the return to
+ *  the pools and the counters are done under the TX lock, which holds off
+ *  the other cores too, so that only one context at a time takes packets
+ *  from the DMA.
+ *
+ *  \return Number of packets reclaimed.
+ */
+uint32_t Ethernet_reclaimTx(Lan8720_Ctx *ctx)
+{
+    EnetDma_PktQ doneQueue;
+    uint32_t count;
+    uintptr_t key;
+
+    EnetQueue_initQ(&doneQueue);
+    key = Ethernet_txLock(ctx);
+    EnetDma_retrieveTxPktQ(ctx->hEnet, ctx->macPort, &doneQueue);
+    count = Ethernet_freeTxPktQ(ctx, &doneQueue);
+    if (count > 0U)
+    {
+        ctx->txReclaim.reclaims++;
+        ctx->txReclaim.pktsReclaimed += count;
+        ctx->txReclaim.inFlight -= (count <= ctx->txReclaim.inFlight) ? count : ctx->txReclaim.inFlight;
+    }
+    Ethernet_txUnlock(ctx, key);
+
+    if (count > 0U)
+    {
+        ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_TX_RECLAIM, 0U, 0, count);
+    }
+    if (Ethernet_txBacklog(ctx))
+    {
+        /* Completions make room in the DMA queue for paced frames */
+        Ethernet_paceTx(ctx);
+    }
+    return count;
+}
+
+/**
+ *  \brief Gets the TX completion counters.
+ *
+ *  \param stats Filled in with the counters.
+ */
+void Ethernet_getTxReclaimStats(Lan8720_Ctx *ctx, Ethernet_TxReclaimStats *stats)
+{
+    uintptr_t key;
+
+    if (stats != NULL)
+    {
+        key = Ethernet_txLock(ctx);
+        *stats = ctx->txReclaim;
+        Ethernet_txUnlock(ctx, key);
+    }
+}
+
+/**
+ *  \brief Gets the TX pacing counters.
+ *
+ *  \param stats Filled in with the counters.
+ */
+void Ethernet_getTxPaceStats(Lan8720_Ctx *ctx, Ethernet_TxPaceStats *stats)
+{
+    uintptr_t key;
+    uint32_t prio;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    key = Ethernet_txLock(ctx);
+    *stats = ctx->txPace.stats;
+    for (prio = 0U; prio < ETHERNET_TX_PRIO_NUM; prio++)
+    {
+        stats->queued[prio] = EnetQueue_getQCount(&ctx->txPace.queue[prio]);
+    }
+    Ethernet_txUnlock(ctx, key);
+}
+
+/**
+ *  \brief Sets the adaptive RX engine parameters.
+ *
+ *  \param cfg New budget and empty-poll threshold.
+ */
+void Ethernet_setRxPollCfg(Lan8720_Ctx *ctx, const Ethernet_RxPollCfg *cfg)
+{
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    if ((cfg != NULL) && (cfg->budget > 0U) && (cfg->maxEmptyPolls > 0U))
+    {
+        ctx->rxPoll.cfg = *cfg;
+    }
+#endif
+}
+
+/**
+ *  \brief Gets the adaptive RX engine counters.
+ *
+ *  The time spent in the current mode is accounted up to the call.
+ *
+ *  \param stats Filled in with the counters.
+ */
+void Ethernet_getRxPollStats(Lan8720_Ctx *ctx, Ethernet_RxPollStats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    *stats = ctx->rxPoll.stats;
+    if (ctx->rxPoll.mode == ETHERNET_RX_MODE_POLL)
+    {
+        stats->pollModeUs += TimerP_getTimeInUsecs() - ctx->rxPoll.modeStartUs;
+    }
+    else
+    {
+        stats->intrModeUs += TimerP_getTimeInUsecs() - ctx->rxPoll.modeStartUs;
+    }
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/**
+ *  \brief Gets the data path counters.
+ *
+ *  \param stats Filled in with the counters.
+ */
+void Ethernet_getPerfStats(Lan8720_Ctx *ctx, Ethernet_PerfStats *stats)
+{
+    const Ethernet_PerfStats *perf;
+    uint32_t i;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0U; i < ETHERNET_CFG_POOL_CORE_NUM; i++)
+    {
+        perf = &ctx->coreStats[i].perf;
+        stats->txFrames      += perf->txFrames;
+        stats->txBytes       += perf->txBytes;
+        stats->txBytesCopied += perf->txBytesCopied;
+        stats->rxFrames      += perf->rxFrames;
+        stats->rxBytes       += perf->rxBytes;
+        stats->rxBytesCopied += perf->rxBytesCopied;
+        stats->txDrops       += perf->txDrops;
+        stats->txTruncated   += perf->txTruncated;
+        stats->rxTruncated   += perf->rxTruncated;
+    }
+}
+
+/**
+ *  \brief Clears the data path counters.
+ */
+void Ethernet_resetPerfStats(Lan8720_Ctx *ctx)
+{
+    uint32_t i;
+
+    for (i = 0U; i < ETHERNET_CFG_POOL_CORE_NUM; i++)
+    {
+        memset(&ctx->coreStats[i].perf, 0, sizeof(ctx->coreStats[i].perf));
+    }
+}
+
+/**
+ *  \brief Gets the data path counters of one core.
+ *
+ *  \param coreIdx Core index.
+ *  \param stats   Filled in with the counters.
+ */
+void Ethernet_getCoreStats(Lan8720_Ctx *ctx, uint32_t coreIdx, Ethernet_PerfStats *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    if (coreIdx >= ETHERNET_CFG_POOL_CORE_NUM)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    *stats = ctx->coreStats[coreIdx].perf;
+}
+
+/**
+ *  \brief Takes a snapshot of all the counters of a port.
+ *
+ *  Only reads driver memory, so it can be polled at any rate.
+ *
+ *  \param stats Filled in with the snapshot.
+ */
+void Ethernet_getStats(Lan8720_Ctx *ctx, Ethernet_Stats *stats)
+{
+    Ethernet_PktPool *pool;
+    uint32_t i;
+
+    if (stats == NULL)
+    {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+    stats->timeUs = TimerP_getTimeInUsecs();
+    Ethernet_getPerfStats(ctx, &stats->perf);
+    for (i = 0U; i < ETHERNET_CFG_POOL_CORE_NUM; i++)
+    {
+        pool = &ctx->txPool[i];
+        stats->txAllocFail += pool->stats.allocFail;
+        stats->txPoolFree += pool->head - pool->tail;
+    }
+    stats->txReclaim = ctx->txReclaim;
+    for (i = 0U; i < ctx->numChans; i++)
+    {
+        stats->rxBacklog += Ethernet_ringCount(&ctx->chan[i].rxRing);
+    }
+    stats->linkUp = ctx->link.linkUp;
+    stats->symbolErrors = ctx->symErr.total;
+    stats->symbolErrorRate = ctx->symErr.rate;
+}
+
+/**
+ *  \brief Sets the TX packet pool watermarks of every core.
+ *
+ *  \param lowWm  Free count below which the pool is under pressure.
+ *  \param highWm Free count at which the pressure condition clears.
+ *  \return 0 on success, -1 on invalid watermarks.
+ */
+int Ethernet_setPoolWatermarks(Lan8720_Ctx *ctx, uint32_t lowWm, uint32_t highWm)
+{
+    uint32_t i;
+
+    if ((lowWm >= highWm) || (highWm > ETHERNET_CFG_TX_POOL_SIZE))
+    {
+        return -1;
+    }
+    for (i = 0U; i < ETHERNET_CFG_POOL_CORE_NUM; i++)
+    {
+        ctx->txPool[i].lowWm = lowWm;
+        ctx->txPool[i].highWm = highWm;
+    }
+    return 0;
+}
+
+/**
+ *  \brief Gets the TX packet pool counters of a core.
+ *
+ *  \param coreIdx Pool index, below ETHERNET_CFG_POOL_CORE_NUM.
+ *  \param stats   Filled in with the counters.
+ */
+void Ethernet_getPoolStats(Lan8720_Ctx *ctx, uint32_t coreIdx, Ethernet_PoolStats *stats)
+{
+    Ethernet_PktPool *pool;
+
+    if ((stats == NULL) || (coreIdx >= ETHERNET_CFG_POOL_CORE_NUM))
+    {
+        return;
+    }
+    pool = &ctx->txPool[coreIdx];
+    *stats = pool->stats;
+    stats->freeCnt = pool->head - pool->tail;
+}
+
+/**
+ *  \brief Computes the flow hash of a frame.
+ *
+ *  Hashes the MAC addresses and, for IPv4 and IPv6, the addresses and
+ *  protocol, plus the ports of unfragmented TCP and UDP packets. A single
+ *  VLAN tag is skipped. Frames of one flow always get the same hash.
+ *
+ *  \param frame Frame data, starting at the destination MAC address.
+ *  \param len   Frame length in bytes.
+ *  \return The flow hash.
+ */
+uint32_t Ethernet_flowHash(const uint8_t *frame, uint32_t len)
+{
+    uint32_t hash = ETHERNET_FNV_OFFSET;
+    uint32_t off = 12U;
+    uint32_t type, ihl, proto = 0U;
+    uint32_t i;
+    bool ports = false;
+
+    if ((frame == NULL) || (len < 14U))
+    {
+        return hash;
+    }
+
+    type = ((uint32_t)frame[off] << 8) | frame[off + 1U];
+    if ((type == ETHERNET_ETHERTYPE_VLAN) && (len >= 18U))
+    {
+        off += 4U;
+        type = ((uint32_t)frame[off] << 8) | frame[off + 1U];
+    }
+    off += 2U;
+
+    for (i = 0U; i < 12U; i++)
+    {
+        hash = (hash ^ frame[i]) * ETHERNET_FNV_PRIME;
+    }
+
+    if ((type == ETHERNET_ETHERTYPE_IPV4) && (len >= (off + 20U)))
+    {
+        ihl = (frame[off] & 0x0FU) * 4U;
+        proto = frame[off + 9U];
+        /* Fragments (MF or offset set) hash without ports so that all
+         * pieces of a datagram stay on one channel */
+        ports = ((frame[off + 6U] & 0x3FU) == 0U) && (frame[off + 7U] == 0U);
+        hash = (hash ^ proto) * ETHERNET_FNV_PRIME;
+        for (i = off + 12U; i < (off + 20U); i++)
+        {
+            hash = (hash ^ frame[i]) * ETHERNET_FNV_PRIME;
+        }
+        off += ihl;
+    }
+    else if ((type == ETHERNET_ETHERTYPE_IPV6) && (len >= (off + 40U)))
+    {
+        proto = frame[off + 6U];
+        ports = true;
+        hash = (hash ^ proto) * ETHERNET_FNV_PRIME;
+        for (i = off + 8U; i < (off + 40U); i++)
+        {
+            hash = (hash ^ frame[i]) * ETHERNET_FNV_PRIME;
+        }
+        off += 40U;
+    }
+
+    if (ports && ((proto == ETHERNET_IP_PROTO_TCP) || (proto == ETHERNET_IP_PROTO_UDP)) &&
+        (len >= (off + 4U)))
+    {
+        for (i = off; i < (off + 4U); i++)
+        {
+            hash = (hash ^ frame[i]) * ETHERNET_FNV_PRIME;
+        }
+    }
+    return hash;
+}
+
+/**
+ *  \brief Returns the channel a frame is steered to.
+ *
+ *  Transmitting a flow from the worker of its channel keeps the flow on a
+ *  single core and in order.
+ */
+uint32_t Ethernet_flowChannel(Lan8720_Ctx *ctx, const void *frame, uint32_t len)
+{
+    return Ethernet_flowHash((const uint8_t *)frame, len) % ctx->numChans;
+}
+
+/**
+ *  \brief Receives frames steered to an RX channel without copying them.
+ *
+ *  Takes frames from the lock-free ring of the channel. When the ring is
+ *  empty and wait is set, sleeps until the device task steers more frames;
+ *  this is the only place a semaphore is involved. Each loaned frame must
+ *  be returned with Ethernet_releaseChanPacket(). Only one task may consume
+ *  a given channel. A port with a single channel has no rings; its frames
+ *  are read with Ethernet_receivePacket() and the like.
+ *
+ *  \param ctx       Port context.
+ *  \param chIdx     Channel index.
+ *  \param rxBufs    Array filled in with the loaned frames.
+ *  \param maxFrames Number of entries in the array.
+ *  \param wait      Block while the channel is empty.
+ *  \return Number of frames loaned.
+ */
+uint32_t Ethernet_receiveChan(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_RxBuf *rxBufs,
+                              uint32_t maxFrames, bool wait)
+{
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    Ethernet_Chan *chan;
+    uint32_t count, i;
+
+    if ((rxBufs == NULL) || (maxFrames == 0U) || (ctx->numChans < 2U) ||
+        (chIdx >= ctx->numChans))
+    {
+        return 0U;
+    }
+    chan = &ctx->chan[chIdx];
+
+    if (maxFrames > ETHERNET_RX_DRAIN_BATCH)
+    {
+        maxFrames = ETHERNET_RX_DRAIN_BATCH;
+    }
+    if (wait)
+    {
+        count = Ethernet_ringWait(&chan->rxRing, pkts, maxFrames);
+    }
+    else
+    {
+        count = Ethernet_ringGet(&chan->rxRing, pkts, maxFrames);
+    }
+
+    for (i = 0U; i < count; i++)
+    {
+        rxBufs[i].pkt  = pkts[i];
+        rxBufs[i].data = pkts[i]->bufPtr;
+        rxBufs[i].len  = pkts[i]->userBufLen;
+        chan->stats.rxBytes += pkts[i]->userBufLen;
+    }
+    chan->stats.rxFrames += count;
+    return count;
+}
+
+/**
+ *  \brief Returns a frame obtained with Ethernet_receiveChan().
+ *
+ *  The buffer travels back to the device task through the free ring of the
+ *  channel. The device task is only woken once ETHERNET_RX_REFILL_BATCH
+ *  released buffers are waiting; fewer are picked up within
+ *  ETHERNET_CFG_RX_RECYCLE_IDLE_MS.
+ *
+ *  \param ctx   Port context.
+ *  \param chIdx Channel the frame was received on.
+ *  \param rxBuf Loaned frame.
+ */
+void Ethernet_releaseChanPacket(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_RxBuf *rxBuf)
+{
+    EnetDma_PktQ freeQueue;
+    Ethernet_Ring *ring;
+
+    if ((rxBuf == NULL) || (rxBuf->pkt == NULL) || (ctx->numChans < 2U) ||
+        (chIdx >= ctx->numChans))
+    {
+        return;
+    }
+
+    ring = &ctx->chan[chIdx].freeRing;
+    EnetQueue_initQ(&freeQueue);
+    EnetQueue_enq(&freeQueue, &((EnetDma_Pkt *)rxBuf->pkt)->node);
+    rxBuf->pkt  = NULL;
+    rxBuf->data = NULL;
+    Ethernet_ringPut(ring, &freeQueue);
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    if (Ethernet_ringCount(ring) >= ETHERNET_RX_REFILL_BATCH)
+    {
+        Ethernet_postEvent(ctx, ETHERNET_EVENT_RECYCLE);
+    }
+#endif
+}
+
+/**
+ *  \brief Worker task of an RX channel.
+ *
+ *  Default consumer of a channel: sleeps until the device task steers
+ *  frames to it, processes them and hands the buffers back. Run one task
+ *  per channel, each on the core the channel is pinned to, e.g. channel 0
+ *  on mcu2_0 and channel 1 on mcu2_1, unless the application consumes the
+ *  channel with Ethernet_receiveChan() itself.
+ *
+ *  \param ctx   Port context.
+ *  \param chIdx Channel index.
+ */
+void Ethernet_chanMain(Lan8720_Ctx *ctx, uint32_t chIdx)
+{
+    Ethernet_RxBuf rxBufs[ETHERNET_RX_DRAIN_BATCH];
+    uint32_t count, i;
+
+    if ((ctx == NULL) || (ctx->numChans < 2U) || (chIdx >= ctx->numChans))
+    {
+        return;
+    }
+
+    while (1)
+    {
+        count = Ethernet_receiveChan(ctx, chIdx, rxBufs, ETHERNET_RX_DRAIN_BATCH, true);
+        for (i = 0U; i < count; i++)
+        {
+            ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_CHAN_RX, rxBufs[i].len, 0, chIdx);
+            Ethernet_releaseChanPacket(ctx, chIdx, &rxBufs[i]);
+        }
+    }
+}
+
+/**
+ *  \brief Gets the counters of an RX channel.
+ *
+ *  \param ctx   Port context.
+ *  \param chIdx Channel index.
+ *  \param stats Filled in with the counters.
+ */
+void Ethernet_getChanStats(Lan8720_Ctx *ctx, uint32_t chIdx, Ethernet_ChanStats *stats)
+{
+    Ethernet_Chan *chan;
+
+    if ((stats != NULL) && (chIdx < ctx->numChans))
+    {
+        chan = &ctx->chan[chIdx];
+        *stats = chan->stats;
+        stats->steered = chan->steered;
+        stats->wakeups = chan->rxRing.wakeups;
+        stats->maxBacklog = chan->maxBacklog;
+    }
+}
+
+/**
+ *  \brief Returns the binary trace ring and its size in bytes.
+ */
+const void *Ethernet_getTrace(uint32_t *size)
+{
+#if (ETHERNET_TRACE_ENABLED == 1)
+    *size = (uint32_t)sizeof(gEthernetTrace);
+    return &gEthernetTrace;
+#else
+    *size = 0U;
+    return NULL;
+#endif
+}
+
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+/**
+ *  \brief Gets the latency histogram of an operation.
+ */
+void Ethernet_getLatencyHist(Ethernet_LatOp op, Ethernet_LatHist *hist)
+{
+    if (hist == NULL)
+    {
+        return;
+    }
+    if ((uint32_t)op >= ETHERNET_LAT_OP_NUM)
+    {
+        memset(hist, 0, sizeof(*hist));
+        return;
+    }
+    *hist = ethLatHist[op];
+}
+
+/**
+ *  \brief Clears all latency histograms.
+ */
+void Ethernet_resetLatencyHist(void)
+{
+    memset(ethLatHist, 0, sizeof(ethLatHist));
+}
+
+/**
+ *  \brief Prints all non-empty latency histograms.
+ */
+void Ethernet_dumpLatencyHist(void)
+{
+    const Ethernet_LatHist *hist;
+    uint32_t op, b;
+
+    for (op = 0U; op < ETHERNET_LAT_OP_NUM; op++)
+    {
+        hist = &ethLatHist[op];
+        if (hist->count == 0U)
+        {
+            continue;
+        }
+        printf("%s: %u samples, min %u, avg %u, max %u ticks\n", ethLatOpName[op],
+               (unsigned)hist->count, (unsigned)hist->min,
+               (unsigned)(hist->sum / hist->count), (unsigned)hist->max);
+        for (b = 0U; b < ETHERNET_LAT_BUCKET_NUM; b++)
+        {
+            if (hist->bucket[b] != 0U)
+            {
+                printf("  < 2^%-2u: %u\n", (unsigned)b, (unsigned)hist->bucket[b]);
+            }
+        }
+    }
+}
+#endif
+
+/**
+ *  \brief Main device function for managing Ethernet tasks.
+ *
+ *  This function initializes the driver and then services received packets
+ *  and link changes. In event mode RX runs as an adaptive engine: the task
+ *  sleeps until a PHY interrupt or a DMA RX completion wakes it, then masks
+ *  the RX event and busy-polls with a per-iteration budget while frames
+ *  keep arriving. After cfg.maxEmptyPolls empty polls in a row it unmasks
+ *  the RX event and goes back to sleep. Without event mode it polls once
+ *  per second. Run one task per port. With several RX channels this task
+ *  only hands received frames to the channel rings; they are consumed by
+ *  Ethernet_chanMain() or by the application through
+ *  Ethernet_receiveChan(). With a single channel the frames are read in
+ *  place by Ethernet_receivePacket(), Ethernet_receiveBurst() or
+ *  Ethernet_receiveLoan(); while polling, this task keeps them retrieved
+ *  from the DMA and the released buffers recycled.
+ *
+ *  \param cfg Port configuration.
+ */
+void Ethernet_deviceMain(const Ethernet_PortCfg *cfg)
+{
+    Lan8720_Ctx *ctx = Ethernet_initAsync(cfg);
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    uint32_t events;
+    uint32_t timeout;
+    uint8_t linkUp;
+
+    if (ctx == NULL)
+    {
+        return;
+    }
+    linkUp = 0U;
+    ctx->rxPoll.modeStartUs = TimerP_getTimeInUsecs();
+    while (1)
+    {
+        if (ctx->rxPoll.mode == ETHERNET_RX_MODE_INTR)
+        {
+            timeout = Ethernet_linkPending(ctx) ? ETHERNET_LINK_TICK_MS : ETHERNET_CFG_STATS_SAMPLE_MS;
+            if (Ethernet_chanRxOut(ctx) && (timeout > ETHERNET_CFG_RX_RECYCLE_IDLE_MS))
+            {
+                /* Pick up buffers released short of a full batch */
+                timeout = ETHERNET_CFG_RX_RECYCLE_IDLE_MS;
+            }
+            if (Ethernet_txBacklog(ctx))
+            {
+                /* Refill the token bucket while paced frames wait */
+                timeout = ETHERNET_TX_PACE_TICK_MS;
+            }
+            events = Ethernet_waitEvents(ctx, timeout);
+        }
+        else
+        {
+            events = Ethernet_takeEvents(ctx);
+        }
+
+        ETHERNET_TRACE_DBG(ctx, ETHERNET_TRACE_DEV_EVENT, 0U, 0, events);
+        if ((events & ETHERNET_EVENT_PHY) != 0U)
+        {
+            linkUp = Ethernet_handlePhyEvent(ctx);
+        }
+        else if ((events & ETHERNET_EVENT_LINK) != 0U)
+        {
+            /* Reported by the MDIO controller, the state is in LINK_REG */
+            linkUp = Ethernet_linkTick(ctx);
+            ETHERNET_TRACE_INFO(ctx, ETHERNET_TRACE_LINK, 0U, 0, linkUp);
+            printf("Link %s\n", linkUp ? "up" : "down");
+        }
+        else if (Ethernet_linkPending(ctx))
+        {
+            Ethernet_initTick(ctx);
+            linkUp = ctx->link.linkUp;
+        }
+
+        if (((events & ETHERNET_EVENT_TX) != 0U) || Ethernet_txBacklog(ctx))
+        {
+            Ethernet_reclaimTx(ctx);
+        }
+
+        Ethernet_sampleStats(ctx);
+
+        if (((events & ETHERNET_EVENT_RECYCLE) != 0U) ||
+            ((events == 0U) && (ctx->rxPoll.mode == ETHERNET_RX_MODE_INTR)))
+        {
+            Ethernet_recycleChanRx(ctx);
+            Ethernet_refillRxFreeQ(ctx);
+        }
+
+        if ((ctx->rxPoll.mode == ETHERNET_RX_MODE_INTR) && linkUp &&
+            ((events & ETHERNET_EVENT_RX) != 0U))
+        {
+            EnetDma_disableRxEvent(ctx->hEnet, ctx->macPort);
+            Ethernet_setRxMode(ctx, ETHERNET_RX_MODE_POLL);
+        }
+
+        if (ctx->rxPoll.mode == ETHERNET_RX_MODE_POLL)
+        {
+            Ethernet_rxPoll(ctx, linkUp);
+        }
+    }
+#else
+    uint32_t sleepMs;
+
+    if (ctx == NULL)
+    {
+        return;
+    }
+    while (1)
+    {
+        Ethernet_initTick(ctx);
+        Ethernet_sampleStats(ctx);
+        if (ctx->link.linkUp)
+        {
+            Ethernet_drainRx(ctx, UINT32_MAX);
+        }
+        /* Add delay or yield to RTOS scheduler as needed. Without TX
+         * completion events, paced frames are released from here. */
+        sleepMs = Ethernet_linkPending(ctx) ? ETHERNET_LINK_TICK_MS : 1000U;
+        while (Ethernet_txBacklog(ctx) && (sleepMs > 0U))
+        {
+            Ethernet_reclaimTx(ctx);
+            EnetOsal_sleep(ETHERNET_TX_PACE_TICK_MS);
+            sleepMs -= ETHERNET_TX_PACE_TICK_MS;
+        }
+        if (sleepMs > 0U)
+        {
+            EnetOsal_sleep(sleepMs);
+        }
+    }
+#endif
+}
+
+/* ========================================================================== */
+/*                     Ethernet Driver Internal Functions                     */
+/* ========================================================================== */
+
+/**
+ *  \brief Reads the PHY identifier and starts auto-negotiation.
+ *
+ *  Shared by Ethernet_config() and the config hook of the PHY driver,
+ *  which runs before the port context knows its PHY handle.
+ */
+static void Ethernet_configPhy(EnetPhy_Handle hPhy)
+{
+    uint16_t phyId1 = 0, phyId2 = 0;
+    Lan8720_readReg(hPhy, LAN8720_PHYID1, &phyId1);
+    Lan8720_readReg(hPhy, LAN8720_PHYID2, &phyId2);
+    printf("LAN8720 PHY %u ID1: 0x%x, PHY ID2: 0x%x\n", (unsigned)hPhy->addr, phyId1, phyId2);
+
+    Lan8720_Ctx *ctx = Ethernet_findCtx(hPhy->addr);
+    if ((ctx != NULL) && (ctx->link.state == ETHERNET_LINK_FORCED))
+    {
+        Ethernet_forceLink(hPhy, &ctx->link.cached);
+    }
+    else
+    {
+        Ethernet_startAutoNeg(hPhy);
+    }
+}
+
+/**
+ *  \brief Returns the port context driving the PHY at an MDIO address.
+ */
+static Lan8720_Ctx *Ethernet_findCtx(uint32_t phyAddr)
+{
+    uint32_t i;
+
+    for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+    {
+        if (ethCtx[i].inUse && (ethCtx[i].phyCfg.phyAddr == phyAddr))
+        {
+            return &ethCtx[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Enables and restarts auto-negotiation.
+ */
+static void Ethernet_startAutoNeg(EnetPhy_Handle hPhy)
+{
+    uint16_t ctrlReg = BMCR_AUTO_NEG_ENABLE | BMCR_RESTART_AUTO_NEG;
+    Lan8720_writeReg(hPhy, LAN8720_BMCR, ctrlReg);
+}
+
+/**
+ *  \brief Disables auto-negotiation and forces the cached speed and duplex.
+ */
+static void Ethernet_forceLink(EnetPhy_Handle hPhy, const Ethernet_LinkParams *params)
+{
+    uint16_t ctrlReg = 0U;
+
+    if ((params->speedIndi & PHY_SCS_SPEED_100) != 0U)
+    {
+        ctrlReg |= BMCR_SPEED_SEL;
+    }
+    if ((params->speedIndi & PHY_SCS_FULL_DUPLEX) != 0U)
+    {
+        ctrlReg |= BMCR_DUPLEX_MODE;
+    }
+    ENETTRACE_DBG("PHY %u: forcing %s Mbps %s duplex", hPhy->addr,
+                  ((ctrlReg & BMCR_SPEED_SEL) != 0U) ? "100" : "10",
+                  ((ctrlReg & BMCR_DUPLEX_MODE) != 0U) ? "full" : "half");
+    Lan8720_writeReg(hPhy, LAN8720_BMCR, ctrlReg);
+}
+
+#if (ETHERNET_CFG_LINK_RECHECK_ANEG == 0)
+/**
+ *  \brief Checks a forced link against the partner without disturbing it.
+ *
+ *  With auto-negotiation off the special control/status register only
+ *  reflects the forced setting and ANLPAR stays 0, so neither tells
+ *  anything about the partner. A partner that does not run the forced
+ *  mode shows up as symbol errors instead, counted since the link came
+ *  up. 10BASE-T links count none and always pass.
+ *
+ *  \return true if the link looks sound.
+ */
+static bool Ethernet_verifyForcedLink(Lan8720_Ctx *ctx)
+{
+    uint16_t cnt = ctx->link.symErrBase;
+    uint16_t delta;
+
+    Lan8720_readReg(ctx->hPhy, LAN8720_SYMBOL_ERROR_COUNTER, &cnt);
+    delta = (uint16_t)(cnt - ctx->link.symErrBase);
+    if (delta > ETHERNET_CFG_LINK_VERIFY_SYM_ERRS)
+    {
+        printf("Forced link saw %u symbol errors\n", (unsigned)delta);
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ *  \brief Moves the link bring-up of a port to a new state.
+ */
+static void Ethernet_setLinkState(Lan8720_Ctx *ctx, Ethernet_LinkState state)
+{
+    ctx->link.state = state;
+    ctx->link.stateStartUs = TimerP_getTimeInUsecs();
+}
+
+/**
+ *  \brief Moves the port bring-up to a new state and records the time the
+ *  previous state was left and the new one entered.
+ */
+static void Ethernet_setInitState(Lan8720_Ctx *ctx, Ethernet_InitState state)
+{
+    uint32_t now = Ethernet_bootTimeUs(ctx);
+
+    if (ctx->init.entryUs[ctx->init.state] != 0U)
+    {
+        ctx->init.exitUs[ctx->init.state] = now;
+    }
+    ctx->init.state = state;
+    ctx->init.entryUs[state] = now;
+    ctx->initStateUs = TimerP_getTimeInUsecs();
+}
+
+/**
+ *  \brief Tells whether the port bring-up waits on a timeout rather than
+ *  on a PHY event.
+ */
+static bool Ethernet_linkPending(Lan8720_Ctx *ctx)
+{
+    if (ctx->init.state == ETHERNET_INIT_FAILED)
+    {
+        return false;
+    }
+    return (ctx->init.state < ETHERNET_INIT_AUTONEG) ||
+           (ctx->link.state == ETHERNET_LINK_FORCED) ||
+           (ctx->link.state == ETHERNET_LINK_VERIFY);
+}
+
+/**
+ *  \brief Advances the link bring-up of a port.
+ *
+ *  A forced link that does not come up in time falls back to
+ *  auto-negotiation. Once a forced link has run for a while, it is
+ *  re-checked: from its symbol errors, and if those point at a partner
+ *  that does not match the cache the link is auto-negotiated after all;
+ *  or with auto-negotiation if ETHERNET_CFG_LINK_RECHECK_ANEG is set. A
+ *  changed partner is reported. Called from the device task on PHY
+ *  events and, while a forced link is pending, at most every
+ *  ETHERNET_LINK_TICK_MS.
+ *
+ *  \return 1 if the link is up, 0 otherwise.
+ */
+static uint8_t Ethernet_linkTick(Lan8720_Ctx *ctx)
+{
+    Ethernet_Link *link = &ctx->link;
+    Ethernet_LinkParams params;
+    uint64_t now = TimerP_getTimeInUsecs();
+    uint64_t elapsedMs;
+    uint8_t wasUp;
+
+    if (Ethernet_linkPending(ctx) && (link->lastTickUs != 0U) &&
+        ((now - link->lastTickUs) < (ETHERNET_LINK_TICK_MS * 1000U)))
+    {
+        return link->linkUp;
+    }
+    link->lastTickUs = now;
+    wasUp = link->linkUp;
+    link->linkUp = Ethernet_getStatus(ctx);
+
+    if (link->linkUp && (ctx->init.state == ETHERNET_INIT_AUTONEG))
+    {
+        Ethernet_setInitState(ctx, ETHERNET_INIT_LINK_UP);
+    }
+    if (link->linkUp && (ctx->bootStats.linkUpUs == 0U))
+    {
+        ctx->bootStats.linkUpUs = Ethernet_bootTimeUs(ctx);
+        printf("Link up %u us after init (%s)\n", (unsigned)ctx->bootStats.linkUpUs,
+               (link->state == ETHERNET_LINK_FORCED) ? "forced" : "auto-negotiated");
+    }
+
+    elapsedMs = (now - link->stateStartUs) / 1000U;
+    switch (link->state)
+    {
+        case ETHERNET_LINK_FORCED:
+            if (link->linkUp)
+            {
+#if (ETHERNET_CFG_LINK_RECHECK_ANEG == 0)
+                Lan8720_readReg(ctx->hPhy, LAN8720_SYMBOL_ERROR_COUNTER, &link->symErrBase);
+#endif
+                Ethernet_setLinkState(ctx, ETHERNET_LINK_VERIFY);
+            }
+            else if (elapsedMs >= ETHERNET_CFG_FAST_LINK_TIMEOUT_MS)
+            {
+                printf("Forced link not up, falling back to auto-negotiation\n");
+                ctx->bootStats.fallback = true;
+                Ethernet_startAutoNeg(ctx->hPhy);
+                Ethernet_setLinkState(ctx, ETHERNET_LINK_ANEG);
+            }
+            break;
+
+        case ETHERNET_LINK_VERIFY:
+            if (elapsedMs >= ETHERNET_CFG_LINK_RECHECK_MS)
+            {
+#if (ETHERNET_CFG_LINK_RECHECK_ANEG == 1)
+                Ethernet_startAutoNeg(ctx->hPhy);
+                Ethernet_setLinkState(ctx, ETHERNET_LINK_RECHECK);
+                link->linkUp = 0U;
+#else
+                if (!link->linkUp)
+                {
+                    /* Lost meanwhile, nothing left to keep up */
+                    Ethernet_startAutoNeg(ctx->hPhy);
+                    Ethernet_setLinkState(ctx, ETHERNET_LINK_ANEG);
+                    break;
+                }
+                if (!Ethernet_verifyForcedLink(ctx))
+                {
+                    printf("Link partner changed since the link parameters were cached\n");
+                    ctx->bootStats.partnerChanged = true;
+                    Ethernet_startAutoNeg(ctx->hPhy);
+                    Ethernet_setLinkState(ctx, ETHERNET_LINK_ANEG);
+                    link->linkUp = 0U;
+                    break;
+                }
+                Ethernet_setLinkState(ctx, ETHERNET_LINK_DONE);
+#endif
+            }
+            break;
+
+        case ETHERNET_LINK_ANEG:
+        case ETHERNET_LINK_RECHECK:
+            if (Ethernet_getLinkParams(ctx, &params) == 0)
+            {
+                if ((link->state == ETHERNET_LINK_RECHECK) &&
+                    ((params.partnerAbility != link->cached.partnerAbility) ||
+                     (params.speedIndi != link->cached.speedIndi)))
+                {
+                    printf("Link partner changed since the link parameters were cached\n");
+                    ctx->bootStats.partnerChanged = true;
+                }
+                Ethernet_setLinkState(ctx, ETHERNET_LINK_DONE);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (link->linkUp != wasUp)
+    {
+        Ethernet_setTxRate(ctx, link->linkUp);
+    }
+    return link->linkUp;
+}
+
+/**
+ *  \brief Returns the time since the port was initialized, never 0 so
+ *  that 0 can mark events that did not happen.
+ */
+static uint32_t Ethernet_bootTimeUs(Lan8720_Ctx *ctx)
+{
+    uint32_t elapsed = (uint32_t)(TimerP_getTimeInUsecs() - ctx->initUs);
+
+    return (elapsed == 0U) ? 1U : elapsed;
+}
+
+#if (LAN8720_CFG_LATENCY_HIST == 1)
+/**
+ *  \brief Starts the timestamp source of the latency histograms.
+ */
+static void Ethernet_latInit(void)
+{
+    if (ethLatInitDone)
+    {
+        return;
+    }
+#if defined(__ARM_ARCH_7R__)
+    /* Cycle counter without divider, readable from user mode */
+    CSL_armR5PmuCfg(0U, 0U, 1U);
+    CSL_armR5PmuEnableCntr(CSL_ARM_R5_PMU_CYCLE_COUNTER_NUM, 1U);
+    CSL_armR5PmuEnableAllCntrs(1U);
+#endif
+    ethLatInitDone = true;
+}
+
+/**
+ *  \brief Reads the timestamp source: the PMU cycle counter on the R5F,
+ *  the monotonic clock in nanoseconds elsewhere.
+ */
+static inline uint32_t Ethernet_latNow(void)
+{
+#if defined(__ARM_ARCH_7R__)
+    return CSL_armR5PmuReadCntr(CSL_ARM_R5_PMU_CYCLE_COUNTER_NUM);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+/**
+ *  \brief Adds a latency sample to the histogram of an operation.
+ */
+static void Ethernet_latRecord(Ethernet_LatOp op, uint32_t ticks)
+{
+    Ethernet_LatHist *hist = &ethLatHist[op];
+    uint32_t b = (ticks == 0U) ? 0U : (32U - (uint32_t)__builtin_clz(ticks));
+
+    if (b >= ETHERNET_LAT_BUCKET_NUM)
+    {
+        b = ETHERNET_LAT_BUCKET_NUM - 1U;
+    }
+    if ((hist->count == 0U) || (ticks < hist->min))
+    {
+        hist->min = ticks;
+    }
+    if (ticks > hist->max)
+    {
+        hist->max = ticks;
+    }
+    hist->count++;
+    hist->sum += ticks;
+    hist->bucket[b]++;
+}
+#endif
+
+#if (ETHERNET_TRACE_ENABLED == 1)
+/**
+ *  \brief Appends a record to the binary trace ring.
+ *
+ *  Safe from any task or core: the slot is reserved atomically, and a
+ *  reader may at worst see the record being overwritten as the ring wraps.
+ */
+static inline void Ethernet_trace(Lan8720_Ctx *ctx, uint32_t event, uint32_t len,
+                                  int32_t status, uint32_t arg)
+{
+    uint32_t idx = __atomic_fetch_add(&gEthernetTrace.head, 1U, __ATOMIC_RELAXED);
+    Ethernet_TraceRec *rec = &gEthernetTrace.rec[idx & (ETHERNET_CFG_TRACE_SIZE - 1U)];
+
+    rec->timeUs = (uint32_t)TimerP_getTimeInUsecs();
+    rec->event  = (uint16_t)event;
+    rec->port   = (uint8_t)ctx->macPort;
+    rec->status = (int8_t)status;
+    rec->len    = len;
+    rec->arg    = arg;
+}
+#endif
+
+/**
+ *  \brief Gathers a list of fragments into one DMA packet and queues it
+ *  for transmission.
+ *
+ *  The fragments are gathered directly into the DMA packet buffer, so each
+ *  byte of the frame is copied exactly once, and only after an entry of
+ *  the pacing queue was reserved for it. Frames longer than
+ *  ENET_TX_PKT_SIZE are truncated.
+ */
+static int Ethernet_sendFrags(Lan8720_Ctx *ctx, const Ethernet_TxFrag *frags, uint32_t numFrags,
+                             Ethernet_TxPrio prio)
+{
+    Ethernet_PerfStats *perf;
+    EnetDma_PktQ txQueue;
+    EnetDma_Pkt *pTxPkt;
+    size_t len = 0U;
+    size_t fragLen;
+    bool truncated = false;
+    uint32_t i;
+
+    if ((frags == NULL) || (numFrags == 0U) || (numFrags > ETHERNET_TX_FRAG_MAX) ||
+        ((uint32_t)prio >= ETHERNET_TX_PRIO_NUM))
+    {
+        return -1;
+    }
+
+    if (Ethernet_paceReserve(ctx, prio, 1U) == 0U)
+    {
+        return -1;
+    }
+    pTxPkt = Ethernet_allocTxPkt(ctx);
+    if (pTxPkt == NULL)
+    {
+        ETHERNET_TRACE_WARN(ctx, ETHERNET_TRACE_TX_ALLOC_FAIL, 0U, -1, 0U);
+        EnetQueue_initQ(&txQueue);
+        (void)Ethernet_paceTxPktQ(ctx, &txQueue, 0U, prio, 1U);
+        return -1;
+    }
+
+    for (i = 0U; i < numFrags; i++)
+    {
+        fragLen = frags[i].len;
+        if (fragLen > (ENET_TX_PKT_SIZE - len))
+        {
+            fragLen = ENET_TX_PKT_SIZE - len;
+            truncated = true;
+        }
+        memcpy(&pTxPkt->bufPtr[len], frags[i].buf, fragLen);
+        len += fragLen;
+    }
+    perf = Ethernet_perfStats(ctx);
+    if (truncated)
+    {
+        perf->txTruncated++;
+    }
+
+    if (Ethernet_submitTxPkt(ctx, pTxPkt, len, prio, 1U) != 0)
+    {
+        return -1;
+    }
+    perf->txBytesCopied += len;
+    return 0;
+}
+
+/**
+ *  \brief Queues a single filled DMA packet for transmission.
+ *
+ *  \param reserved 1 if a pacing queue entry was reserved for the packet.
+ */
+static int Ethernet_submitTxPkt(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt, size_t len,
+                                Ethernet_TxPrio prio, uint32_t reserved)
+{
+    EnetDma_PktQ txQueue;
+
+    pTxPkt->userBufLen = (uint32_t)len;
+    Ethernet_txPktPool(ctx, pTxPkt)->sentUs[ETHERNET_TX_PKT_IDX(pTxPkt)] =
+        (uint32_t)TimerP_getTimeInUsecs();
+    EnetQueue_initQ(&txQueue);
+    EnetQueue_enq(&txQueue, &pTxPkt->node);
+    return (Ethernet_paceTxPktQ(ctx, &txQueue, (uint32_t)len, prio, reserved) == 1U) ? 0 : -1;
+}
+
+/**
+ *  \brief Submits a queue of filled DMA packets for transmission.
+ *
+ *  Must be called with the TX lock held, so that the in-flight count the
+ *  pacing decisions are based on is only updated together with the
+ *  submission, and frames reach the DMA in the order they were dequeued.
+ *  On failure the packets are returned to their pools.
+ */
+static int Ethernet_submitTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue, uint32_t bytes)
+{
+    Ethernet_PerfStats *perf = Ethernet_perfStats(ctx);
+    EnetDma_Pkt *pTxPkt;
+    uint32_t count = EnetQueue_getQCount(txQueue);
+    int32_t status;
+
+    status = EnetDma_submitTxPktQ(ctx->hEnet, ctx->macPort, txQueue);
+    if (status != ENET_SOK)
+    {
+        pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+        while (pTxPkt != NULL)
+        {
+            Ethernet_poolPut(Ethernet_txPktPool(ctx, pTxPkt), pTxPkt);
+            pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+        }
+        perf->txDrops += count;
+        return -1;
+    }
+    if (ctx->bootStats.firstTxUs == 0U)
+    {
+        /* Reported by Ethernet_reportFirstTx() once out of the lock */
+        ctx->bootStats.firstTxUs = Ethernet_bootTimeUs(ctx);
+    }
+    perf->txFrames += count;
+    perf->txBytes += bytes;
+    ctx->txReclaim.inFlight += count;
+    if (ctx->txReclaim.inFlight > ctx->txReclaim.maxInFlight)
+    {
+        ctx->txReclaim.maxInFlight = ctx->txReclaim.inFlight;
+    }
+    return 0;
+}
+
+/**
+ *  \brief Logs the boot time of the first frame sent, if the submission
+ *  that just completed was it.
+ *
+ *  \param wasFirst No frame had been sent before that submission.
+ */
+static void Ethernet_reportFirstTx(Lan8720_Ctx *ctx, bool wasFirst)
+{
+    if (wasFirst && (ctx->bootStats.firstTxUs != 0U))
+    {
+        printf("First frame sent %u us after init\n", (unsigned)ctx->bootStats.firstTxUs);
+    }
+}
+
+/**
+ *  \brief Reserves entries of a pacing queue for frames about to be
+ *  copied, so that a frame the queue cannot take is never copied.
+ *
+ *  While frames go straight to the DMA every frame can be taken. A
+ *  reservation is given back by Ethernet_paceTxPktQ(), which always takes
+ *  the reserved frames, even if the link became paced in between and the
+ *  queue goes over ETHERNET_CFG_TX_PACE_QUEUE_LEN for a moment.
+ *
+ *  \return Number of frames reserved, at most \c count.
+ */
+static uint32_t Ethernet_paceReserve(Lan8720_Ctx *ctx, Ethernet_TxPrio prio, uint32_t count)
+{
+    Ethernet_TxPace *pace = &ctx->txPace;
+    uint32_t room = count;
+    uint32_t used;
+    uintptr_t key;
+
+    key = Ethernet_txLock(ctx);
+    if ((pace->rateBpms != 0U) || Ethernet_txBacklog(ctx))
+    {
+        used = EnetQueue_getQCount(&pace->queue[prio]) + pace->reserved[prio];
+        room = (used < ETHERNET_CFG_TX_PACE_QUEUE_LEN) ? (ETHERNET_CFG_TX_PACE_QUEUE_LEN - used) : 0U;
+        if (room > count)
+        {
+            room = count;
+        }
+        /* Refused frames count as dropped, as they did when copied first */
+        pace->stats.drops[prio] += count - room;
+    }
+    pace->reserved[prio] += room;
+    Ethernet_txUnlock(ctx, key);
+
+    if (room < count)
+    {
+        Ethernet_perfStats(ctx)->txDrops += count - room;
+    }
+    return room;
+}
+
+/**
+ *  \brief Hands a queue of filled DMA packets to the TX pacing layer.
+ *
+ *  While the link is unpaced and nothing is waiting, the packets are
+ *  submitted directly, within the same critical section as the check so
+ *  that no paced frame can overtake them. Otherwise they are appended to
+ *  the queue of their priority, the ones beyond
+ *  ETHERNET_CFG_TX_PACE_QUEUE_LEN are dropped, and as many queued frames
+ *  as the pacing allows are released. The first \c reserved entries were
+ *  reserved with Ethernet_paceReserve() and are never dropped; the whole
+ *  reservation is given back, also when fewer packets are passed.
+ *
+ *  \return Number of packets accepted, counted from the head of the queue.
+ */
+static uint32_t Ethernet_paceTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue, uint32_t bytes,
+                                    Ethernet_TxPrio prio, uint32_t reserved)
+{
+    Ethernet_TxPace *pace = &ctx->txPace;
+    EnetDma_PktQ *paceQueue = &pace->queue[prio];
+    EnetDma_PktQ dropQueue;
+    EnetDma_Pkt *pTxPkt;
+    uint32_t count = EnetQueue_getQCount(txQueue);
+    uint32_t dropped;
+    uint32_t queued;
+    uintptr_t key;
+    int status = 0;
+    bool direct;
+    bool first;
+
+    EnetQueue_initQ(&dropQueue);
+    key = Ethernet_txLock(ctx);
+    pace->reserved[prio] -= reserved;
+    if (count == 0U)
+    {
+        Ethernet_txUnlock(ctx, key);
+        return 0U;
+    }
+    first = (ctx->bootStats.firstTxUs == 0U);
+    direct = (pace->rateBpms == 0U) && !Ethernet_txBacklog(ctx);
+    if (direct)
+    {
+        status = Ethernet_submitTxPktQ(ctx, txQueue, bytes);
+    }
+    else
+    {
+        queued = EnetQueue_getQCount(paceQueue);
+        pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+        while (pTxPkt != NULL)
+        {
+            if ((reserved > 0U) || (queued < ETHERNET_CFG_TX_PACE_QUEUE_LEN))
+            {
+                EnetQueue_enq(paceQueue, &pTxPkt->node);
+                reserved -= (reserved > 0U) ? 1U : 0U;
+                queued++;
+            }
+            else
+            {
+                EnetQueue_enq(&dropQueue, &pTxPkt->node);
+            }
+            pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+        }
+        if (queued > pace->stats.maxQueued[prio])
+        {
+            pace->stats.maxQueued[prio] = queued;
+        }
+    }
+    Ethernet_txUnlock(ctx, key);
+
+    if (direct)
+    {
+        Ethernet_reportFirstTx(ctx, first);
+        return (status == 0) ? count : 0U;
+    }
+
+    dropped = EnetQueue_getQCount(&dropQueue);
+    if (dropped > 0U)
+    {
+        pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(&dropQueue);
+        while (pTxPkt != NULL)
+        {
+            Ethernet_freeTxPkt(ctx, pTxPkt);
+            pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(&dropQueue);
+        }
+        pace->stats.drops[prio] += dropped;
+        Ethernet_perfStats(ctx)->txDrops += dropped;
+    }
+
+    Ethernet_paceTx(ctx);
+    return count - dropped;
+}
+
+/**
+ *  \brief Releases queued TX frames to the DMA, highest priority first.
+ *
+ *  Stops once ETHERNET_CFG_TX_PACE_HW_DEPTH frames are in flight or the
+ *  token bucket cannot pay for the next frame. The frames then wait for a
+ *  TX completion or for the bucket to refill on the next device task tick.
+ *  With the link down every queued frame is released. The frames are
+ *  submitted before the TX lock is dropped, so a concurrent caller can
+ *  neither reorder them nor see an in-flight count that leaves them out.
+ */
+static void Ethernet_paceTx(Lan8720_Ctx *ctx)
+{
+    Ethernet_TxPace *pace = &ctx->txPace;
+    EnetDma_PktQ txQueue;
+    EnetDma_PktQ *paceQueue;
+    EnetDma_Pkt *pTxPkt;
+    uint64_t now = TimerP_getTimeInUsecs();
+    uint64_t cost;
+    uint32_t inFlight;
+    uint32_t bytes = 0U;
+    uint32_t len;
+    uint32_t i;
+    uintptr_t key;
+    bool stop = false;
+    bool first;
+
+    EnetQueue_initQ(&txQueue);
+    key = Ethernet_txLock(ctx);
+    first = (ctx->bootStats.firstTxUs == 0U);
+    if (pace->rateBpms != 0U)
+    {
+        pace->tokens += (now - pace->lastUs) * pace->rateBpms;
+        if (pace->tokens > pace->depth)
+        {
+            pace->tokens = pace->depth;
+        }
+    }
+    pace->lastUs = now;
+
+    inFlight = ctx->txReclaim.inFlight;
+    for (i = 0U; (i < ETHERNET_TX_PRIO_NUM) && !stop; i++)
+    {
+        paceQueue = &pace->queue[ETHERNET_TX_PRIO_NUM - 1U - i];
+        pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(paceQueue);
+        while (pTxPkt != NULL)
+        {
+            len = pTxPkt->userBufLen;
+            if (pace->rateBpms != 0U)
+            {
+                cost = (uint64_t)((len < ETHERNET_TX_MIN_FRAME_LEN) ? ETHERNET_TX_MIN_FRAME_LEN : len);
+                cost = (cost + ETHERNET_TX_WIRE_OVERHEAD) * 1000U;
+                if ((inFlight + EnetQueue_getQCount(&txQueue)) >= ETHERNET_CFG_TX_PACE_HW_DEPTH)
+                {
+                    pace->stats.hwFull++;
+                    stop = true;
+                }
+                else if (cost > pace->tokens)
+                {
+                    pace->stats.throttled++;
+                    stop = true;
+                }
+                if (stop)
+                {
+                    EnetQueue_enqHead(paceQueue, &pTxPkt->node);
+                    break;
+                }
+                pace->tokens -= cost;
+            }
+            EnetQueue_enq(&txQueue, &pTxPkt->node);
+            bytes += len;
+            pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(paceQueue);
+        }
+    }
+    if (EnetQueue_getQCount(&txQueue) > 0U)
+    {
+        (void)Ethernet_submitTxPktQ(ctx, &txQueue, bytes);
+    }
+    Ethernet_txUnlock(ctx, key);
+
+    Ethernet_reportFirstTx(ctx, first);
+}
+
+/**
+ *  \brief Sizes the TX token bucket from the resolved speed and duplex.
+ *
+ *  Called on every link transition. On link up the rate is read from the
+ *  special control/status register and the bucket starts full; on link
+ *  down pacing stops and the queued frames are released.
+ */
+static void Ethernet_setTxRate(Lan8720_Ctx *ctx, uint8_t linkUp)
+{
+    Ethernet_TxPace *pace = &ctx->txPace;
+    uint16_t scs = 0U;
+    uint32_t rate = 0U;
+    uint64_t depth;
+    uintptr_t key;
+
+    if (linkUp)
+    {
+        Lan8720_readReg(ctx->hPhy, LAN8720_SPECIAL_CTRL_STATUS, &scs);
+        rate = ((scs & PHY_SCS_SPEED_100) != 0U) ? ETHERNET_TX_RATE_100M : ETHERNET_TX_RATE_10M;
+        if ((scs & PHY_SCS_FULL_DUPLEX) == 0U)
+        {
+            rate = (rate * ETHERNET_TX_HALF_DUPLEX_PCT) / 100U;
+        }
+    }
+
+    /* The bucket must always be able to pay for a full-size frame */
+    depth = (uint64_t)rate * ETHERNET_CFG_TX_PACE_BURST_US;
+    if (depth < ((ENET_TX_PKT_SIZE + ETHERNET_TX_WIRE_OVERHEAD) * 1000U))
+    {
+        depth = (ENET_TX_PKT_SIZE + ETHERNET_TX_WIRE_OVERHEAD) * 1000U;
+    }
+
+    key = Ethernet_txLock(ctx);
+    pace->rateBpms = rate;
+    pace->depth = depth;
+    pace->tokens = depth;
+    pace->lastUs = TimerP_getTimeInUsecs();
+    pace->stats.rateKbps = rate * 8U;
+    Ethernet_txUnlock(ctx, key);
+
+    if (rate != 0U)
+    {
+        printf("TX paced at %u kbit/s\n", (unsigned)(rate * 8U));
+    }
+    Ethernet_paceTx(ctx);
+}
+
+/**
+ *  \brief Tells whether frames are waiting in the TX pacing queues.
+ */
+static bool Ethernet_txBacklog(Lan8720_Ctx *ctx)
+{
+    return (EnetQueue_getQCount(&ctx->txPace.queue[ETHERNET_TX_PRIO_NORMAL]) +
+            EnetQueue_getQCount(&ctx->txPace.queue[ETHERNET_TX_PRIO_HIGH])) > 0U;
+}
+
+/**
+ *  \brief Tops up the pending RX queue from the DMA.
+ *
+ *  Also recycles any released loaned packets first, so that the hardware
+ *  never runs short of free buffers while the application holds loans.
+ *  Must be called with the RX lock held.
+ */
+static void Ethernet_fillRxPendQ(Lan8720_Ctx *ctx, uint32_t wanted)
+{
+    EnetDma_PktQ rxQueue;
+
+    Ethernet_submitRxReleaseQ(ctx);
+    if (EnetQueue_getQCount(&ctx->rxPendQueue) < wanted)
+    {
+        EnetQueue_initQ(&rxQueue);
+        EnetDma_retrieveRxPktQ(ctx->hEnet, ctx->macPort, &rxQueue);
+        if ((ctx->bootStats.firstRxUs == 0U) && (EnetQueue_getQCount(&rxQueue) > 0U))
+        {
+            ctx->bootStats.firstRxUs = Ethernet_bootTimeUs(ctx);
+            printf("First frame received %u us after init\n", (unsigned)ctx->bootStats.firstRxUs);
+        }
+        EnetQueue_append(&ctx->rxPendQueue, &rxQueue);
+    }
+}
+
+/**
+ *  \brief Takes up to maxPkts pending RX packets for the application,
+ *  topping up the pending queue from the DMA first.
+ */
+static void Ethernet_takeRxPendQ(Lan8720_Ctx *ctx, EnetDma_PktQ *rxQueue, uint32_t maxPkts)
+{
+    EnetDma_Pkt *pRxPkt;
+    uintptr_t key;
+
+    EnetQueue_initQ(rxQueue);
+    key = Ethernet_rxLock(ctx);
+    Ethernet_fillRxPendQ(ctx, maxPkts);
+    while (EnetQueue_getQCount(rxQueue) < maxPkts)
+    {
+        pRxPkt = (EnetDma_Pkt *)EnetQueue_deq(&ctx->rxPendQueue);
+        if (pRxPkt == NULL)
+        {
+            break;
+        }
+        EnetQueue_enq(rxQueue, &pRxPkt->node);
+    }
+    Ethernet_rxUnlock(ctx, key);
+}
+
+/**
+ *  \brief Returns released loaned packets to the DMA RX free queue.
+ *
+ *  Called by the device task as well as by the application, so the
+ *  submission and the reset of the queue are made under the RX lock: a
+ *  packet released in between would otherwise be lost to the DMA.
+ */
+static void Ethernet_refillRxFreeQ(Lan8720_Ctx *ctx)
+{
+    uintptr_t key;
+
+    key = Ethernet_rxLock(ctx);
+    Ethernet_submitRxReleaseQ(ctx);
+    Ethernet_rxUnlock(ctx, key);
+}
+
+/**
+ *  \brief Submits the released RX packets to the DMA. Must be called with
+ *  the RX lock held.
+ */
+static void Ethernet_submitRxReleaseQ(Lan8720_Ctx *ctx)
+{
+    if (EnetQueue_getQCount(&ctx->rxReleaseQueue) > 0U)
+    {
+        EnetDma_submitRxPktQ(ctx->hEnet, ctx->macPort, &ctx->rxReleaseQueue);
+        EnetQueue_initQ(&ctx->rxReleaseQueue);
+    }
+}
+
+/**
+ *  \brief Returns the packet pool index of the calling core.
+ */
+static uint32_t Ethernet_coreIdx(void)
+{
+    return EnetSoc_getCoreId() % ETHERNET_CFG_POOL_CORE_NUM;
+}
+
+/**
+ *  \brief Takes the TX lock of a port.
+ *
+ *  Masking interrupts only keeps out the tasks and interrupts of the
+ *  calling core, while senders, frees and reclaims of the other cores
+ *  touch the same pools, pacing queues and DMA channel. Those are kept out
+ *  by a spinlock in the port context, which lives in memory shared by the
+ *  cores like the channel rings. Not recursive.
+ *
+ *  \return Key to pass to Ethernet_txUnlock().
+ */
+static inline uintptr_t Ethernet_txLock(Lan8720_Ctx *ctx)
+{
+    uintptr_t key = EnetOsal_disableAllIntr();
+
+    while (__atomic_test_and_set(&ctx->txLock, __ATOMIC_ACQUIRE))
+    {
+        /* Held by another core for a few DMA queue operations at most */
+    }
+    return key;
+}
+
+/**
+ *  \brief Releases the TX lock of a port.
+ */
+static inline void Ethernet_txUnlock(Lan8720_Ctx *ctx, uintptr_t key)
+{
+    __atomic_clear(&ctx->txLock, __ATOMIC_RELEASE);
+    EnetOsal_restoreAllIntr(key);
+}
+
+/**
+ *  \brief Takes the RX lock of a port.
+ *
+ *  Guards the queues of pending and released RX packets and the
+ *  submissions to the DMA RX free queue, which the application and the
+ *  device task both make. Built like Ethernet_txLock(). Not recursive.
+ *
+ *  \return Key to pass to Ethernet_rxUnlock().
+ */
+static inline uintptr_t Ethernet_rxLock(Lan8720_Ctx *ctx)
+{
+    uintptr_t key = EnetOsal_disableAllIntr();
+
+    while (__atomic_test_and_set(&ctx->rxLock, __ATOMIC_ACQUIRE))
+    {
+        /* Held by another core for one DMA queue operation at most */
+    }
+    return key;
+}
+
+/**
+ *  \brief Releases the RX lock of a port.
+ */
+static inline void Ethernet_rxUnlock(Lan8720_Ctx *ctx, uintptr_t key)
+{
+    __atomic_clear(&ctx->rxLock, __ATOMIC_RELEASE);
+    EnetOsal_restoreAllIntr(key);
+}
+
+/**
+ *  \brief Returns the data path counters of the calling core.
+ */
+static inline Ethernet_PerfStats *Ethernet_perfStats(Lan8720_Ctx *ctx)
+{
+    return &ctx->coreStats[Ethernet_coreIdx()].perf;
+}
+
+/**
+ *  \brief Samples the PHY symbol error counter once per sampling period
+ *  and turns it into a rate.
+ */
+static void Ethernet_sampleStats(Lan8720_Ctx *ctx)
+{
+    Ethernet_SymErr *symErr = &ctx->symErr;
+    uint64_t now = TimerP_getTimeInUsecs();
+    uint16_t cnt = 0U;
+
+    if ((ctx->init.state != ETHERNET_INIT_AUTONEG) && (ctx->init.state != ETHERNET_INIT_LINK_UP))
+    {
+        return;
+    }
+    if (symErr->pending || ((now - symErr->sampleUs) < (ETHERNET_CFG_STATS_SAMPLE_MS * 1000U)))
+    {
+        return;
+    }
+
+    /* Off the device task when the asynchronous MDIO queue is open */
+    symErr->pending = true;
+    if (Lan8720_postMdio(ctx->phyCfg.phyAddr, LAN8720_MDIO_OP_READ, LAN8720_SYMBOL_ERROR_COUNTER,
+                         0U, 0U, Ethernet_symErrDone, ctx) == ENETPHY_SOK)
+    {
+        return;
+    }
+    symErr->pending = false;
+
+    if (Lan8720_readReg(ctx->hPhy, LAN8720_SYMBOL_ERROR_COUNTER, &cnt) == ENETPHY_SOK)
+    {
+        Ethernet_updateSymErr(symErr, cnt);
+    }
+    symErr->sampleUs = now;
+}
+
+/**
+ *  \brief Accounts a new reading of the symbol error counter.
+ */
+static void Ethernet_updateSymErr(Ethernet_SymErr *symErr, uint16_t cnt)
+{
+    uint64_t now = TimerP_getTimeInUsecs();
+    uint16_t delta = (uint16_t)(cnt - symErr->last);
+
+    symErr->last = cnt;
+    symErr->total += delta;
+    if (now > symErr->sampleUs)
+    {
+        symErr->rate = (uint32_t)(((uint64_t)delta * 1000000U) / (now - symErr->sampleUs));
+    }
+}
+
+/**
+ *  \brief Completion of an asynchronous symbol error counter read.
+ */
+static void Ethernet_symErrDone(void *cbArg, int32_t status, uint16_t val)
+{
+    Ethernet_SymErr *symErr = &((Lan8720_Ctx *)cbArg)->symErr;
+
+    if (status == ENETPHY_SOK)
+    {
+        Ethernet_updateSymErr(symErr, val);
+    }
+    symErr->sampleUs = TimerP_getTimeInUsecs();
+    symErr->pending = false;
+}
+
+/**
+ *  \brief Carves the TX and RX packet pools.
+ *
+ *  This is the only place where DMA packets are taken from the OSAL heap.
+ *  Every core gets its own TX pool; the RX packets are handed to the DMA
+ *  RX free queue straight away and circulate between it and the
+ *  application from then on.
+ */
+static void Ethernet_initPools(Lan8720_Ctx *ctx)
+{
+    Ethernet_PktPool *pool;
+    EnetDma_PktQ rxFreeQueue;
+    EnetDma_Pkt *pPkt;
+    uint32_t core, i;
+
+    for (core = 0U; core < ETHERNET_CFG_POOL_CORE_NUM; core++)
+    {
+        pool = &ctx->txPool[core];
+        memset(pool, 0, sizeof(*pool));
+        pool->lowWm = ETHERNET_POOL_LOW_WM_DEFAULT;
+        pool->highWm = ETHERNET_POOL_HIGH_WM_DEFAULT;
+        for (i = 0U; i < ETHERNET_CFG_TX_POOL_SIZE; i++)
+        {
+            pPkt = EnetDma_allocPkt(ctx->hEnet, ENET_DMA_DIR_TX);
+            if (pPkt == NULL)
+            {
+                break;
+            }
+            pPkt->appPriv = ETHERNET_TX_PKT_TAG(core, i);
+            pool->ring[i] = pPkt;
+        }
+        pool->head = i;
+        pool->stats.size = i;
+        pool->stats.minFree = i;
+    }
+
+    EnetQueue_initQ(&rxFreeQueue);
+    for (i = 0U; i < ETHERNET_CFG_RX_POOL_SIZE; i++)
+    {
+        pPkt = EnetDma_allocPkt(ctx->hEnet, ENET_DMA_DIR_RX);
+        if (pPkt == NULL)
+        {
+            break;
+        }
+        EnetQueue_enq(&rxFreeQueue, &pPkt->node);
+    }
+    EnetDma_submitRxPktQ(ctx->hEnet, ctx->macPort, &rxFreeQueue);
+}
+
+/**
+ *  \brief Gives back the TX packets and semaphores of a port whose
+ *  bring-up failed and frees its context.
+ *
+ *  Nothing was sent yet, so every TX packet is in its pool. The RX buffers
+ *  were handed to the DMA and stay in its free queue.
+ */
+static void Ethernet_releaseCtx(Lan8720_Ctx *ctx)
+{
+    Ethernet_PktPool *pool;
+    uintptr_t key;
+    uint32_t core, i;
+
+    for (core = 0U; core < ETHERNET_CFG_POOL_CORE_NUM; core++)
+    {
+        pool = &ctx->txPool[core];
+        for (i = pool->tail; i != pool->head; i++)
+        {
+            EnetDma_freePkt(ctx->hEnet, pool->ring[i & (ETHERNET_CFG_TX_POOL_SIZE - 1U)]);
+        }
+        pool->head = pool->tail;
+    }
+    for (i = 0U; i < ctx->numChans; i++)
+    {
+        if (ctx->chan[i].rxRing.sem != NULL)
+        {
+            SemaphoreP_delete(ctx->chan[i].rxRing.sem);
+        }
+    }
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    SemaphoreP_delete(ctx->eventSem);
+#endif
+    lan8720Plan[ctx->phyCfg.phyAddr].valid = false;
+
+    key = EnetOsal_disableAllIntr();
+    ctx->inUse = false;
+    EnetOsal_restoreAllIntr(key);
+}
+
+/**
+ *  \brief Takes a TX packet from the calling core's pool in constant time.
+ *
+ *  \return The packet, or NULL if the pool is empty.
+ */
+static EnetDma_Pkt *Ethernet_allocTxPkt(Lan8720_Ctx *ctx)
+{
+    Ethernet_PktPool *pool = &ctx->txPool[Ethernet_coreIdx()];
+    uint32_t tail = pool->tail;
+    uint32_t freeCnt = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE) - tail;
+    EnetDma_Pkt *pTxPkt;
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    if (freeCnt == 0U)
+    {
+        /* Only the device task retrieves completions; wake it */
+        pool->stats.allocFail++;
+        Ethernet_postEvent(ctx, ETHERNET_EVENT_TX);
+        return NULL;
+    }
+#else
+    /* Lazy reclamation once the pool runs low */
+    if (pool->belowLowWm || (freeCnt == 0U))
+    {
+        Ethernet_reclaimTx(ctx);
+        freeCnt = __atomic_load_n(&pool->head, __ATOMIC_ACQUIRE) - tail;
+    }
+
+    if (freeCnt == 0U)
+    {
+        pool->stats.allocFail++;
+        return NULL;
+    }
+#endif
+
+    pTxPkt = pool->ring[tail & (ETHERNET_CFG_TX_POOL_SIZE - 1U)];
+    __atomic_store_n(&pool->tail, tail + 1U, __ATOMIC_RELEASE);
+
+    freeCnt--;
+    if (freeCnt < pool->stats.minFree)
+    {
+        pool->stats.minFree = freeCnt;
+    }
+    if (!pool->belowLowWm && (freeCnt < pool->lowWm))
+    {
+        pool->belowLowWm = true;
+        pool->stats.lowWmCrossings++;
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+        Ethernet_postEvent(ctx, ETHERNET_EVENT_TX);
+#endif
+    }
+    return pTxPkt;
+}
+
+/**
+ *  \brief Returns the pool a TX packet was carved from.
+ */
+static inline Ethernet_PktPool *Ethernet_txPktPool(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt)
+{
+    return &ctx->txPool[ETHERNET_TX_PKT_CORE(pTxPkt)];
+}
+
+/**
+ *  \brief Puts a TX packet back on the free list of its pool in constant
+ *  time.
+ *
+ *  Must be called with the TX lock held, which makes the caller the only
+ *  writer of head whatever core it runs on.
+ */
+static void Ethernet_poolPut(Ethernet_PktPool *pool, EnetDma_Pkt *pTxPkt)
+{
+    uint32_t head = pool->head;
+    uint32_t freeCnt = head - __atomic_load_n(&pool->tail, __ATOMIC_ACQUIRE);
+
+    /* The packet is out of the pool, so its free list cannot be full */
+    assert(freeCnt < ETHERNET_CFG_TX_POOL_SIZE);
+
+    pool->ring[head & (ETHERNET_CFG_TX_POOL_SIZE - 1U)] = pTxPkt;
+    __atomic_store_n(&pool->head, head + 1U, __ATOMIC_RELEASE);
+
+    if (pool->belowLowWm && ((freeCnt + 1U) >= pool->highWm))
+    {
+        pool->belowLowWm = false;
+    }
+}
+
+/**
+ *  \brief Returns a TX packet that was never sent to its pool.
+ */
+static void Ethernet_freeTxPkt(Lan8720_Ctx *ctx, EnetDma_Pkt *pTxPkt)
+{
+    uintptr_t key;
+
+    key = Ethernet_txLock(ctx);
+    Ethernet_poolPut(Ethernet_txPktPool(ctx, pTxPkt), pTxPkt);
+    Ethernet_txUnlock(ctx, key);
+}
+
+/**
+ *  \brief Returns a queue of completed TX packets, each to its own pool,
+ *  and accounts for their submit-to-reclaim latency.
+ *
+ *  Must be called with the TX lock held.
+ *
+ *  \return Number of packets returned.
+ */
+static uint32_t Ethernet_freeTxPktQ(Lan8720_Ctx *ctx, EnetDma_PktQ *txQueue)
+{
+    Ethernet_PktPool *pool;
+    uint32_t count = 0U;
+    uint32_t now = (uint32_t)TimerP_getTimeInUsecs();
+    uint32_t lat;
+    EnetDma_Pkt *pTxPkt;
+
+    pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+    while (pTxPkt != NULL)
+    {
+        pool = Ethernet_txPktPool(ctx, pTxPkt);
+        lat = now - pool->sentUs[ETHERNET_TX_PKT_IDX(pTxPkt)];
+        ctx->txReclaim.latSumUs += lat;
+        if (lat < ctx->txReclaim.latMinUs)
+        {
+            ctx->txReclaim.latMinUs = lat;
+        }
+        if (lat > ctx->txReclaim.latMaxUs)
+        {
+            ctx->txReclaim.latMaxUs = lat;
+        }
+
+        Ethernet_poolPut(pool, pTxPkt);
+        count++;
+        pTxPkt = (EnetDma_Pkt *)EnetQueue_deq(txQueue);
+    }
+    return count;
+}
+
+/**
+ *  \brief Turns the MDIO controller preamble on or off.
+ */
+static void Ethernet_setMdioPreamble(CSL_mdioRegs *mdioRegs, bool enable)
+{
+    /* PREAMBLE set means the controller omits the preamble */
+    CSL_REG32_FINS(&mdioRegs->CONTROL_REG, MDIO_CONTROL_REG_PREAMBLE, enable ? 0U : 1U);
+}
+
+/**
+ *  \brief Sets or clears the preamble bypass bit in every open PHY.
+ */
+static void Ethernet_setPreambleBypass(bool enable)
+{
+    uint32_t i;
+
+    for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+    {
+        if (ethCtx[i].inUse && (ethCtx[i].hPhy != NULL))
+        {
+            Lan8720_rmwReg(ethCtx[i].hPhy, LAN8720_MODE_CTRL_STATUS, MODE_CTRL_STATUS_MDPREBP,
+                           enable ? MODE_CTRL_STATUS_MDPREBP : 0U);
+        }
+    }
+}
+
+/**
+ *  \brief Hands up to budget pending frames to their RX channels.
+ *
+ *  Frames are grouped per channel first so that each ring is published
+ *  once per call. A flow always lands on the same channel, which keeps it
+ *  in order. A port with a single channel has no rings: its frames are
+ *  only moved from the DMA to rxPendQueue, up to budget frames pending,
+ *  for the receive calls of the application.
+ *
+ *  \return Number of frames handed over.
+ */
+static uint32_t Ethernet_drainRx(Lan8720_Ctx *ctx, uint32_t budget)
+{
+    EnetDma_PktQ steerQueue[ETHERNET_CHAN_MAX];
+    Ethernet_PerfStats *perf;
+    EnetDma_Pkt *pRxPkt;
+    Ethernet_Chan *chan;
+    uint32_t bytes = 0U;
+    uint32_t done = 0U;
+    uint32_t depth, c;
+    uintptr_t key;
+
+    if (ctx->numChans < 2U)
+    {
+        key = Ethernet_rxLock(ctx);
+        depth = EnetQueue_getQCount(&ctx->rxPendQueue);
+        Ethernet_fillRxPendQ(ctx, budget);
+        done = EnetQueue_getQCount(&ctx->rxPendQueue) - depth;
+        Ethernet_rxUnlock(ctx, key);
+        return done;
+    }
+
+    Ethernet_recycleChanRx(ctx);
+
+    for (c = 0U; c < ctx->numChans; c++)
+    {
+        EnetQueue_initQ(&steerQueue[c]);
+    }
+    c = 0U;
+    key = Ethernet_rxLock(ctx);
+    Ethernet_fillRxPendQ(ctx, budget);
+    while (done < budget)
+    {
+        pRxPkt = (EnetDma_Pkt *)EnetQueue_deq(&ctx->rxPendQueue);
+        if (pRxPkt == NULL)
+        {
+            break;
+        }
+        c = Ethernet_flowChannel(ctx, pRxPkt->bufPtr, pRxPkt->userBufLen);
+        EnetQueue_enq(&steerQueue[c], &pRxPkt->node);
+        bytes += pRxPkt->userBufLen;
+        done++;
+    }
+    Ethernet_rxUnlock(ctx, key);
+    perf = Ethernet_perfStats(ctx);
+    perf->rxFrames += done;
+    perf->rxBytes += bytes;
+
+    for (c = 0U; c < ctx->numChans; c++)
+    {
+        if (EnetQueue_getQCount(&steerQueue[c]) == 0U)
+        {
+            continue;
+        }
+        chan = &ctx->chan[c];
+        /* Never short of room: the ring holds the whole RX pool */
+        chan->steered += Ethernet_ringPut(&chan->rxRing, &steerQueue[c]);
+        depth = Ethernet_ringCount(&chan->rxRing);
+        if (depth > chan->maxBacklog)
+        {
+            chan->maxBacklog = depth;
+        }
+    }
+    return done;
+}
+
+/**
+ *  \brief Sets up the RX channels of a port.
+ */
+static void Ethernet_initChans(Lan8720_Ctx *ctx, uint32_t numChans)
+{
+    uint32_t c;
+
+    ctx->numChans = numChans;
+    if (numChans < 2U)
+    {
+        return;
+    }
+    for (c = 0U; c < numChans; c++)
+    {
+        Ethernet_ringInit(&ctx->chan[c].rxRing, true);
+        Ethernet_ringInit(&ctx->chan[c].freeRing, false);
+    }
+}
+
+/**
+ *  \brief Collects the buffers released by the channel consumers for
+ *  recycling to the DMA RX free queue.
+ */
+static void Ethernet_recycleChanRx(Lan8720_Ctx *ctx)
+{
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    uint32_t count, c, i;
+    uintptr_t key;
+
+    for (c = 0U; c < ctx->numChans; c++)
+    {
+        do
+        {
+            count = Ethernet_ringGet(&ctx->chan[c].freeRing, pkts, ETHERNET_RX_DRAIN_BATCH);
+            key = Ethernet_rxLock(ctx);
+            for (i = 0U; i < count; i++)
+            {
+                EnetQueue_enq(&ctx->rxReleaseQueue, &pkts[i]->node);
+            }
+            Ethernet_rxUnlock(ctx, key);
+            ctx->chan[c].recycled += count;
+        }
+        while (count == ETHERNET_RX_DRAIN_BATCH);
+    }
+}
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+/**
+ *  \brief Tells whether steered buffers have not come back from the
+ *  channel consumers yet.
+ */
+static bool Ethernet_chanRxOut(Lan8720_Ctx *ctx)
+{
+    uint32_t c;
+
+    for (c = 0U; c < ctx->numChans; c++)
+    {
+        if (ctx->chan[c].steered != ctx->chan[c].recycled)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/**
+ *  \brief Resets a ring, with a wake-up semaphore if its consumer blocks.
+ */
+static void Ethernet_ringInit(Ethernet_Ring *ring, bool blocking)
+{
+    SemaphoreP_Params semPrms;
+
+    memset(ring, 0, sizeof(*ring));
+    if (blocking)
+    {
+        SemaphoreP_Params_init(&semPrms);
+        semPrms.mode = SemaphoreP_Mode_BINARY;
+        ring->sem = SemaphoreP_create(0U, &semPrms);
+    }
+}
+
+/**
+ *  \brief Producer side: moves packets from a queue into the ring.
+ *
+ *  All slots are filled before head is published with a single release
+ *  store. A sleeping consumer is woken afterwards.
+ *
+ *  \return Number of packets moved; the rest stays in pktQueue.
+ */
+static uint32_t Ethernet_ringPut(Ethernet_Ring *ring, EnetDma_PktQ *pktQueue)
+{
+    uint32_t head = ring->head;
+    uint32_t count = 0U;
+    EnetDma_Pkt *pPkt;
+
+    while (EnetQueue_getQCount(pktQueue) > 0U)
+    {
+        if ((head + count - ring->tailCache) >= ETHERNET_CFG_RX_RING_SIZE)
+        {
+            ring->tailCache = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+            if ((head + count - ring->tailCache) >= ETHERNET_CFG_RX_RING_SIZE)
+            {
+                break;
+            }
+        }
+        pPkt = (EnetDma_Pkt *)EnetQueue_deq(pktQueue);
+        ring->slot[(head + count) & (ETHERNET_CFG_RX_RING_SIZE - 1U)] = pPkt;
+        count++;
+    }
+
+    if (count > 0U)
+    {
+        __atomic_store_n(&ring->head, head + count, __ATOMIC_RELEASE);
+        if (ring->sem != NULL)
+        {
+            /* Pairs with the fence in Ethernet_ringWait() */
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&ring->waiting, __ATOMIC_RELAXED) != 0U)
+            {
+                __atomic_store_n(&ring->waiting, 0U, __ATOMIC_RELAXED);
+                SemaphoreP_post(ring->sem);
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ *  \brief Consumer side: takes up to maxPkts packets from the ring.
+ *
+ *  \return Number of packets taken.
+ */
+static uint32_t Ethernet_ringGet(Ethernet_Ring *ring, EnetDma_Pkt **pkts, uint32_t maxPkts)
+{
+    uint32_t tail = ring->tail;
+    uint32_t avail = ring->headCache - tail;
+    uint32_t i;
+
+    if (avail < maxPkts)
+    {
+        ring->headCache = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        avail = ring->headCache - tail;
+    }
+    if (avail > maxPkts)
+    {
+        avail = maxPkts;
+    }
+
+    for (i = 0U; i < avail; i++)
+    {
+        pkts[i] = ring->slot[(tail + i) & (ETHERNET_CFG_RX_RING_SIZE - 1U)];
+    }
+    if (avail > 0U)
+    {
+        __atomic_store_n(&ring->tail, tail + avail, __ATOMIC_RELEASE);
+    }
+    return avail;
+}
+
+/**
+ *  \brief Consumer side: takes packets from the ring, sleeping while it
+ *  is empty.
+ *
+ *  The consumer first yields up to ETHERNET_CFG_RX_RING_SPINS times, then
+ *  announces itself in waiting and checks the ring once more before
+ *  sleeping, so a producer publishing in between either sees the flag and
+ *  posts, or is seen by the re-check. Rings nobody sleeps on skip the
+ *  fence on the producer side.
+ *
+ *  \return Number of packets taken, at least one.
+ */
+static uint32_t Ethernet_ringWait(Ethernet_Ring *ring, EnetDma_Pkt **pkts, uint32_t maxPkts)
+{
+    uint32_t count;
+
+    uint32_t spins;
+
+    count = Ethernet_ringGet(ring, pkts, maxPkts);
+    for (spins = 0U; (count == 0U) && (spins < ETHERNET_CFG_RX_RING_SPINS); spins++)
+    {
+        TaskP_yield();
+        count = Ethernet_ringGet(ring, pkts, maxPkts);
+    }
+    while (count == 0U)
+    {
+        __atomic_store_n(&ring->waiting, 1U, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        count = Ethernet_ringGet(ring, pkts, maxPkts);
+        if (count == 0U)
+        {
+            SemaphoreP_pend(ring->sem, SemaphoreP_WAIT_FOREVER);
+            ring->wakeups++;
+            count = Ethernet_ringGet(ring, pkts, maxPkts);
+        }
+        __atomic_store_n(&ring->waiting, 0U, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+/**
+ *  \brief Returns the number of packets in the ring.
+ */
+static uint32_t Ethernet_ringCount(Ethernet_Ring *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+/**
+ *  \brief Records an event and wakes the device task.
+ *
+ *  Safe to call from interrupt context.
+ */
+static void Ethernet_postEvent(Lan8720_Ctx *ctx, uint32_t event)
+{
+    uintptr_t key;
+
+    key = EnetOsal_disableAllIntr();
+    ctx->events |= event;
+    EnetOsal_restoreAllIntr(key);
+    SemaphoreP_post(ctx->eventSem);
+}
+
+/**
+ *  \brief Blocks until at least one event is pending and consumes them all.
+ *
+ *  \return The pending events, 0 if the timeout expired first.
+ */
+static uint32_t Ethernet_waitEvents(Lan8720_Ctx *ctx, uint32_t timeout)
+{
+    uintptr_t key;
+    uint32_t events;
+
+    do
+    {
+        if (SemaphoreP_pend(ctx->eventSem, timeout) == SemaphoreP_TIMEOUT)
+        {
+            return 0U;
+        }
+        key = EnetOsal_disableAllIntr();
+        events = ctx->events;
+        ctx->events = 0U;
+        EnetOsal_restoreAllIntr(key);
+    }
+    while (events == 0U);
+
+    return events;
+}
+
+/**
+ *  \brief Consumes pending events without blocking.
+ */
+static uint32_t Ethernet_takeEvents(Lan8720_Ctx *ctx)
+{
+    uintptr_t key;
+    uint32_t events;
+
+    key = EnetOsal_disableAllIntr();
+    events = ctx->events;
+    ctx->events = 0U;
+    EnetOsal_restoreAllIntr(key);
+
+    return events;
+}
+
+/**
+ *  \brief Unmasks the link-down, auto-negotiation done and ENERGYON PHY
+ *  interrupts and clears any stale source bits.
+ */
+static void Ethernet_enablePhyIntr(Lan8720_Ctx *ctx)
+{
+    uint16_t intrSrc;
+
+    Lan8720_readReg(ctx->hPhy, LAN8720_INTERRUPT_SOURCE, &intrSrc);
+    Lan8720_writeReg(ctx->hPhy, LAN8720_INTERRUPT_MASK, ETHERNET_PHY_INTR_MASK);
+}
+
+/**
+ *  \brief Acknowledges a PHY interrupt and refreshes the link state.
+ *
+ *  \return 1 if the link is up, 0 otherwise.
+ */
+static uint8_t Ethernet_handlePhyEvent(Lan8720_Ctx *ctx)
+{
+    uint16_t intrSrc = 0U;
+    uint8_t linkUp;
+
+    /* Reading the source register acknowledges the interrupt */
+    Lan8720_readReg(ctx->hPhy, LAN8720_INTERRUPT_SOURCE, &intrSrc);
+    linkUp = Ethernet_linkTick(ctx);
+    if ((intrSrc & ETHERNET_PHY_INTR_MASK) != 0U)
+    {
+        ETHERNET_TRACE_INFO(ctx, ETHERNET_TRACE_LINK, 0U, 0, linkUp);
+        printf("Link %s\n", linkUp ? "up" : "down");
+    }
+    return linkUp;
+}
+
+/**
+ *  \brief Switches the adaptive RX engine mode and accounts the time
+ *  spent in the previous one.
+ */
+static void Ethernet_setRxMode(Lan8720_Ctx *ctx, Ethernet_RxMode mode)
+{
+    uint64_t now = TimerP_getTimeInUsecs();
+
+    if (ctx->rxPoll.mode == ETHERNET_RX_MODE_POLL)
+    {
+        ctx->rxPoll.stats.pollModeUs += now - ctx->rxPoll.modeStartUs;
+        ctx->rxPoll.stats.pollToIntr++;
+    }
+    else
+    {
+        ctx->rxPoll.stats.intrModeUs += now - ctx->rxPoll.modeStartUs;
+        ctx->rxPoll.stats.intrToPoll++;
+    }
+    ctx->rxPoll.mode = mode;
+    ctx->rxPoll.modeStartUs = now;
+    ctx->rxPoll.emptyPolls = 0U;
+}
+
+/**
+ *  \brief Runs one busy-poll iteration of the adaptive RX engine.
+ *
+ *  Falls back to interrupt mode after cfg.maxEmptyPolls consecutive empty
+ *  polls. The RX queue is checked once more after the RX event has been
+ *  re-armed so that frames landing in between are not left stranded.
+ */
+static void Ethernet_rxPoll(Lan8720_Ctx *ctx, uint8_t linkUp)
+{
+    uint32_t count = 0U;
+
+    if (linkUp)
+    {
+        count = Ethernet_drainRx(ctx, ctx->rxPoll.cfg.budget);
+    }
+    ctx->rxPoll.stats.polls++;
+    ctx->rxPoll.stats.pktsPolled += count;
+
+    if (count > 0U)
+    {
+        ctx->rxPoll.emptyPolls = 0U;
+    }
+    else
+    {
+        ctx->rxPoll.stats.emptyPolls++;
+        ctx->rxPoll.emptyPolls++;
+        if (ctx->rxPoll.emptyPolls >= ctx->rxPoll.cfg.maxEmptyPolls)
+        {
+            Ethernet_setRxMode(ctx, ETHERNET_RX_MODE_INTR);
+            EnetDma_enableRxEvent(ctx->hEnet, ctx->macPort);
+            if (linkUp && (Ethernet_drainRx(ctx, ctx->rxPoll.cfg.budget) > 0U))
+            {
+                EnetDma_disableRxEvent(ctx->hEnet, ctx->macPort);
+                Ethernet_setRxMode(ctx, ETHERNET_RX_MODE_POLL);
+            }
+            return;
+        }
+    }
+
+    /* Let other ready tasks of equal priority run between polls. Lower
+     * priority ones wait until the traffic stops, which the budget and
+     * cfg.maxEmptyPolls keep short. */
+    TaskP_yield();
+}
+#endif
+
+/* ========================================================================== */
+/*                    PHY Driver Interface Implementations                    */
+/* ========================================================================== */
+
+/**
+ *  \brief Checks if the PHY device is supported.
+ */
+static bool Lan8720_isPhyDevSupported(EnetPhy_Handle hPhy, const EnetPhy_Version *version)
+{
+    bool supported = false;
+    if ((version->oui == LAN8720_OUI) &&
+        (version->model == LAN8720_MODEL) &&
+        (version->revision == LAN8720_REV))
+    {
+        supported = true;
+    }
+    return supported;
+}
+
+/**
+ *  \brief Checks if the MAC mode is supported.
+ */
+static bool Lan8720_isMacModeSupported(EnetPhy_Handle hPhy, EnetPhy_Mii mii)
+{
+    bool supported;
+    switch (mii)
+    {
+        case ENETPHY_MAC_MII_MII:
+        case ENETPHY_MAC_MII_RMII:
+            supported = true;
+            break;
+        /* LAN8720 doesn't support RGMII Interface*/
+        case ENETPHY_MAC_MII_RGMII:
+        default:
+            supported = false;
+            break;
+    }
+    return supported;
+}
+
+/**
+ *  \brief Applies the register plan of the LAN8720 configuration, then
+ *  completes the setup with Ethernet_configPhy(). Nothing is written if
+ *  the configuration is not valid.
+ */
+static int32_t Lan8720_config(EnetPhy_Handle hPhy, const EnetPhy_Cfg *cfg, EnetPhy_Mii mii)
+{
+    const Lan8720_CfgPlan *plan = Lan8720_getCfgPlan(hPhy, cfg, mii);
+    int32_t status;
+
+    if (plan == NULL)
+    {
+        return ENETPHY_EINVALIDPARAMS;
+    }
+
+    /* Extended register updates are merged and applied with post-increment
+     * MMD accesses in one go */
+    Lan8720_beginExtBatch(hPhy);
+    Lan8720_applyCfgPlan(hPhy, plan);
+    Lan8720_fixFldStrap(hPhy);
+    status = Lan8720_commitExtBatch(hPhy);
+
+    Ethernet_configPhy(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Performs a global software reset.
+ */
+static void Lan8720_reset(EnetPhy_Handle hPhy)
+{
+    uint32_t i;
+
+    ENETTRACE_DBG("PHY %u: Global soft-reset", hPhy->addr);
+    Lan8720_invalidateShadow(hPhy);
+    Lan8720_mdioWrite(hPhy, LAN8720_BMCR, BMCR_RESET);
+
+    /* The reset clears the preamble bypass bit in the PHY, so the bus goes
+     * back to the standard preamble and the bit is cleared in the other
+     * PHYs as well, as Ethernet_disableFastMdio() does */
+    if (fastMdioRegs != NULL)
+    {
+        Ethernet_setMdioPreamble(fastMdioRegs, true);
+        fastMdioRegs = NULL;
+        for (i = 0U; i < ETHERNET_CFG_PORT_NUM; i++)
+        {
+            if (ethCtx[i].inUse && (ethCtx[i].hPhy != NULL) && (ethCtx[i].hPhy != hPhy))
+            {
+                Lan8720_rmwReg(ethCtx[i].hPhy, LAN8720_MODE_CTRL_STATUS, MODE_CTRL_STATUS_MDPREBP, 0U);
+            }
+        }
+    }
+}
+
+/**
+ *  \brief Checks if the global reset is complete.
+ */
+static bool Lan8720_isResetComplete(EnetPhy_Handle hPhy)
+{
+    uint16_t reg = 0;
+    bool complete = false;
+    if (Lan8720_mdioRead(hPhy, LAN8720_BMCR, &reg) == ENETPHY_SOK)
+    {
+        complete = ((reg & BMCR_RESET) == 0U);
+    }
+    if (complete)
+    {
+        Lan8720_invalidateShadow(hPhy);
+    }
+    ENETTRACE_DBG("PHY %u: Global soft-reset is %scomplete", hPhy->addr, complete ? "" : "not ");
+    return complete;
+}
+
+#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_INFO)
+/**
+ *  \brief Prints key PHY registers for debugging.
+ */
+static void Lan8720_printRegs(EnetPhy_Handle hPhy)
+{
+    uint16_t reg = 0U;
+    Lan8720_mdioRead(hPhy, LAN8720_BMCR, &reg);
+    ENETTRACE_INFO("PHY %u: BMCR = 0x%04x", hPhy->addr, reg);
+    Lan8720_mdioRead(hPhy, LAN8720_BMSR, &reg);
+    ENETTRACE_INFO("PHY %u: BMSR = 0x%04x", hPhy->addr, reg);
+}
+#endif
+
+/**
+ *  \brief Plan helper: Sets the MII mode.
+ */
+static void Lan8720_setMiiMode(Lan8720_CfgPlan *plan, EnetPhy_Mii mii)
+{
+    uint16_t val = 0U;
+    ENETTRACE_DBG("MII mode: %u", mii);
+    if (mii == ENETPHY_MAC_MII_RMII)
+    {
+        val = RMIICTL_RMIIEN; 
+    }
+    Lan8720_addCfgOp(plan, LAN8720_RMIICTL | LAN8720_CFG_OP_EXT, RMIICTL_RMIIEN, val);
+}
+
+/**
+ *  \brief Plan helper: Sets the Viterbi idle count threshold.
+ */
+static void Lan8720_setVtmIdleThresh(Lan8720_CfgPlan *plan, uint32_t idleThresh)
+{
+    ENETTRACE_DBG("Viterbi idle threshold: %u", idleThresh);
+    Lan8720_addCfgOp(plan, LAN8720_VTMCFG | LAN8720_CFG_OP_EXT, VTMCFG_IDLETHR_MASK, (uint16_t)idleThresh);
+}
+
+/**
+ *  \brief Extended helper: Applies workaround for FLD threshold.
+ */
+static void Lan8720_fixFldStrap(EnetPhy_Handle hPhy)
+{
+    uint16_t val;
+    Lan8720_readExtReg(hPhy, LAN8720_STRAPSTS2, &val);
+    if ((val & STRAPSTS2_FLD_MASK) != 0U)
+    {
+        ENETTRACE_DBG("PHY %u: Applying FLD threshold workaround", hPhy->addr);
+        Lan8720_rmwExtReg(hPhy, LAN8720_FLDTHRCFG, FLDTHRCFG_FLDTHR_MASK, 1U);
+    }
+}
+
+/**
+ *  \brief Plan helper: Sets clock shift configuration.
+ */
+static void Lan8720_setClkShift(Lan8720_CfgPlan *plan, bool txShiftEn, bool rxShiftEn)
+{
+    uint16_t val = (txShiftEn ? RMIICTL_TXCLKDLY : 0U) | (rxShiftEn ? RMIICTL_RXCLKDLY : 0U);
+    ENETTRACE_DBG("Clock shift TX: %s, RX: %s",
+                   txShiftEn ? "enabled" : "disabled",
+                   rxShiftEn ? "enabled" : "disabled");
+    Lan8720_addCfgOp(plan, LAN8720_RMIICTL | LAN8720_CFG_OP_EXT, RMIICTL_TXCLKDLY | RMIICTL_RXCLKDLY, val);
+}
+
+/**
+ *  \brief Plan helper: Sets TX FIFO depth.
+ */
+static int32_t Lan8720_setTxFifoDepth(Lan8720_CfgPlan *plan, uint8_t depth)
+{
+    uint16_t val = 0U;
+    int32_t status = ENETPHY_SOK;
+    switch (depth)
+    {
+        case 3U:
+            val = PHYCR_TXFIFODEPTH_3B;
+            break;
+        case 4U:
+            val = PHYCR_TXFIFODEPTH_4B;
+            break;
+        case 6U:
+            val = PHYCR_TXFIFODEPTH_6B;
+            break;
+        case 8U:
+            val = PHYCR_TXFIFODEPTH_8B;
+            break;
+        default:
+            status = ENETPHY_EINVALIDPARAMS;
+            break;
+    }
+    if (status == ENETPHY_SOK)
+    {
+        ENETTRACE_DBG("Setting TX FIFO depth to %u", depth);
+        Lan8720_addCfgOp(plan, LAN8720_PHYCR, PHYCR_TXFIFODEPTH_MASK, val);
+    }
+    else
+    {
+        ENETTRACE_ERR(status, "Invalid TX FIFO depth %u", depth);
+    }
+    return status;
+}
+
+/**
+ *  \brief Plan helper: Sets clock delay for RGMII.
+ */
+static int32_t Lan8720_setClkDelay(Lan8720_CfgPlan *plan, uint32_t txDelay, uint32_t rxDelay)
+{
+    uint16_t val;
+    uint32_t delay, delayCtrl;
+    int32_t status = ENETPHY_SOK;
+    if ((txDelay <= RMIIDCTL_DELAY_MAX) && (rxDelay <= RMIIDCTL_DELAY_MAX))
+    {
+        ENETTRACE_DBG("Setting TX delay %u ps, RX delay %u ps", txDelay, rxDelay);
+        delay = (txDelay > 0U) ? txDelay : 1U;
+        delayCtrl = ENETPHY_DIV_ROUNDUP(delay, RMIIDCTL_DELAY_STEP) - 1U;
+        val = (uint16_t)((delayCtrl << RMIIDCTL_TXDLYCTRL_OFFSET) & RMIIDCTL_TXDLYCTRL_MASK);
+        delay = (rxDelay > 0U) ? rxDelay : 1U;
+        delayCtrl = ENETPHY_DIV_ROUNDUP(delay, RMIIDCTL_DELAY_STEP) - 1U;
+        val |= (uint16_t)((delayCtrl << RMIIDCTL_RXDLYCTRL_OFFSET) & RMIIDCTL_RXDLYCTRL_MASK);
+        Lan8720_addCfgOp(plan, LAN8720_RMIIDCTL | LAN8720_CFG_OP_EXT, 0xFFFFU, val);
+    }
+    else
+    {
+        status = ENETPHY_EINVALIDPARAMS;
+        ENETTRACE_ERR(status, "Invalid delay (TX=%u, RX=%u)", txDelay, rxDelay);
+    }
+    return status;
+}
+
+/**
+ *  \brief Plan helper: Sets output impedance.
+ */
+static int32_t Lan8720_setOutputImpedance(Lan8720_CfgPlan *plan, uint32_t impedance)
+{
+    int32_t status = ENETPHY_SOK;
+    uint32_t val;
+    if ((impedance >= IOMUXCFG_IOIMPEDANCE_MIN) && (impedance <= IOMUXCFG_IOIMPEDANCE_MAX))
+    {
+        ENETTRACE_DBG("Setting output impedance to %u milli-ohms", impedance);
+        val = (IOMUXCFG_IOIMPEDANCE_MAX - impedance) * IOMUXCFG_IOIMPEDANCE_MASK;
+        val = (val + IOMUXCFG_IOIMPEDANCE_RANGE / 2) / IOMUXCFG_IOIMPEDANCE_RANGE;
+        Lan8720_addCfgOp(plan, LAN8720_IOMUXCFG | LAN8720_CFG_OP_EXT, IOMUXCFG_IOIMPEDANCE_MASK, (uint16_t)val);
+    }
+    else
+    {
+        status = ENETPHY_EINVALIDPARAMS;
+        ENETTRACE_ERR(status, "Out-of-range impedance %u", impedance);
+    }
+    return status;
+}
+
+/**
+ *  \brief Plan helper: Sets GPIO mux control.
+ */
+static void Lan8720_setGpioMux(Lan8720_CfgPlan *plan, LAN8720_Gpio0Mode gpio0Mode, LAN8720_Gpio1Mode gpio1Mode)
+{
+    uint16_t gpio0 = ((uint16_t)gpio0Mode << GPIOMUXCTRL_GPIO0_OFFSET) & GPIOMUXCTRL_GPIO0_MASK;
+    uint16_t gpio1 = ((uint16_t)gpio1Mode << GPIOMUXCTRL_GPIO1_OFFSET) & GPIOMUXCTRL_GPIO1_MASK;
+    ENETTRACE_DBG("Setting GPIO0 mode %u, GPIO1 mode %u", gpio0Mode, gpio1Mode);
+    Lan8720_addCfgOp(plan, LAN8720_GPIOMUXCTRL | LAN8720_CFG_OP_EXT, GPIOMUXCTRL_GPIO0_MASK | GPIOMUXCTRL_GPIO1_MASK, gpio0 | gpio1);
+}
+
+/**
+ *  \brief Plan helper: Sets LED mode.
+ */
+static void Lan8720_setLedMode(Lan8720_CfgPlan *plan, const LAN8720_LedMode *ledMode)
+{
+    uint16_t val = (((uint16_t)ledMode[0] << LEDCR1_LED0SEL_OFFSET) & LEDCR1_LED0SEL_MASK) |
+                   (((uint16_t)ledMode[1] << LEDCR1_LED1SEL_OFFSET) & LEDCR1_LED1SEL_MASK) |
+                   (((uint16_t)ledMode[2] << LEDCR1_LED2SEL_OFFSET) & LEDCR1_LED2SEL_MASK) |
+                   (((uint16_t)ledMode[3] << LEDCR1_LED3SEL_OFFSET) & LEDCR1_LED3SEL_MASK);
+    ENETTRACE_DBG("Setting LED modes: %u, %u, %u, %u", ledMode[0], ledMode[1], ledMode[2], ledMode[3]);
+    Lan8720_addCfgOp(plan, LAN8720_LEDCR1, 0xFFFFU, val);
+}
+
+/**
+ *  \brief Adds a register update to a plan, merging it with an earlier one
+ *  to the same register.
+ */
+static void Lan8720_addCfgOp(Lan8720_CfgPlan *plan, uint32_t reg, uint16_t mask, uint16_t val)
+{
+    Lan8720_CfgOp *op;
+    uint32_t i;
+
+    /* Keep the plan sorted by register, clause 22 ones first */
+    for (i = 0U; i < plan->num; i++)
+    {
+        if (plan->ops[i].reg >= reg)
+        {
+            break;
+        }
+    }
+
+    if ((i < plan->num) && (plan->ops[i].reg == reg))
+    {
+        op = &plan->ops[i];
+        op->val  = (op->val & ~mask) | (val & mask);
+        op->mask |= mask;
+        return;
+    }
+
+    /* Cannot happen, the plan has room for every configured register */
+    if (plan->num >= LAN8720_CFG_PLAN_MAX)
+    {
+        ENETTRACE_ERR(ENETPHY_EALLOC, "Configuration plan full, reg 0x%x dropped", reg);
+        return;
+    }
+
+    memmove(&plan->ops[i + 1U], &plan->ops[i], (plan->num - i) * sizeof(plan->ops[0]));
+    op = &plan->ops[i];
+    op->reg  = (uint16_t)reg;
+    op->mask = mask;
+    op->val  = val & mask;
+    plan->num++;
+}
+
+/**
+ *  \brief Returns the plan to apply to a PHY, building it from the
+ *  extended configuration when it is not cached yet.
+ *
+ *  \return The plan, NULL if the configuration is not valid.
+ */
+static const Lan8720_CfgPlan *Lan8720_getCfgPlan(EnetPhy_Handle hPhy, const EnetPhy_Cfg *cfg, EnetPhy_Mii mii)
+{
+    Lan8720_PlanSlot *slot = &lan8720Plan[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    const LAN8720_Cfg *extCfg = NULL;
+
+    if (slot->fixed != NULL)
+    {
+        return slot->fixed;
+    }
+
+    if ((cfg != NULL) && (cfg->extendedCfg != NULL) &&
+        (cfg->extendedCfgSize >= sizeof(LAN8720_Cfg)))
+    {
+        extCfg = (const LAN8720_Cfg *)cfg->extendedCfg;
+    }
+
+    /* The configuration is constant while the port is open, so the plan
+     * is only built again if it is given a different one */
+    if (!slot->valid || (slot->srcCfg != extCfg) || (slot->mii != mii))
+    {
+        slot->valid = false;
+        if (Lan8720_buildCfgPlan(extCfg, mii, &slot->plan) != ENETPHY_SOK)
+        {
+            return NULL;
+        }
+        slot->srcCfg = extCfg;
+        slot->mii = mii;
+        slot->valid = true;
+    }
+    return &slot->plan;
+}
+
+/**
+ *  \brief Applies a register plan.
+ *
+ *  Clause 22 registers go through the shadow. Extended registers go into
+ *  the batch the caller opened, so that their current values are fetched
+ *  with post-increment reads and only changed registers are written back.
+ */
+static void Lan8720_applyCfgPlan(EnetPhy_Handle hPhy, const Lan8720_CfgPlan *plan)
+{
+    const Lan8720_CfgOp *op;
+    uint32_t i;
+
+    for (i = 0U; i < plan->num; i++)
+    {
+        op = &plan->ops[i];
+        if ((op->reg & LAN8720_CFG_OP_EXT) != 0U)
+        {
+            Lan8720_rmwExtReg(hPhy, op->reg & ~LAN8720_CFG_OP_EXT, op->mask, op->val);
+        }
+        else if (op->mask == 0xFFFFU)
+        {
+            Lan8720_writeReg(hPhy, op->reg, op->val);
+        }
+        else
+        {
+            Lan8720_rmwReg(hPhy, op->reg, op->mask, op->val);
+        }
+    }
+}
+
+/**
+ *  \brief Extended helper: Performs a software restart.
+ */
+static void Lan8720_restart(EnetPhy_Handle hPhy)
+{
+    ENETTRACE_DBG("PHY %u: Soft restart", hPhy->addr);
+    Lan8720_rmwReg(hPhy, LAN8720_CTRL, CTRL_SWRESTART, CTRL_SWRESTART);
+}
+
+/**
+ *  \brief Extended helper: Performs a read-modify-write on an extended register.
+ *
+ *  Shadowed registers are modified without reading the PHY, and the write
+ *  is skipped altogether when the value does not change. Otherwise the
+ *  read and the write share one MMD window.
+ */
+static void Lan8720_rmwExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val)
+{
+    Lan8720_ExtBatch *batch = &lan8720ExtBatch[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg);
+    uint16_t data;
+    int32_t status;
+    ENETTRACE_VERBOSE("PHY %u: Writing reg %u mask 0x%04x val 0x%04x", hPhy->addr, reg, mask, val);
+    if (batch->open && (batch->hPhy == hPhy))
+    {
+        Lan8720_addExtBatch(batch, reg, mask, val);
+        return;
+    }
+
+    ETHERNET_LAT_BEGIN(t0);
+    if ((idx >= 0) && ((shadow->extValidMask & (1U << idx)) != 0U))
+    {
+        shadow->stats.hits++;
+        data = (shadow->extVal[idx] & ~mask) | (val & mask);
+        Lan8720_writeExtReg(hPhy, reg, data);
+    }
+    else
+    {
+        status = Lan8720_mmdRmw(hPhy, reg, mask, val, &data);
+        if (idx >= 0)
+        {
+            shadow->stats.misses++;
+            if (status == ENETPHY_SOK)
+            {
+                shadow->extVal[idx] = data;
+                shadow->extValidMask |= (1U << idx);
+            }
+            else
+            {
+                shadow->extValidMask &= ~(1U << idx);
+            }
+        }
+    }
+    ETHERNET_LAT_END(ETHERNET_LAT_EXT_RMW, t0);
+}
+
+/**
+ *  \brief Returns the shadow slot of a register, or -1 if it is not shadowed.
+ */
+static int32_t Lan8720_shadowIdx(const uint16_t *regs, uint32_t num, uint32_t reg)
+{
+    uint32_t i;
+
+    for (i = 0U; i < num; i++)
+    {
+        if (regs[i] == reg)
+        {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ *  \brief Drops every shadowed value of a PHY, e.g. after a reset.
+ */
+static void Lan8720_invalidateShadow(EnetPhy_Handle hPhy)
+{
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+
+    if ((shadow->validMask != 0U) || (shadow->extValidMask != 0U))
+    {
+        shadow->validMask = 0U;
+        shadow->extValidMask = 0U;
+        shadow->stats.invalidations++;
+    }
+}
+
+/**
+ *  \brief Reads a clause 22 register, from the shadow when possible.
+ */
+static int32_t Lan8720_readReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val)
+{
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx = Lan8720_shadowIdx(lan8720ShadowRegs, LAN8720_SHADOW_REG_NUM, reg);
+    int32_t status;
+
+    if ((idx >= 0) && ((shadow->validMask & (1U << idx)) != 0U))
+    {
+        shadow->stats.hits++;
+        *val = shadow->val[idx];
+        return ENETPHY_SOK;
+    }
+
+    status = Lan8720_mdioRead(hPhy, reg, val);
+    if (idx >= 0)
+    {
+        shadow->stats.misses++;
+        if (status == ENETPHY_SOK)
+        {
+            shadow->val[idx] = *val;
+            shadow->validMask |= (1U << idx);
+        }
+    }
+    return status;
+}
 
 /**
- *  \brief Checks if the PHY device is supported.
+ *  \brief Writes a clause 22 register, skipping writes that change nothing.
  */
-static bool Lan8720_isPhyDevSupported(EnetPhy_Handle hPhy, const EnetPhy_Version *version)
+static int32_t Lan8720_writeReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val)
 {
-    bool supported = false;
-    if ((version->oui == LAN8720_OUI) &&
-        (version->model == LAN8720_MODEL) &&
-        (version->revision == LAN8720_REV))
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx = Lan8720_shadowIdx(lan8720ShadowRegs, LAN8720_SHADOW_REG_NUM, reg);
+    int32_t status;
+
+    if ((idx >= 0) && ((shadow->validMask & (1U << idx)) != 0U) && (shadow->val[idx] == val))
     {
-        supported = true;
+        shadow->stats.skippedWrites++;
+        return ENETPHY_SOK;
     }
-    return supported;
+
+    status = Lan8720_mdioWrite(hPhy, reg, val);
+    if (idx >= 0)
+    {
+        if (status == ENETPHY_SOK)
+        {
+            shadow->val[idx] = val;
+            shadow->validMask |= (1U << idx);
+        }
+        else
+        {
+            shadow->validMask &= ~(1U << idx);
+        }
+    }
+    return status;
 }
 
 /**
- *  \brief Checks if the MAC mode is supported.
+ *  \brief Read-modify-write of a clause 22 register through the shadow.
  */
-static bool Lan8720_isMacModeSupported(EnetPhy_Handle hPhy, EnetPhy_Mii mii)
+static void Lan8720_rmwReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val)
 {
-    bool supported;
-    switch (mii)
+    uint16_t data;
+
+    if (Lan8720_readReg(hPhy, reg, &data) == ENETPHY_SOK)
     {
-        case ENETPHY_MAC_MII_MII:
-        case ENETPHY_MAC_MII_RMII:
-            supported = true;
-            return true;
-        /* LAN8720 doesn't support RGMII Interface*/
-        case ENETPHY_MAC_MII_RGMII:
-        default:
-            supported=false;
-            return false;
+        data = (data & ~mask) | (val & mask);
+        Lan8720_writeReg(hPhy, reg, data);
+    }
+}
+
+/**
+ *  \brief Reads an extended register, from the shadow when possible.
+ *
+ *  Also used as the readExtReg hook of the driver so that accesses made by
+ *  the upper layer keep the shadow coherent.
+ */
+static int32_t Lan8720_readExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val)
+{
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg);
+    int32_t status;
+
+    if ((idx >= 0) && ((shadow->extValidMask & (1U << idx)) != 0U))
+    {
+        shadow->stats.hits++;
+        *val = shadow->extVal[idx];
+        return ENETPHY_SOK;
+    }
+
+    status = Lan8720_mmdRead(hPhy, reg, val);
+    if (idx >= 0)
+    {
+        shadow->stats.misses++;
+        if (status == ENETPHY_SOK)
+        {
+            shadow->extVal[idx] = *val;
+            shadow->extValidMask |= (1U << idx);
+        }
+    }
+    return status;
+}
+
+/**
+ *  \brief Writes an extended register, skipping writes that change nothing.
+ *
+ *  Also used as the writeExtReg hook of the driver.
+ */
+static int32_t Lan8720_writeExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val)
+{
+    Lan8720_Shadow *shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg);
+    int32_t status;
+
+    if ((idx >= 0) && ((shadow->extValidMask & (1U << idx)) != 0U) && (shadow->extVal[idx] == val))
+    {
+        shadow->stats.skippedWrites++;
+        return ENETPHY_SOK;
+    }
+
+    status = Lan8720_mmdWrite(hPhy, reg, val);
+    if (idx >= 0)
+    {
+        if (status == ENETPHY_SOK)
+        {
+            shadow->extVal[idx] = val;
+            shadow->extValidMask |= (1U << idx);
+        }
+        else
+        {
+            shadow->extValidMask &= ~(1U << idx);
+        }
+    }
+    return status;
+}
+
+/**
+ *  \brief Reads an extended register over MDIO through the MMD window.
+ */
+static int32_t Lan8720_mmdRead(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val)
+{
+    uint16_t devad = MMD_CR_DEVADDR;
+    int32_t status;
+
+    Lan8720_mmdLock(hPhy);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_DR, reg);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_NOPOSTINC);
+    status = Lan8720_mdioRead(hPhy, PHY_MMD_DR, val);
+    Lan8720_mmdUnlock(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Writes an extended register over MDIO through the MMD window.
+ */
+static int32_t Lan8720_mmdWrite(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val)
+{
+    uint16_t devad = MMD_CR_DEVADDR;
+    int32_t status;
+
+    Lan8720_mmdLock(hPhy);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_DR, reg);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_NOPOSTINC);
+    status = Lan8720_mdioWrite(hPhy, PHY_MMD_DR, val);
+    Lan8720_mmdUnlock(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Read-modify-write of an extended register in one MMD window.
+ *
+ *  The window is addressed once and the data register is read and then
+ *  written in place, five MDIO frames instead of eight for a separate read
+ *  and write. The write is left out when the value does not change.
+ *
+ *  \param data Filled in with the value of the register afterwards.
+ */
+static int32_t Lan8720_mmdRmw(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val,
+                              uint16_t *data)
+{
+    uint16_t devad = MMD_CR_DEVADDR;
+    uint16_t cur = 0U;
+    int32_t status;
+
+    Lan8720_mmdLock(hPhy);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_DR, reg);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_NOPOSTINC);
+    status = Lan8720_mdioRead(hPhy, PHY_MMD_DR, &cur);
+    *data = (cur & ~mask) | (val & mask);
+    if ((status == ENETPHY_SOK) && (*data != cur))
+    {
+        status = Lan8720_mdioWrite(hPhy, PHY_MMD_DR, *data);
+    }
+    Lan8720_mmdUnlock(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Takes the MMD window of a PHY for a blocking access sequence.
+ *
+ *  The window is shared with the extended requests of the asynchronous
+ *  MDIO queue; one in progress on the same PHY is waited for, and the
+ *  queue holds back its next one until Lan8720_mmdUnlock().
+ */
+static void Lan8720_mmdLock(EnetPhy_Handle hPhy)
+{
+    uint32_t bit = 1U << (hPhy->addr % LAN8720_PHY_ADDR_NUM);
+    uintptr_t key;
+    bool taken = false;
+
+    while (!taken)
+    {
+        key = EnetOsal_disableAllIntr();
+        taken = ((lan8720MmdBusy & bit) == 0U);
+        lan8720MmdBusy |= bit;
+        EnetOsal_restoreAllIntr(key);
+        if (!taken)
+        {
+            /* Released from the queue's completion interrupt */
+            EnetOsal_sleep(1U);
+        }
+    }
+}
+
+/**
+ *  \brief Releases the MMD window of a PHY and restarts the MDIO queue if
+ *  it was held back by it.
+ */
+static void Lan8720_mmdUnlock(EnetPhy_Handle hPhy)
+{
+    Lan8720_MdioQueue *q = &lan8720MdioQueue;
+    uintptr_t key;
+
+    key = EnetOsal_disableAllIntr();
+    lan8720MmdBusy &= ~(1U << (hPhy->addr % LAN8720_PHY_ADDR_NUM));
+    if ((q->regs != NULL) && !q->busy && (q->head != q->tail))
+    {
+        Lan8720_mdioStartReq(q);
+    }
+    EnetOsal_restoreAllIntr(key);
+}
+
+/**
+ *  \brief Reads a PHY register over MDIO, counting the transaction.
+ */
+static int32_t Lan8720_mdioRead(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val)
+{
+    int32_t status;
+    ETHERNET_LAT_BEGIN(t0);
+
+    lan8720MdioStats[hPhy->addr % LAN8720_PHY_ADDR_NUM].reads++;
+    status = EnetPhy_readReg(hPhy, reg, val);
+    ETHERNET_LAT_END(ETHERNET_LAT_MDIO_READ, t0);
+    return status;
+}
+
+/**
+ *  \brief Writes a PHY register over MDIO, counting the transaction.
+ */
+static int32_t Lan8720_mdioWrite(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val)
+{
+    int32_t status;
+    ETHERNET_LAT_BEGIN(t0);
+
+    lan8720MdioStats[hPhy->addr % LAN8720_PHY_ADDR_NUM].writes++;
+    status = EnetPhy_writeReg(hPhy, reg, val);
+    ETHERNET_LAT_END(ETHERNET_LAT_MDIO_WRITE, t0);
+    return status;
+}
+
+/**
+ *  \brief Reads a run of consecutive extended registers.
+ *
+ *  Uses the post-increment data mode so that the MMD window is set up once
+ *  and each further register costs a single MDIO frame. Shadowed registers
+ *  in the run are refreshed.
+ */
+int32_t Lan8720_readExtRegs(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *vals, uint32_t count)
+{
+    Lan8720_Shadow *shadow;
+    uint16_t devad = MMD_CR_DEVADDR;
+    int32_t status = ENETPHY_SOK;
+    int32_t idx;
+    uint32_t i;
+
+    if ((hPhy == NULL) || (vals == NULL) || (count == 0U) || (reg >= LAN8720_EXT_REG_NUM) ||
+        (count > (LAN8720_EXT_REG_NUM - reg)))
+    {
+        return ENETPHY_EINVALIDPARAMS;
+    }
+
+    shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    Lan8720_mmdLock(hPhy);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_DR, reg);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_POSTINC_RW);
+    for (i = 0U; (i < count) && (status == ENETPHY_SOK); i++)
+    {
+        status = Lan8720_mdioRead(hPhy, PHY_MMD_DR, &vals[i]);
+        idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg + i);
+        if ((idx >= 0) && (status == ENETPHY_SOK))
+        {
+            shadow->extVal[idx] = vals[i];
+            shadow->extValidMask |= (1U << idx);
+        }
+    }
+    Lan8720_mmdUnlock(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Writes a run of consecutive extended registers.
+ *
+ *  Uses the post-increment data mode, see Lan8720_readExtRegs().
+ */
+int32_t Lan8720_writeExtRegs(EnetPhy_Handle hPhy, uint32_t reg, const uint16_t *vals, uint32_t count)
+{
+    Lan8720_Shadow *shadow;
+    uint16_t devad = MMD_CR_DEVADDR;
+    int32_t status = ENETPHY_SOK;
+    int32_t idx;
+    uint32_t i;
+
+    if ((hPhy == NULL) || (vals == NULL) || (count == 0U) || (reg >= LAN8720_EXT_REG_NUM) ||
+        (count > (LAN8720_EXT_REG_NUM - reg)))
+    {
+        return ENETPHY_EINVALIDPARAMS;
+    }
+
+    shadow = &lan8720Shadow[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    Lan8720_mmdLock(hPhy);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_DR, reg);
+    Lan8720_mdioWrite(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_POSTINC_RW);
+    for (i = 0U; (i < count) && (status == ENETPHY_SOK); i++)
+    {
+        status = Lan8720_mdioWrite(hPhy, PHY_MMD_DR, vals[i]);
+        idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg + i);
+        if (idx >= 0)
+        {
+            if (status == ENETPHY_SOK)
+            {
+                shadow->extVal[idx] = vals[i];
+                shadow->extValidMask |= (1U << idx);
+            }
+            else
+            {
+                shadow->extValidMask &= ~(1U << idx);
+            }
+        }
+    }
+    Lan8720_mmdUnlock(hPhy);
+    return status;
+}
+
+/**
+ *  \brief Starts collecting Lan8720_rmwExtReg() calls into a batch.
+ */
+static void Lan8720_beginExtBatch(EnetPhy_Handle hPhy)
+{
+    Lan8720_ExtBatch *batch = &lan8720ExtBatch[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+
+    batch->hPhy = hPhy;
+    batch->num = 0U;
+    batch->open = true;
+}
+
+/**
+ *  \brief Adds a read-modify-write to a batch, merging it with an earlier
+ *  one to the same register.
+ */
+static void Lan8720_addExtBatch(Lan8720_ExtBatch *batch, uint32_t reg, uint16_t mask, uint16_t val)
+{
+    Lan8720_ExtRmw *op;
+    uint32_t i;
+
+    /* Keep the batch sorted by register address */
+    for (i = 0U; i < batch->num; i++)
+    {
+        if (batch->ops[i].reg >= reg)
+        {
+            break;
+        }
+    }
+
+    if ((i < batch->num) && (batch->ops[i].reg == reg))
+    {
+        op = &batch->ops[i];
+        op->val  = (op->val & ~mask) | (val & mask);
+        op->mask |= mask;
+        return;
+    }
+
+    if (batch->num >= LAN8720_EXT_BATCH_MAX)
+    {
+        /* Batch full: apply this one right away */
+        batch->open = false;
+        Lan8720_rmwExtReg(batch->hPhy, reg, mask, val);
+        batch->open = true;
+        return;
+    }
+
+    memmove(&batch->ops[i + 1U], &batch->ops[i], (batch->num - i) * sizeof(batch->ops[0]));
+    op = &batch->ops[i];
+    op->reg  = (uint16_t)reg;
+    op->mask = mask;
+    op->val  = val & mask;
+    batch->num++;
+}
+
+/**
+ *  \brief Applies and closes the open extended register batch.
+ *
+ *  Current values not held in the shadow are fetched with post-increment
+ *  read runs, small gaps between registers being bridged; registers that
+ *  are overwritten as a whole are not read. A register with no neighbour
+ *  to share a run with is modified in a single MMD window instead. Only
+ *  registers whose value changes are written back, consecutive ones in a
+ *  single post-increment write run.
+ */
+static int32_t Lan8720_commitExtBatch(EnetPhy_Handle hPhy)
+{
+    Lan8720_ExtBatch *batch = &lan8720ExtBatch[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    Lan8720_Shadow *shadow;
+    uint16_t runVals[LAN8720_EXT_BATCH_MAX * (LAN8720_EXT_RUN_GAP_MAX + 1U)];
+    bool dirty[LAN8720_EXT_BATCH_MAX];
+    bool done[LAN8720_EXT_BATCH_MAX] = { false };
+    int32_t status = ENETPHY_SOK;
+    uint32_t first, last, i, j;
+    int32_t idx;
+
+    batch->open = false;
+    if (batch->num == 0U)
+    {
+        return ENETPHY_SOK;
+    }
+    shadow = &lan8720Shadow[batch->hPhy->addr % LAN8720_PHY_ADDR_NUM];
+
+    /* Resolve current values, from the shadow or by post-increment reads */
+    i = 0U;
+    while ((i < batch->num) && (status == ENETPHY_SOK))
+    {
+        idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, batch->ops[i].reg);
+        if ((idx >= 0) && ((shadow->extValidMask & (1U << idx)) != 0U))
+        {
+            shadow->stats.hits++;
+            batch->ops[i].data = shadow->extVal[idx];
+            i++;
+            continue;
+        }
+        if (batch->ops[i].mask == 0xFFFFU)
+        {
+            /* Fully overwritten, the current value is not needed */
+            batch->ops[i].data = (uint16_t)~batch->ops[i].val;
+            i++;
+            continue;
+        }
+
+        first = i;
+        last = i;
+        while (((last + 1U) < batch->num) &&
+               ((uint32_t)(batch->ops[last + 1U].reg - batch->ops[last].reg) <= (LAN8720_EXT_RUN_GAP_MAX + 1U)))
+        {
+            last++;
+        }
+
+        if (first == last)
+        {
+            /* Read and write back in the same window */
+            status = Lan8720_mmdRmw(batch->hPhy, batch->ops[i].reg, batch->ops[i].mask,
+                                    batch->ops[i].val, &batch->ops[i].data);
+            if (idx >= 0)
+            {
+                shadow->stats.misses++;
+                if (status == ENETPHY_SOK)
+                {
+                    shadow->extVal[idx] = batch->ops[i].data;
+                    shadow->extValidMask |= (1U << idx);
+                }
+                else
+                {
+                    shadow->extValidMask &= ~(1U << idx);
+                }
+            }
+            done[i] = true;
+            i++;
+            continue;
+        }
+
+        status = Lan8720_readExtRegs(batch->hPhy, batch->ops[first].reg, runVals,
+                                     (uint32_t)(batch->ops[last].reg - batch->ops[first].reg) + 1U);
+        for (j = first; j <= last; j++)
+        {
+            batch->ops[j].data = runVals[batch->ops[j].reg - batch->ops[first].reg];
+            if (Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, batch->ops[j].reg) >= 0)
+            {
+                shadow->stats.misses++;
+            }
+        }
+        i = last + 1U;
+    }
+
+    /* Apply the modifications and find what actually changes */
+    for (i = 0U; i < batch->num; i++)
+    {
+        uint16_t data = (batch->ops[i].data & ~batch->ops[i].mask) | batch->ops[i].val;
+
+        if (done[i])
+        {
+            dirty[i] = false;
+            continue;
+        }
+        dirty[i] = (data != batch->ops[i].data);
+        if (!dirty[i])
+        {
+            shadow->stats.skippedWrites++;
+        }
+        batch->ops[i].data = data;
+    }
+
+    /* Write back changed registers, consecutive ones in one run */
+    i = 0U;
+    while ((i < batch->num) && (status == ENETPHY_SOK))
+    {
+        if (!dirty[i])
+        {
+            i++;
+            continue;
+        }
+
+        first = i;
+        runVals[0] = batch->ops[i].data;
+        while (((i + 1U) < batch->num) && dirty[i + 1U] &&
+               (batch->ops[i + 1U].reg == (batch->ops[i].reg + 1U)))
+        {
+            i++;
+            runVals[i - first] = batch->ops[i].data;
+        }
+
+        status = Lan8720_writeExtRegs(batch->hPhy, batch->ops[first].reg, runVals, (i - first) + 1U);
+        i++;
     }
+
+    batch->num = 0U;
+    return status;
 }
 
 /**
- *  \brief Minimal PHY configuration using Ethernet_config().
+ *  \brief Initializes a LAN8720 configuration with the driver defaults.
  */
-static int32_t Lan8720_config(EnetPhy_Handle hPhy, const EnetPhy_Cfg *cfg, EnetPhy_Mii mii)
+void Lan8720_initCfg(LAN8720_Cfg *cfg)
 {
-    Ethernet_config();
-    return ENETPHY_SOK;
+    if (cfg != NULL)
+    {
+        memset(cfg, 0, sizeof(*cfg));
+        cfg->txClkShiftEn = false;
+        cfg->rxClkShiftEn = false;
+        cfg->txDelayInPs = 2000U;
+        cfg->rxDelayInPs = 2000U;
+        cfg->txFifoDepth = 4U;
+        cfg->idleCntThresh = 4U;
+        cfg->impedanceInMilliOhms = 50000U;
+        cfg->gpio0Mode = LAN8720_GPIO0_RXERR;
+        cfg->gpio1Mode = LAN8720_GPIO1_COL;
+        cfg->ledMode[0] = LAN8720_LED_LINKED;
+        cfg->ledMode[1] = LAN8720_LED_RXTXACT;
+        cfg->ledMode[2] = LAN8720_LED_LINKED_100BTX;
+        cfg->ledMode[3] = LAN8720_LED_LINKED_10BT;
+    }
 }
 
 /**
- *  \brief Performs a global software reset.
+ *  \brief Builds the register write plan of a LAN8720 configuration.
+ *
+ *  Every field is turned into a masked update, updates of the same
+ *  register being merged, e.g. the MII mode and the clock shifts which
+ *  both live in RMIICTL.
  */
-static void Lan8720_reset(EnetPhy_Handle hPhy)
+int32_t Lan8720_buildCfgPlan(const LAN8720_Cfg *cfg, EnetPhy_Mii mii, Lan8720_CfgPlan *plan)
 {
-    lan8720_write_reg(ENET_PHY_ADDR, LAN8720_BMCR, BMCR_RESET);
-}
+    int32_t status = ENETPHY_SOK;
 
-/**
- *  \brief Checks if the global reset is complete.
- */
-static bool Lan8720_isResetComplete(EnetPhy_Handle hPhy)
-{
-    uint16_t reg = 0;
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMCR, &reg);
-    return ((reg & BMCR_RESET) == 0);
-}
+    if (plan == NULL)
+    {
+        return ENETPHY_EBADARGS;
+    }
 
-#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_INFO)
-/**
- *  \brief Prints key PHY registers for debugging.
- */
-static void Lan8720_printRegs(EnetPhy_Handle hPhy)
-{
-    uint16_t reg;
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMCR, &reg);
-    ENETTRACE_INFO("LAN8720 BMCR = 0x%04x", reg);
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMSR, &reg);
-    ENETTRACE_INFO("LAN8720 BMSR = 0x%04x", reg);
+    plan->num = 0U;
+    Lan8720_setMiiMode(plan, mii);
+    if (cfg != NULL)
+    {
+        Lan8720_setClkShift(plan, cfg->txClkShiftEn, cfg->rxClkShiftEn);
+        if (Lan8720_setClkDelay(plan, cfg->txDelayInPs, cfg->rxDelayInPs) != ENETPHY_SOK)
+        {
+            status = ENETPHY_EINVALIDPARAMS;
+        }
+        if (Lan8720_setTxFifoDepth(plan, cfg->txFifoDepth) != ENETPHY_SOK)
+        {
+            status = ENETPHY_EINVALIDPARAMS;
+        }
+        Lan8720_setVtmIdleThresh(plan, cfg->idleCntThresh);
+        if (Lan8720_setOutputImpedance(plan, cfg->impedanceInMilliOhms) != ENETPHY_SOK)
+        {
+            status = ENETPHY_EINVALIDPARAMS;
+        }
+        Lan8720_setGpioMux(plan, cfg->gpio0Mode, cfg->gpio1Mode);
+        Lan8720_setLedMode(plan, cfg->ledMode);
+    }
+    return status;
 }
-#endif
 
 /**
- *  \brief Extended helper: Sets the MII mode.
+ *  \brief Installs a precomputed register write plan for a PHY.
  */
-static void Lan8720_setMiiMode(EnetPhy_Handle hPhy, EnetPhy_Mii mii)
+void Lan8720_setCfgPlan(uint32_t phyAddr, const Lan8720_CfgPlan *plan)
 {
-    uint16_t val = 0U;
-    ENETTRACE_DBG("PHY %u: MII mode: %u", hPhy->addr, mii);
-    if (mii == ENETPHY_MAC_MII_RMII)
+    if (phyAddr < LAN8720_PHY_ADDR_NUM)
     {
-        val = RMIICTL_RMIIEN; 
+        lan8720Plan[phyAddr].fixed = plan;
     }
-    Lan8720_rmwExtReg(hPhy, LAN8720_RMIICTL, val, RMIICTL_RMIIEN);
 }
 
 /**
- *  \brief Extended helper: Sets the Viterbi idle count threshold.
+ *  \brief Applies a new LAN8720 configuration by writing only the registers
+ *  whose settings differ from the current one.
+ *
+ *  The PHY is soft restarted only when a changed register is not in
+ *  lan8720LiveRegs. The new plan replaces the cached one and any plan
+ *  installed with Lan8720_setCfgPlan(), so the settings are kept when the
+ *  PHY is configured again after a reset.
  */
-static void Lan8720_setVtmIdleThresh(EnetPhy_Handle hPhy, uint32_t idleThresh)
+int32_t Lan8720_reconfigure(EnetPhy_Handle hPhy, const LAN8720_Cfg *oldCfg,
+                            const LAN8720_Cfg *newCfg, bool *restarted)
 {
-    ENETTRACE_DBG("PHY %u: Viterbi idle threshold: %u", hPhy->addr, idleThresh);
-    Lan8720_rmwExtReg(hPhy, LAN8720_VTMCFG, VTMCFG_IDLETHR_MASK, idleThresh);
-}
+    Lan8720_PlanSlot *slot;
+    Lan8720_CfgPlan oldPlan, newPlan, diff;
+    const Lan8720_CfgOp *op;
+    Lan8720_Ctx *ctx;
+    EnetPhy_Mii mii;
+    bool restart = false;
+    bool same;
+    int32_t status;
+    uint32_t i, j;
 
-/**
- *  \brief Extended helper: Configures the DSP FFE equalizer.
- */
-static void Lan8720_setDspFFE(EnetPhy_Handle hPhy)
-{
-    ENETTRACE_DBG("PHY %u: DSP FFE equalizer: %u", hPhy->addr, DSPFFECFG_FFEEQ_SHORTCABLE);
-    Lan8720_rmwExtReg(hPhy, LAN8720_DSPFFECFG, DSPFFECFG_FFEEQ_MASK, DSPFFECFG_FFEEQ_SHORTCABLE);
-}
+    if (restarted != NULL)
+    {
+        *restarted = false;
+    }
+    if ((hPhy == NULL) || (newCfg == NULL))
+    {
+        return ENETPHY_EBADARGS;
+    }
 
-/**
- *  \brief Extended helper: Applies workaround for FLD threshold.
- */
-static void Lan8720_fixFldStrap(EnetPhy_Handle hPhy)
-{
-    uint16_t val;
-    EnetPhy_readExtReg(hPhy, LAN8720_STRAPSTS2, &val);
-    if ((val & STRAPSTS2_FLD_MASK) != 0U)
+    /* Without a built plan, e.g. while a fixed one is installed, the MII
+     * mode is the one of the port driving the PHY */
+    slot = &lan8720Plan[hPhy->addr % LAN8720_PHY_ADDR_NUM];
+    ctx = Ethernet_findCtx(hPhy->addr);
+    if (slot->valid)
     {
-        ENETTRACE_DBG("PHY %u: Applying FLD threshold workaround", hPhy->addr);
-        Lan8720_rmwExtReg(hPhy, LAN8720_FLDTHRCFG, FLDTHRCFG_FLDTHR_MASK, 1U);
+        mii = slot->mii;
+    }
+    else
+    {
+        mii = (ctx != NULL) ? ctx->mii : ENETPHY_MAC_MII_RMII;
     }
+
+    /* Nothing is written if the new configuration is not valid */
+    status = Lan8720_buildCfgPlan(newCfg, mii, &newPlan);
+    if (status != ENETPHY_SOK)
+    {
+        return status;
+    }
+    /* The current registers cannot be told from an invalid one */
+    status = Lan8720_buildCfgPlan(oldCfg, mii, &oldPlan);
+    if (status != ENETPHY_SOK)
+    {
+        return status;
+    }
+
+    /* Both plans are sorted by register, keep the updates that differ */
+    diff.num = 0U;
+    j = 0U;
+    for (i = 0U; i < newPlan.num; i++)
+    {
+        op = &newPlan.ops[i];
+        while ((j < oldPlan.num) && (oldPlan.ops[j].reg < op->reg))
+        {
+            j++;
+        }
+        same = (j < oldPlan.num) && (oldPlan.ops[j].reg == op->reg) &&
+               (oldPlan.ops[j].mask == op->mask) && (oldPlan.ops[j].val == op->val);
+        if (!same)
+        {
+            diff.ops[diff.num++] = *op;
+            if (Lan8720_shadowIdx(lan8720LiveRegs, LAN8720_LIVE_REG_NUM, op->reg) < 0)
+            {
+                restart = true;
+            }
+        }
+    }
+
+    if (diff.num == 0U)
+    {
+        Lan8720_storeCfgPlan(slot, &newPlan, mii);
+        return ENETPHY_SOK;
+    }
+
+    ENETTRACE_DBG("PHY %u: Reconfiguring %u registers%s", hPhy->addr, diff.num,
+                  restart ? ", restart needed" : "");
+    Lan8720_beginExtBatch(hPhy);
+    Lan8720_applyCfgPlan(hPhy, &diff);
+    status = Lan8720_commitExtBatch(hPhy);
+
+    if (status == ENETPHY_SOK)
+    {
+        if (restart)
+        {
+            Lan8720_restart(hPhy);
+        }
+        if (restarted != NULL)
+        {
+            *restarted = restart;
+        }
+        Lan8720_storeCfgPlan(slot, &newPlan, mii);
+    }
+    return status;
 }
 
 /**
- *  \brief Extended helper: Configures loopback mode.
+ *  \brief Makes a plan the one the config hook applies, in place of the
+ *  cached and the installed ones.
  */
-static void Lan8720_setLoopbackCfg(EnetPhy_Handle hPhy, bool enable)
+static void Lan8720_storeCfgPlan(Lan8720_PlanSlot *slot, const Lan8720_CfgPlan *plan,
+                                 EnetPhy_Mii mii)
 {
-    uint16_t val = enable ? LOOPCR_CFG_LOOPBACK : LOOPCR_CFG_NORMAL;
-    ENETTRACE_DBG("PHY %u: %s loopback", hPhy->addr, enable ? "Enabling" : "Disabling");
-    GenericPhy_writeExtReg(hPhy, LAN8720_LOOPCR, val);
+    slot->fixed = NULL;
+    slot->plan = *plan;
+    slot->mii = mii;
+    slot->valid = true;
 }
 
 /**
- *  \brief Extended helper: Enables or disables Auto-MDIX.
+ *  \brief Gets the MDIO transaction counters of a PHY.
  */
-static void Lan8720_enableAutoMdix(EnetPhy_Handle hPhy, bool enable)
+void Lan8720_getMdioStats(uint32_t phyAddr, Lan8720_MdioStats *stats)
 {
-    uint16_t val = enable ? PHYCR_MDICROSSOVER_AUTO : PHYCR_MDICROSSOVER_MDI;
-    ENETTRACE_DBG("PHY %u: %s Auto-MDIX", hPhy->addr, enable ? "Enabling" : "Disabling");
-    EnetPhy_rmwReg(hPhy, LAN8720_PHYCR, PHYCR_MDICROSSOVER_MASK, val);
-    if (enable)
+    if ((stats != NULL) && (phyAddr < LAN8720_PHY_ADDR_NUM))
     {
-        ENETTRACE_DBG("PHY %u: Enabling Robust Auto-MDIX", hPhy->addr);
-        EnetPhy_rmwReg(hPhy, LAN8720_CFG3, CFG3_ROBUSTAUTOMDIX, CFG3_ROBUSTAUTOMDIX);
+        *stats = lan8720MdioStats[phyAddr];
     }
 }
 
 /**
- *  \brief Extended helper: Sets clock shift configuration.
+ *  \brief Sets up the asynchronous MDIO request queue on its user group.
  */
-static void Lan8720_setClkShift(EnetPhy_Handle hPhy, bool txShiftEn, bool rxShiftEn)
+int32_t Lan8720_openMdioQueue(uintptr_t mdioBaseAddr)
 {
-    uint16_t val = (txShiftEn ? RMIICTL_TXCLKDLY : 0U) | (rxShiftEn ? RMIICTL_RXCLKDLY : 0U);
-    ENETTRACE_DBG("PHY %u: Clock shift TX: %s, RX: %s", hPhy->addr,
-                   txShiftEn ? "enabled" : "disabled",
-                   rxShiftEn ? "enabled" : "disabled");
-    Lan8720_rmwExtReg(hPhy, LAN8720_RMIICTL, RMIICTL_TXCLKDLY | RMIICTL_RXCLKDLY, val);
+    Lan8720_MdioQueue *q = &lan8720MdioQueue;
+    CSL_mdioRegs *regs = (CSL_mdioRegs *)mdioBaseAddr;
+
+    if (regs == NULL)
+    {
+        return ENETPHY_EBADARGS;
+    }
+    if ((CSL_REG32_RD(&regs->USER_GROUP[LAN8720_MDIO_QUEUE_GROUP].USER_ACCESS_REG) &
+         CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK) != 0U)
+    {
+        return ENETPHY_EPERM;
+    }
+
+    memset(q, 0, sizeof(*q));
+    CSL_REG32_WR(&regs->USER_INT_RAW_REG, 1U << LAN8720_MDIO_QUEUE_GROUP);
+    CSL_REG32_WR(&regs->USER_INT_MASK_SET_REG, 1U << LAN8720_MDIO_QUEUE_GROUP);
+    q->regs = regs;
+    return ENETPHY_SOK;
 }
 
 /**
- *  \brief Extended helper: Sets TX FIFO depth.
+ *  \brief Posts an asynchronous MDIO request, starting it if the queue
+ *  is idle.
  */
-static int32_t Lan8720_setTxFifoDepth(EnetPhy_Handle hPhy, uint8_t depth)
+int32_t Lan8720_postMdio(uint32_t phyAddr, Lan8720_MdioOp op, uint32_t reg,
+                         uint16_t mask, uint16_t val, Lan8720_MdioCb cb, void *cbArg)
 {
-    uint16_t val = 0U;
-    int32_t status = ENETPHY_SOK;
-    switch (depth)
+    Lan8720_MdioQueue *q = &lan8720MdioQueue;
+    Lan8720_MdioReq *req;
+    uintptr_t key;
+
+    if (q->regs == NULL)
     {
-        case 3U:
-            val = PHYCR_TXFIFODEPTH_3B;
-            break;
-        case 4U:
-            val = PHYCR_TXFIFODEPTH_4B;
-            break;
-        case 6U:
-            val = PHYCR_TXFIFODEPTH_6B;
-            break;
-        case 8U:
-            val = PHYCR_TXFIFODEPTH_8B;
-            break;
-        default:
-            status = ENETPHY_EINVALIDPARAMS;
-            break;
+        return ENETPHY_EPERM;
     }
-    if (status == ENETPHY_SOK)
+    if ((phyAddr >= LAN8720_PHY_ADDR_NUM) || (op > LAN8720_MDIO_OP_EXT_RMW))
     {
-        ENETTRACE_DBG("PHY %u: Setting TX FIFO depth to %u", hPhy->addr, depth);
-        EnetPhy_rmwReg(hPhy, LAN8720_PHYCR, PHYCR_TXFIFODEPTH_MASK, val);
+        return ENETPHY_EBADARGS;
     }
-    else
+
+    key = EnetOsal_disableAllIntr();
+    if ((q->head - q->tail) >= LAN8720_CFG_MDIO_QUEUE_SIZE)
     {
-        ENETTRACE_ERR(status, "PHY %u: Invalid TX FIFO depth %u", hPhy->addr, depth);
+        EnetOsal_restoreAllIntr(key);
+        return ENETPHY_EALLOC;
     }
-    return status;
-}
 
-/**
- *  \brief Extended helper: Sets clock delay for RGMII.
- */
-static int32_t Lan8720_setClkDelay(EnetPhy_Handle hPhy, uint32_t txDelay, uint32_t rxDelay)
-{
-    uint16_t val;
-    uint32_t delay, delayCtrl;
-    int32_t status = ENETPHY_SOK;
-    if ((txDelay <= RMIIDCTL_DELAY_MAX) && (rxDelay <= RMIIDCTL_DELAY_MAX))
+    req = &q->req[q->head & (LAN8720_CFG_MDIO_QUEUE_SIZE - 1U)];
+    req->cb = cb;
+    req->cbArg = cbArg;
+    req->phyAddr = (uint8_t)phyAddr;
+    req->op = (uint8_t)op;
+    req->step = 0U;
+    req->reg = (uint16_t)reg;
+    req->mask = mask;
+    req->val = val;
+    req->data = 0U;
+    q->head++;
+
+    /* Blocking accesses must not use the shadowed value until the write
+     * is done */
+    if ((op != LAN8720_MDIO_OP_READ) && (op != LAN8720_MDIO_OP_EXT_READ))
     {
-        ENETTRACE_DBG("PHY %u: Setting TX delay %u ps, RX delay %u ps", hPhy->addr, txDelay, rxDelay);
-        delay = (txDelay > 0U) ? txDelay : 1U;
-        delayCtrl = ENETPHY_DIV_ROUNDUP(delay, RMIIDCTL_DELAY_STEP) - 1U;
-        val = (uint16_t)((delayCtrl << RMIIDCTL_TXDLYCTRL_OFFSET) & RMIIDCTL_TXDLYCTRL_MASK);
-        delay = (rxDelay > 0U) ? rxDelay : 1U;
-        delayCtrl = ENETPHY_DIV_ROUNDUP(delay, RMIIDCTL_DELAY_STEP) - 1U;
-        val |= (uint16_t)((delayCtrl << RMIIDCTL_RXDLYCTRL_OFFSET) & RMIIDCTL_RXDLYCTRL_MASK);
-        GenericPhy_writeExtReg(hPhy, LAN8720_RMIIDCTL, val);
+        Lan8720_setShadow(phyAddr, (op >= LAN8720_MDIO_OP_EXT_READ), reg, NULL);
     }
-    else
+
+    if (!q->busy)
     {
-        status = ENETPHY_EINVALIDPARAMS;
-        ENETTRACE_ERR(status, "PHY %u: Invalid delay (TX=%u, RX=%u)", hPhy->addr, txDelay, rxDelay);
+        Lan8720_mdioStartReq(q);
     }
-    return status;
+    EnetOsal_restoreAllIntr(key);
+    return ENETPHY_SOK;
 }
 
 /**
- *  \brief Extended helper: Sets output impedance.
+ *  \brief Completes the MDIO frame on the bus and starts the next one.
  */
-static int32_t Lan8720_setOutputImpedance(EnetPhy_Handle hPhy, uint32_t impedance)
+void Lan8720_mdioQueueIsr(void)
 {
+    Lan8720_MdioQueue *q = &lan8720MdioQueue;
+    Lan8720_MdioReq *req;
+    Lan8720_MdioCb cb = NULL;
+    void *cbArg = NULL;
     int32_t status = ENETPHY_SOK;
-    uint32_t val;
-    if ((impedance >= IOMUXCFG_IOIMPEDANCE_MIN) && (impedance <= IOMUXCFG_IOIMPEDANCE_MAX))
+    uint32_t access, frame;
+    uint16_t val = 0U;
+    uintptr_t key;
+
+    if (q->regs == NULL)
     {
-        ENETTRACE_DBG("PHY %u: Setting output impedance to %u milli-ohms", hPhy->addr, impedance);
-        val = (IOMUXCFG_IOIMPEDANCE_MAX - impedance) * IOMUXCFG_IOIMPEDANCE_MASK;
-        val = (val + IOMUXCFG_IOIMPEDANCE_RANGE / 2) / IOMUXCFG_IOIMPEDANCE_RANGE;
-        Lan8720_rmwExtReg(hPhy, LAN8720_IOMUXCFG, IOMUXCFG_IOIMPEDANCE_MASK, val);
+        return;
+    }
+
+    key = EnetOsal_disableAllIntr();
+    access = CSL_REG32_RD(&q->regs->USER_GROUP[LAN8720_MDIO_QUEUE_GROUP].USER_ACCESS_REG);
+    if (!q->busy || ((access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK) != 0U))
+    {
+        EnetOsal_restoreAllIntr(key);
+        return;
+    }
+    CSL_REG32_WR(&q->regs->USER_INT_RAW_REG, 1U << LAN8720_MDIO_QUEUE_GROUP);
+
+    req = &q->req[q->tail & (LAN8720_CFG_MDIO_QUEUE_SIZE - 1U)];
+    if ((access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_WRITE_MASK) == 0U)
+    {
+        if ((access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_ACK_MASK) != 0U)
+        {
+            req->data = (uint16_t)(access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_DATA_MASK);
+        }
+        else
+        {
+            status = ENETPHY_EFAIL;
+        }
+    }
+
+    req->step++;
+    if ((status == ENETPHY_SOK) && Lan8720_mdioNextFrame(req, &frame))
+    {
+        CSL_REG32_WR(&q->regs->USER_GROUP[LAN8720_MDIO_QUEUE_GROUP].USER_ACCESS_REG, frame);
     }
     else
     {
-        status = ENETPHY_EINVALIDPARAMS;
-        ENETTRACE_ERR(status, "PHY %u: Out-of-range impedance %u", hPhy->addr, impedance);
+        if ((status == ENETPHY_SOK) &&
+            (req->op != LAN8720_MDIO_OP_READ) && (req->op != LAN8720_MDIO_OP_EXT_READ))
+        {
+            Lan8720_setShadow(req->phyAddr, (req->op >= LAN8720_MDIO_OP_EXT_READ), req->reg, &req->data);
+        }
+        if (req->op >= LAN8720_MDIO_OP_EXT_READ)
+        {
+            lan8720MmdBusy &= ~(1U << req->phyAddr);
+        }
+        cb = req->cb;
+        cbArg = req->cbArg;
+        val = req->data;
+        q->tail++;
+        q->busy = false;
+        if (q->head != q->tail)
+        {
+            Lan8720_mdioStartReq(q);
+        }
     }
-    return status;
-}
+    EnetOsal_restoreAllIntr(key);
 
-/**
- *  \brief Extended helper: Sets GPIO mux control.
- */
-static void Lan8720_setGpioMux(EnetPhy_Handle hPhy, LAN8720_Gpio0Mode gpio0Mode, LAN8720_Gpio1Mode gpio1Mode)
-{
-    int16_t gpio0 = ((uint16_t)gpio0Mode << GPIOMUXCTRL_GPIO0_OFFSET) & GPIOMUXCTRL_GPIO0_MASK;
-    int16_t gpio1 = ((uint16_t)gpio1Mode << GPIOMUXCTRL_GPIO1_OFFSET) & GPIOMUXCTRL_GPIO1_MASK;
-    ENETTRACE_DBG("PHY %u: Setting GPIO0 mode %u, GPIO1 mode %u", hPhy->addr, gpio0Mode, gpio1Mode);
-    Lan8720_rmwExtReg(hPhy, LAN8720_GPIOMUXCTRL, GPIOMUXCTRL_GPIO0_MASK | GPIOMUXCTRL_GPIO1_MASK, gpio0 | gpio1);
+    /* Outside the critical section, the callback may post new requests */
+    if (cb != NULL)
+    {
+        cb(cbArg, status, val);
+    }
 }
 
 /**
- *  \brief Extended helper: Sets LED mode.
+ *  \brief Builds the next MDIO frame of a request.
+ *
+ *  Extended registers are reached through the MMD window: three writes
+ *  select the register without post-increment, the data register is then
+ *  read and/or written like a clause 22 register. An extended RMW thus
+ *  takes five frames.
+ *
+ *  \return false once the request has no frame left.
  */
-static void Lan8720_setLedMode(EnetPhy_Handle hPhy, const LAN8720_LedMode *ledMode)
+static bool Lan8720_mdioNextFrame(Lan8720_MdioReq *req, uint32_t *frame)
 {
-    uint16_t val = (((uint16_t)ledMode[0] << LEDCR1_LED0SEL_OFFSET) & LEDCR1_LED0SEL_MASK) |
-                   (((uint16_t)ledMode[1] << LEDCR1_LED1SEL_OFFSET) & LEDCR1_LED1SEL_MASK) |
-                   (((uint16_t)ledMode[2] << LEDCR1_LED2SEL_OFFSET) & LEDCR1_LED2SEL_MASK) |
-                   (((uint16_t)ledMode[3] << LEDCR1_LED3SEL_OFFSET) & LEDCR1_LED3SEL_MASK);
-    ENETTRACE_DBG("PHY %u: Setting LED modes: %u, %u, %u, %u", hPhy->addr, ledMode[0], ledMode[1], ledMode[2], ledMode[3]);
-    EnetPhy_writeReg(hPhy, LAN8720_LEDCR1, val);
-}
+    bool ext = (req->op >= LAN8720_MDIO_OP_EXT_READ);
+    uint32_t step = req->step;
+    uint32_t reg = req->reg;
+    uint32_t data = 0U;
+    bool write = true;
+    bool last;
 
-/**
- *  \brief Extended helper: Performs a software restart.
- */
-static void Lan8720_restart(EnetPhy_Handle hPhy)
-{
-    ENETTRACE_DBG("PHY %u: Soft restart", hPhy->addr);
-    EnetPhy_rmwReg(hPhy, LAN8720_CTRL, CTRL_SWRESTART, CTRL_SWRESTART);
-}
+    if (ext && (step < 3U))
+    {
+        reg = (step == 1U) ? PHY_MMD_DR : PHY_MMD_CR;
+        data = (step == 0U) ? (MMD_CR_DEVADDR | MMD_CR_ADDR) :
+               (step == 1U) ? req->reg : (MMD_CR_DEVADDR | MMD_CR_DATA_NOPOSTINC);
+    }
+    else
+    {
+        if (ext)
+        {
+            reg = PHY_MMD_DR;
+            step -= 3U;
+        }
+        switch (req->op)
+        {
+            case LAN8720_MDIO_OP_READ:
+            case LAN8720_MDIO_OP_EXT_READ:
+                last = (step >= 1U);
+                write = false;
+                break;
+            case LAN8720_MDIO_OP_WRITE:
+            case LAN8720_MDIO_OP_EXT_WRITE:
+                last = (step >= 1U);
+                req->data = req->val;
+                break;
+            default:
+                last = (step >= 2U);
+                write = (step == 1U);
+                if (write)
+                {
+                    req->data = (req->data & ~req->mask) | (req->val & req->mask);
+                }
+                break;
+        }
+        if (last)
+        {
+            return false;
+        }
+        data = write ? req->data : 0U;
+    }
 
-/**
- *  \brief Extended helper: Performs a global software reset.
- */
-static void Lan8720_reset(EnetPhy_Handle hPhy)
-{
-    ENETTRACE_DBG("PHY %u: Global soft-reset", hPhy->addr);
-    EnetPhy_rmwReg(hPhy, LAN8720_CTRL, CTRL_SWRESET, CTRL_SWRESET);
+    if (write)
+    {
+        lan8720MdioStats[req->phyAddr].writes++;
+    }
+    else
+    {
+        lan8720MdioStats[req->phyAddr].reads++;
+    }
+    *frame = CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK |
+             (write ? CSL_MDIO_USER_GROUP_USER_ACCESS_REG_WRITE_MASK : 0U) |
+             ((reg << CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_SHIFT) &
+              CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_MASK) |
+             (((uint32_t)req->phyAddr << CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_SHIFT) &
+              CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_MASK) |
+             (data & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_DATA_MASK);
+    return true;
 }
 
 /**
- *  \brief Extended helper: Checks if reset is complete.
+ *  \brief Puts the first frame of the request at the queue tail on the bus.
+ *  Called with interrupts disabled.
+ *
+ *  An extended request takes the MMD window of its PHY until it completes.
+ *  While a blocking sequence holds it the queue stays idle, to be restarted
+ *  by Lan8720_mmdUnlock().
  */
-static bool Lan8720_isResetComplete(EnetPhy_Handle hPhy)
+static void Lan8720_mdioStartReq(Lan8720_MdioQueue *q)
 {
-    int32_t status;
-    uint16_t reg;
-    bool complete = false;
-    status = EnetPhy_readReg(hPhy, LAN8720_CTRL, &reg);
-    if (status == ENETPHY_SOK)
+    Lan8720_MdioReq *req = &q->req[q->tail & (LAN8720_CFG_MDIO_QUEUE_SIZE - 1U)];
+    uint32_t bit = 1U << req->phyAddr;
+    uint32_t frame;
+
+    if (req->op >= LAN8720_MDIO_OP_EXT_READ)
     {
-        complete = ((reg & CTRL_SWRESET) == 0U);
+        if ((lan8720MmdBusy & bit) != 0U)
+        {
+            return;
+        }
+        lan8720MmdBusy |= bit;
+    }
+    if (Lan8720_mdioNextFrame(req, &frame))
+    {
+        q->busy = true;
+        CSL_REG32_WR(&q->regs->USER_GROUP[LAN8720_MDIO_QUEUE_GROUP].USER_ACCESS_REG, frame);
     }
-    ENETTRACE_DBG("PHY %u: Global soft-reset is %scomplete", hPhy->addr, complete ? "" : "not ");
-    return complete;
 }
 
 /**
- *  \brief Extended helper: Performs a read-modify-write on an extended register.
+ *  \brief Updates, or with a NULL value invalidates, the shadow of a
+ *  register written behind the blocking access functions.
  */
-static void Lan8720_rmwExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val)
+static void Lan8720_setShadow(uint32_t phyAddr, bool ext, uint32_t reg, const uint16_t *val)
 {
-    uint16_t devad = MMD_CR_DEVADDR;
-    uint16_t data;
-    int32_t status;
-    ENETTRACE_VERBOSE("PHY %u: Writing reg %u mask 0x%04x val 0x%04x", hPhy->addr, reg, mask, val);
-    EnetPhy_writeReg(hPhy, PHY_MMD_CR, devad | MMD_CR_ADDR);
-    EnetPhy_writeReg(hPhy, PHY_MMD_DR, reg);
-    EnetPhy_writeReg(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_NOPOSTINC);
-    status = EnetPhy_readReg(hPhy, PHY_MMD_DR, &data);
-    if (status == ENETPHY_SOK)
+    Lan8720_Shadow *shadow = &lan8720Shadow[phyAddr % LAN8720_PHY_ADDR_NUM];
+    int32_t idx;
+
+    if (ext)
     {
-        data = (data & ~mask) | (val & mask);
-        EnetPhy_writeReg(hPhy, PHY_MMD_CR, devad | MMD_CR_DATA_NOPOSTINC);
-        EnetPhy_writeReg(hPhy, PHY_MMD_DR, data);
+        idx = Lan8720_shadowIdx(lan8720ShadowExtRegs, LAN8720_SHADOW_EXTREG_NUM, reg);
+        if (idx >= 0)
+        {
+            if (val != NULL)
+            {
+                shadow->extVal[idx] = *val;
+                shadow->extValidMask |= (1U << idx);
+            }
+            else
+            {
+                shadow->extValidMask &= ~(1U << idx);
+            }
+        }
+    }
+    else
+    {
+        idx = Lan8720_shadowIdx(lan8720ShadowRegs, LAN8720_SHADOW_REG_NUM, reg);
+        if (idx >= 0)
+        {
+            if (val != NULL)
+            {
+                shadow->val[idx] = *val;
+                shadow->validMask |= (1U << idx);
+            }
+            else
+            {
+                shadow->validMask &= ~(1U << idx);
+            }
+        }
     }
 }
 
-#if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_INFO)
 /**
- *  \brief Extended helper: Prints key PHY registers for debugging.
+ *  \brief Gets the shadow cache counters of a PHY.
  */
-static void Lan8720_printRegs(EnetPhy_Handle hPhy)
+void Lan8720_getShadowStats(uint32_t phyAddr, Lan8720_ShadowStats *stats)
 {
-    uint16_t reg;
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMCR, &reg);
-    ENETTRACE_INFO("LAN8720 BMCR = 0x%04x", reg);
-    lan8720_read_reg(ENET_PHY_ADDR, LAN8720_BMSR, &reg);
-    ENETTRACE_INFO("LAN8720 BMSR = 0x%04x", reg);
+    if ((stats != NULL) && (phyAddr < LAN8720_PHY_ADDR_NUM))
+    {
+        *stats = lan8720Shadow[phyAddr].stats;
+    }
 }
-#endif
 
 /* ========================================================================== */
 /*                 PHY Driver Interface Instance for Upper Layers             */
@@ -575,8 +5675,8 @@ EnetPhy_Drv gEnetPhyDrvLan8720 =
     .config             = Lan8720_config,
     .reset              = Lan8720_reset,
     .isResetComplete    = Lan8720_isResetComplete,
-    .readExtReg         = GenericPhy_readExtReg,            //Points to Generic PHY layer read and write external register value
-    .writeExtReg        = GenericPhy_writeExtReg,
+    .readExtReg         = Lan8720_readExtReg,               //Shadowed wrappers around the generic MMD register access
+    .writeExtReg        = Lan8720_writeExtReg,
 #if (ENET_CFG_TRACE_LEVEL >= ENET_CFG_TRACE_LEVEL_INFO)
     .printRegs          = Lan8720_printRegs,
 #endif
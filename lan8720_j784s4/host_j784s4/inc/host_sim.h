@@ -0,0 +1,241 @@
+/**
+ * @file host_sim.h
+ * @brief Host simulation of the hardware around the LAN8720 driver
+ *
+ * Stands in for the PDK on Linux so that the driver can be built and
+ * exercised without a board: an in-memory register model of the LAN8720
+ * PHYs on one MDIO bus, the MDIO controller with its link polling and
+ * USERACCESS engine, a loopback DMA and the OSAL services on POSIX threads.
+ *
+ * Interrupts are modelled by a global recursive lock, which is also what
+ * EnetOsal_disableAllIntr() takes. Hardware events are produced by
+ * HostSim_poll(), called by the test or by the hardware thread, and the
+ * registered handlers run with the lock held.
+ */
+
+#ifndef HOST_SIM_H_
+#define HOST_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/drv/enet/enet.h>
+#include <ti/csl/cslr_mdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ========================================================================== */
+/*                           Macros & Typedefs                                */
+/* ========================================================================== */
+
+/*! Number of MDIO addresses on the simulated bus */
+#define HOSTSIM_PHY_ADDR_NUM     (32U)
+
+/*! Number of MAC ports with a DMA loopback */
+#define HOSTSIM_PORT_NUM         (4U)
+
+/*! Size of the buffer of each DMA packet */
+#define HOSTSIM_PKT_BUF_SIZE     (1536U)
+
+/*!
+ * \brief Simulated interrupt lines.
+ */
+typedef enum HostSim_Irq_e
+{
+    HOSTSIM_IRQ_PHY = 0U,     /*!< nINT of a PHY, one line per PHY address */
+    HOSTSIM_IRQ_MDIO_LINK,    /*!< MDIO controller link interrupt */
+    HOSTSIM_IRQ_MDIO_USER,    /*!< MDIO controller USERACCESS interrupt */
+    HOSTSIM_IRQ_DMA_RX,       /*!< RX completion, one line per MAC port */
+    HOSTSIM_IRQ_DMA_TX,       /*!< TX completion, one line per MAC port */
+    HOSTSIM_IRQ_NUM
+} HostSim_Irq;
+
+typedef void (*HostSim_Isr)(void *arg);
+
+/*!
+ * \brief Counters of the simulated hardware.
+ */
+typedef struct HostSim_Stats_s
+{
+    /*! MDIO read frames issued by software, blocking or USERACCESS */
+    uint32_t mdioReads;
+    /*! MDIO write frames issued by software, blocking or USERACCESS */
+    uint32_t mdioWrites;
+    /*! Of those, frames to the MMD access window (MMDCR or MMDDR) */
+    uint32_t mmdFrames;
+    /*! BMSR reads done by the MDIO controller's own link polling */
+    uint32_t mdioPollReads;
+    /*! MDIO reads that failed, e.g. without preamble */
+    uint32_t mdioErrors;
+    /*! Frames taken from the TX DMA queue */
+    uint32_t txFrames;
+    /*! Bytes of those frames */
+    uint64_t txBytes;
+    /*! Frames looped back into an RX buffer */
+    uint32_t rxFrames;
+    /*! Frames dropped for lack of a free RX buffer */
+    uint32_t rxNoBuf;
+    /*! Software resets of the PHYs */
+    uint32_t phyResets;
+    /*! Auto-negotiations started */
+    uint32_t anegRestarts;
+    /*! Handler invocations per interrupt line */
+    uint32_t irqs[HOSTSIM_IRQ_NUM];
+    /*! Calls to TaskP_yield() */
+    uint32_t yields;
+} HostSim_Stats;
+
+/* ========================================================================== */
+/*                          Function Declarations                             */
+/* ========================================================================== */
+
+/*!
+ * \brief Reset the whole simulation: no PHYs, empty DMA queues, no
+ *        handlers, counters cleared.
+ */
+void HostSim_init(void);
+
+/*!
+ * \brief Put a LAN8720 at an MDIO address, in its reset state and with
+ *        the cable unplugged.
+ */
+void HostSim_addPhy(uint32_t phyAddr);
+
+/*!
+ * \brief Plug or unplug the cable of a PHY.
+ *
+ * With auto-negotiation enabled the link comes up negotiated against the
+ * partner abilities, otherwise at the forced speed and duplex.
+ */
+void HostSim_setLink(uint32_t phyAddr, bool up);
+
+/*!
+ * \brief Set the abilities the link partner advertises, as in ANLPAR.
+ */
+void HostSim_setPartner(uint32_t phyAddr, uint16_t anlpar);
+
+/*!
+ * \brief Read or write a clause 22 register without going over MDIO.
+ */
+uint16_t HostSim_getReg(uint32_t phyAddr, uint32_t reg);
+void HostSim_setReg(uint32_t phyAddr, uint32_t reg, uint16_t val);
+
+/*!
+ * \brief Read or write an extended (MMD) register without going over MDIO.
+ */
+uint16_t HostSim_getExtReg(uint32_t phyAddr, uint32_t reg);
+void HostSim_setExtReg(uint32_t phyAddr, uint32_t reg, uint16_t val);
+
+/*!
+ * \brief MDIO frames software issued to one PHY.
+ */
+uint32_t HostSim_getPhyFrames(uint32_t phyAddr);
+
+/*!
+ * \brief The simulated MDIO controller registers, to be passed as the MDIO
+ *        base address.
+ */
+CSL_mdioRegs *HostSim_mdioRegs(void);
+
+/*!
+ * \brief The Enet handle of the simulated instance.
+ */
+Enet_Handle HostSim_enet(void);
+
+/*!
+ * \brief Register the handler of an interrupt line.
+ *
+ * \param irq  Interrupt line
+ * \param idx  PHY address or MAC port for the lines that have one per
+ *             PHY or port, 0 otherwise
+ * \param isr  Handler, NULL to leave the line unconnected
+ * \param arg  Argument passed to the handler
+ */
+void HostSim_setIsr(HostSim_Irq irq, uint32_t idx, HostSim_Isr isr, void *arg);
+
+/*!
+ * \brief Enable or disable the DMA loopback of a port. Without it the TX
+ *        frames are only counted.
+ */
+void HostSim_setLoopback(Enet_MacPort macPort, bool enable);
+
+/*!
+ * \brief Hold TX completions of a port until released by
+ *        HostSim_completeTx().
+ */
+void HostSim_holdTx(Enet_MacPort macPort, bool hold);
+
+/*!
+ * \brief Call a hook at the end of EnetDma_submitRxPktQ() of a port, once
+ *        the queue has been taken, to run something before the caller
+ *        carries on.
+ *
+ * \param hook  Hook, NULL to remove it
+ * \param arg   Argument passed to the hook
+ */
+void HostSim_setRxSubmitHook(Enet_MacPort macPort, HostSim_Isr hook, void *arg);
+
+/*!
+ * \brief Complete up to \c count held TX packets of a port.
+ *
+ * \return Number of packets completed.
+ */
+uint32_t HostSim_completeTx(Enet_MacPort macPort, uint32_t count);
+
+/*!
+ * \brief Put a frame into the next free RX buffer of a port, as if it had
+ *        been received from the wire.
+ *
+ * \return 0 on success, -1 if no RX buffer was free.
+ */
+int HostSim_injectRx(Enet_MacPort macPort, const void *data, uint32_t len);
+
+/*!
+ * \brief Number of free RX buffers the driver has given to a port.
+ */
+uint32_t HostSim_rxFreeCount(Enet_MacPort macPort);
+
+/*!
+ * \brief Run the hardware for one step: the MDIO controller polls the
+ *        PHYs and runs one USERACCESS frame per user group, the DMA
+ *        completes and loops back the submitted frames, and the handlers
+ *        of the raised interrupts are called.
+ */
+void HostSim_poll(void);
+
+/*!
+ * \brief Start or stop a thread calling HostSim_poll() every
+ *        \c periodUs microseconds.
+ */
+void HostSim_startHw(uint32_t periodUs);
+void HostSim_stopHw(void);
+
+/*!
+ * \brief Move the clock seen through TimerP_getTimeInUsecs() forward.
+ */
+void HostSim_advanceTime(uint64_t us);
+
+/*!
+ * \brief Set how long auto-negotiation takes before the link comes up.
+ *        0, the default, completes it at once.
+ */
+void HostSim_setAnegTime(uint32_t us);
+
+/*!
+ * \brief Set the core id EnetSoc_getCoreId() returns to the calling
+ *        thread.
+ */
+void HostSim_setCoreId(uint32_t coreId);
+
+/*!
+ * \brief Get or clear the counters.
+ */
+void HostSim_getStats(HostSim_Stats *stats);
+void HostSim_resetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_SIM_H_ */
@@ -0,0 +1,1329 @@
+/**
+ * @file host_sim.c
+ * @brief Host simulation of the hardware around the LAN8720 driver
+ *
+ * Implements the PDK services the driver uses on top of POSIX threads and
+ * an in-memory model of the LAN8720, the MDIO controller and a loopback
+ * DMA. See host_sim.h.
+ */
+
+/* ========================================================================== */
+/*                             Include Files                                  */
+/* ========================================================================== */
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <ti/drv/enet/enet.h>
+#include <ti/drv/enet/include/phy/enetphy.h>
+#include <ti/csl/cslr_mdio.h>
+#include <ti/osal/SemaphoreP.h>
+#include <ti/osal/TaskP.h>
+#include <ti/osal/TimerP.h>
+#include "enetphy_priv.h"
+#include "host_sim.h"
+
+/* ========================================================================== */
+/*                           Macros & Typedefs                                */
+/* ========================================================================== */
+
+/* Clause 22 registers and bits of the LAN8720 the model implements */
+#define SIM_BMCR                (0x00U)
+#define SIM_BMCR_RESET          (1U << 15)
+#define SIM_BMCR_SPEED_SEL      (1U << 13)
+#define SIM_BMCR_ANEG_ENABLE    (1U << 12)
+#define SIM_BMCR_RESTART_ANEG   (1U << 9)
+#define SIM_BMCR_DUPLEX         (1U << 8)
+#define SIM_BMSR                (0x01U)
+#define SIM_BMSR_CAPS           (0x7809U)
+#define SIM_BMSR_ANEG_COMPLETE  (1U << 5)
+#define SIM_BMSR_LINK           (1U << 2)
+#define SIM_PHYID1              (0x02U)
+#define SIM_PHYID2              (0x03U)
+#define SIM_ANAR                (0x04U)
+#define SIM_ANLPAR              (0x05U)
+#define SIM_ABILITY_MASK        (0x01E0U)
+#define SIM_ABILITY_100FD       (1U << 8)
+#define SIM_ABILITY_100HD       (1U << 7)
+#define SIM_ABILITY_10FD        (1U << 6)
+#define SIM_MODE_CTRL           (0x11U)
+#define SIM_MODE_CTRL_MDPREBP   (1U << 10)
+#define SIM_SPECIAL_MODES       (0x12U)
+#define SIM_INT_SOURCE          (0x1DU)
+#define SIM_INT_LINK_DOWN       (1U << 4)
+#define SIM_INT_ANEG_DONE       (1U << 6)
+#define SIM_INT_ENERGYON        (1U << 7)
+#define SIM_INT_MASK            (0x1EU)
+#define SIM_SCS                 (0x1FU)
+#define SIM_SCS_SWRESET         (1U << 15)
+#define SIM_SCS_SWRESTART       (1U << 14)
+#define SIM_SCS_AUTODONE        (1U << 12)
+#define SIM_SCS_FULL_DUPLEX     (1U << 4)
+#define SIM_SCS_SPEED_100       (1U << 3)
+#define SIM_SCS_STATUS_MASK     (SIM_SCS_SWRESET | SIM_SCS_SWRESTART | SIM_SCS_AUTODONE | \
+                                 SIM_SCS_FULL_DUPLEX | SIM_SCS_SPEED_100)
+
+#define SIM_EXT_REG_NUM         (0x400U)
+
+/* Byte offsets of the MDIO controller registers with side effects */
+#define SIM_MDIO_OFF(field)     ((uintptr_t)offsetof(CSL_mdioRegs, field))
+
+typedef struct
+{
+    bool present;
+    bool cable;
+    bool linkUp;
+    bool anegDone;
+    bool nintRaised;
+    uint64_t anegDueUs;
+    uint16_t partner;
+    uint16_t resolved;
+    uint16_t reg[32];
+    uint16_t ext[SIM_EXT_REG_NUM];
+    uint16_t mmdCr;
+    uint16_t mmdAddr;
+    uint32_t frames;
+} HostSim_Phy;
+
+typedef struct
+{
+    EnetDma_PktQ rxFree;
+    EnetDma_PktQ rxDone;
+    EnetDma_PktQ txHw;
+    EnetDma_PktQ txDone;
+    bool loopback;
+    bool holdTx;
+    bool rxEvent;
+    bool rxRaised;
+    bool txRaised;
+    HostSim_Isr rxSubmitHook;
+    void *rxSubmitArg;
+} HostSim_Port;
+
+typedef struct
+{
+    HostSim_Isr isr;
+    void *arg;
+} HostSim_IsrEntry;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t maxCount;
+} HostSim_Sem;
+
+struct Enet_Obj_s
+{
+    uint32_t id;
+};
+
+/* ========================================================================== */
+/*                            Global Variables                                */
+/* ========================================================================== */
+
+/* Stands for the interrupt enable of the simulated core */
+static pthread_mutex_t simLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static HostSim_Phy simPhy[HOSTSIM_PHY_ADDR_NUM];
+static EnetPhy_Obj simPhyObj[HOSTSIM_PHY_ADDR_NUM];
+static HostSim_Port simPort[HOSTSIM_PORT_NUM];
+static HostSim_IsrEntry simIsr[HOSTSIM_IRQ_NUM][HOSTSIM_PHY_ADDR_NUM];
+static HostSim_Stats simStats;
+
+static CSL_mdioRegs simMdio;
+static uint32_t simMdioLinkIntMask;
+static uint32_t simMdioUserIntMask;
+static bool simMdioMonLink[2];
+
+static struct Enet_Obj_s simEnet;
+static uint64_t simTimeOffsetUs;
+static uint32_t simAnegUs;
+static __thread uint32_t simCoreId;
+
+static pthread_t simHwThread;
+static volatile bool simHwRun;
+static uint32_t simHwPeriodUs;
+
+/* ========================================================================== */
+/*                          PHY Register Model                                */
+/* ========================================================================== */
+
+/**
+ *  \brief Resolves the link of a PHY after a cable, partner or control
+ *  change and raises the matching interrupt sources.
+ */
+static void HostSim_phyLink(HostSim_Phy *phy, bool restartAneg)
+{
+    uint16_t bmcr = phy->reg[SIM_BMCR];
+    uint16_t common;
+    bool wasUp = phy->linkUp;
+    bool up = phy->cable;
+
+    phy->resolved = 0U;
+    phy->anegDone = false;
+    if ((bmcr & SIM_BMCR_ANEG_ENABLE) != 0U)
+    {
+        if (restartAneg)
+        {
+            simStats.anegRestarts++;
+            if (wasUp)
+            {
+                /* Negotiating takes the link down */
+                phy->reg[SIM_INT_SOURCE] |= SIM_INT_LINK_DOWN;
+            }
+            wasUp = false;
+        }
+        common = phy->reg[SIM_ANAR] & phy->partner & SIM_ABILITY_MASK;
+        up = up && (common != 0U);
+        if (!up || restartAneg)
+        {
+            phy->anegDueUs = 0U;
+        }
+        if (up && !wasUp && (simAnegUs > 0U))
+        {
+            /* Negotiation runs for a while, finished by HostSim_poll() */
+            if (phy->anegDueUs == 0U)
+            {
+                phy->anegDueUs = TimerP_getTimeInUsecs() + simAnegUs;
+            }
+            if (TimerP_getTimeInUsecs() < phy->anegDueUs)
+            {
+                up = false;
+            }
+            else
+            {
+                phy->anegDueUs = 0U;
+            }
+        }
+        if (up)
+        {
+            /* Highest common mode */
+            if ((common & (SIM_ABILITY_100FD | SIM_ABILITY_100HD)) != 0U)
+            {
+                phy->resolved |= SIM_SCS_SPEED_100;
+                phy->resolved |= ((common & SIM_ABILITY_100FD) != 0U) ? SIM_SCS_FULL_DUPLEX : 0U;
+            }
+            else if ((common & SIM_ABILITY_10FD) != 0U)
+            {
+                phy->resolved |= SIM_SCS_FULL_DUPLEX;
+            }
+            phy->resolved |= SIM_SCS_AUTODONE;
+            phy->anegDone = true;
+        }
+    }
+    else if (up)
+    {
+        if ((bmcr & SIM_BMCR_SPEED_SEL) != 0U)
+        {
+            phy->resolved |= SIM_SCS_SPEED_100;
+        }
+        if ((bmcr & SIM_BMCR_DUPLEX) != 0U)
+        {
+            phy->resolved |= SIM_SCS_FULL_DUPLEX;
+        }
+    }
+
+    phy->linkUp = up;
+    if (wasUp && !up)
+    {
+        phy->reg[SIM_INT_SOURCE] |= SIM_INT_LINK_DOWN;
+    }
+    if (!wasUp && up && phy->anegDone)
+    {
+        phy->reg[SIM_INT_SOURCE] |= SIM_INT_ANEG_DONE;
+    }
+}
+
+/**
+ *  \brief Puts a PHY in its power-on register state, keeping the cable and
+ *  the partner.
+ */
+static void HostSim_phyReset(HostSim_Phy *phy, uint32_t phyAddr)
+{
+    memset(phy->reg, 0, sizeof(phy->reg));
+    memset(phy->ext, 0, sizeof(phy->ext));
+    phy->reg[SIM_BMCR] = SIM_BMCR_SPEED_SEL | SIM_BMCR_ANEG_ENABLE | SIM_BMCR_DUPLEX;
+    phy->reg[SIM_PHYID1] = 0x0007U;
+    phy->reg[SIM_PHYID2] = 0xC0F1U;
+    phy->reg[SIM_ANAR] = SIM_ABILITY_MASK | 0x0001U;
+    phy->reg[SIM_SPECIAL_MODES] = (uint16_t)(0x00E0U | phyAddr);
+    phy->reg[SIM_SCS] = 0x0040U;
+    phy->mmdCr = 0U;
+    phy->mmdAddr = 0U;
+    phy->linkUp = false;
+    phy->nintRaised = false;
+    HostSim_phyLink(phy, false);
+    /* Interrupt sources of the link coming back are not reported after a
+     * reset, the mask is cleared anyway */
+    phy->reg[SIM_INT_SOURCE] = 0U;
+}
+
+static uint16_t HostSim_phyRead(HostSim_Phy *phy, uint32_t reg)
+{
+    uint16_t val;
+
+    switch (reg)
+    {
+        case SIM_BMSR:
+            val = SIM_BMSR_CAPS;
+            val |= phy->linkUp ? SIM_BMSR_LINK : 0U;
+            val |= phy->anegDone ? SIM_BMSR_ANEG_COMPLETE : 0U;
+            break;
+
+        case SIM_ANLPAR:
+            val = phy->anegDone ? phy->partner : 0U;
+            break;
+
+        case SIM_INT_SOURCE:
+            /* Cleared on read, which also deasserts nINT */
+            val = phy->reg[SIM_INT_SOURCE];
+            phy->reg[SIM_INT_SOURCE] = 0U;
+            phy->nintRaised = false;
+            break;
+
+        case SIM_SCS:
+            val = (phy->reg[SIM_SCS] & ~SIM_SCS_STATUS_MASK) | phy->resolved;
+            break;
+
+        case PHY_MMD_DR:
+            if ((phy->mmdCr & MMD_CR_FUNC_MASK) == MMD_CR_ADDR)
+            {
+                val = phy->mmdAddr;
+            }
+            else
+            {
+                val = phy->ext[phy->mmdAddr % SIM_EXT_REG_NUM];
+                if ((phy->mmdCr & MMD_CR_FUNC_MASK) == MMD_CR_DATA_POSTINC_RW)
+                {
+                    phy->mmdAddr++;
+                }
+            }
+            break;
+
+        default:
+            val = phy->reg[reg & 0x1FU];
+            break;
+    }
+    return val;
+}
+
+static void HostSim_phyWrite(HostSim_Phy *phy, uint32_t phyAddr, uint32_t reg, uint16_t val)
+{
+    uint16_t old;
+
+    switch (reg)
+    {
+        case SIM_BMCR:
+            if ((val & SIM_BMCR_RESET) != 0U)
+            {
+                simStats.phyResets++;
+                HostSim_phyReset(phy, phyAddr);
+                break;
+            }
+            old = phy->reg[SIM_BMCR];
+            phy->reg[SIM_BMCR] = val & ~SIM_BMCR_RESTART_ANEG;
+            HostSim_phyLink(phy, ((val & SIM_BMCR_ANEG_ENABLE) != 0U) &&
+                                 (((val & SIM_BMCR_RESTART_ANEG) != 0U) ||
+                                  ((old & SIM_BMCR_ANEG_ENABLE) == 0U)));
+            break;
+
+        case SIM_BMSR:
+        case SIM_PHYID1:
+        case SIM_PHYID2:
+        case SIM_ANLPAR:
+        case SIM_INT_SOURCE:
+            break;
+
+        case SIM_SCS:
+            if ((val & SIM_SCS_SWRESET) != 0U)
+            {
+                simStats.phyResets++;
+                HostSim_phyReset(phy, phyAddr);
+                break;
+            }
+            phy->reg[SIM_SCS] = val & ~SIM_SCS_STATUS_MASK;
+            if ((val & SIM_SCS_SWRESTART) != 0U)
+            {
+                HostSim_phyLink(phy, true);
+            }
+            break;
+
+        case PHY_MMD_CR:
+            phy->mmdCr = val;
+            break;
+
+        case PHY_MMD_DR:
+            if ((phy->mmdCr & MMD_CR_FUNC_MASK) == MMD_CR_ADDR)
+            {
+                phy->mmdAddr = val;
+            }
+            else
+            {
+                phy->ext[phy->mmdAddr % SIM_EXT_REG_NUM] = val;
+                if ((phy->mmdCr & MMD_CR_FUNC_MASK) != MMD_CR_DATA_NOPOSTINC)
+                {
+                    phy->mmdAddr++;
+                }
+            }
+            break;
+
+        default:
+            phy->reg[reg & 0x1FU] = val;
+            break;
+    }
+}
+
+static bool HostSim_isMmdReg(uint32_t reg)
+{
+    return ((reg & 0x1FU) == PHY_MMD_CR) || ((reg & 0x1FU) == PHY_MMD_DR);
+}
+
+/**
+ *  \brief Runs one MDIO read frame as issued by software.
+ */
+static int32_t HostSim_mdioRead(uint32_t phyAddr, uint32_t reg, uint16_t *val)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    simStats.mdioReads++;
+    simStats.mmdFrames += HostSim_isMmdReg(reg) ? 1U : 0U;
+    phy->frames++;
+    /* Without preamble only a PHY with the bypass bit set answers */
+    if (!phy->present ||
+        (((simMdio.CONTROL_REG & CSL_MDIO_CONTROL_REG_PREAMBLE_MASK) != 0U) &&
+         ((phy->reg[SIM_MODE_CTRL] & SIM_MODE_CTRL_MDPREBP) == 0U)))
+    {
+        simStats.mdioErrors++;
+        *val = 0xFFFFU;
+        return ENETPHY_EFAIL;
+    }
+    *val = HostSim_phyRead(phy, reg & 0x1FU);
+    return ENETPHY_SOK;
+}
+
+/**
+ *  \brief Runs one MDIO write frame as issued by software.
+ */
+static int32_t HostSim_mdioWrite(uint32_t phyAddr, uint32_t reg, uint16_t val)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    simStats.mdioWrites++;
+    simStats.mmdFrames += HostSim_isMmdReg(reg) ? 1U : 0U;
+    phy->frames++;
+    if (!phy->present ||
+        (((simMdio.CONTROL_REG & CSL_MDIO_CONTROL_REG_PREAMBLE_MASK) != 0U) &&
+         ((phy->reg[SIM_MODE_CTRL] & SIM_MODE_CTRL_MDPREBP) == 0U)))
+    {
+        return ENETPHY_EFAIL;
+    }
+    HostSim_phyWrite(phy, phyAddr, reg & 0x1FU, val);
+    return ENETPHY_SOK;
+}
+
+/* ========================================================================== */
+/*                         MDIO Controller Model                              */
+/* ========================================================================== */
+
+static bool HostSim_monLink(uint32_t group)
+{
+    uint32_t sel = simMdio.USER_GROUP[group].USER_PHY_SEL_REG;
+
+    return simPhy[sel & CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_PHYADR_MON_MASK].linkUp;
+}
+
+static void HostSim_mdioUpdateMasked(void)
+{
+    simMdio.LINK_INT_MASK_SET_REG = simMdioLinkIntMask;
+    simMdio.LINK_INT_MASK_CLEAR_REG = simMdioLinkIntMask;
+    simMdio.LINK_INT_MASKED_REG = simMdio.LINK_INT_RAW_REG & simMdioLinkIntMask;
+    simMdio.USER_INT_MASK_SET_REG = simMdioUserIntMask;
+    simMdio.USER_INT_MASK_CLEAR_REG = simMdioUserIntMask;
+    simMdio.USER_INT_MASKED_REG = simMdio.USER_INT_RAW_REG & simMdioUserIntMask;
+}
+
+void HostSim_regWrite32(volatile uint32_t *addr, uint32_t val)
+{
+    uintptr_t off = (uintptr_t)addr - (uintptr_t)&simMdio;
+    uint32_t g;
+
+    if (((uintptr_t)addr < (uintptr_t)&simMdio) || (off >= sizeof(simMdio)))
+    {
+        *addr = val;
+        return;
+    }
+
+    pthread_mutex_lock(&simLock);
+    if (off == SIM_MDIO_OFF(LINK_INT_RAW_REG))
+    {
+        simMdio.LINK_INT_RAW_REG &= ~val;
+    }
+    else if (off == SIM_MDIO_OFF(LINK_INT_MASK_SET_REG))
+    {
+        simMdioLinkIntMask |= val;
+    }
+    else if (off == SIM_MDIO_OFF(LINK_INT_MASK_CLEAR_REG))
+    {
+        simMdioLinkIntMask &= ~val;
+    }
+    else if (off == SIM_MDIO_OFF(USER_INT_RAW_REG))
+    {
+        simMdio.USER_INT_RAW_REG &= ~val;
+    }
+    else if (off == SIM_MDIO_OFF(USER_INT_MASK_SET_REG))
+    {
+        simMdioUserIntMask |= val;
+    }
+    else if (off == SIM_MDIO_OFF(USER_INT_MASK_CLEAR_REG))
+    {
+        simMdioUserIntMask &= ~val;
+    }
+    else
+    {
+        *addr = val;
+        for (g = 0U; g < 2U; g++)
+        {
+            if (off == SIM_MDIO_OFF(USER_GROUP[g].USER_PHY_SEL_REG))
+            {
+                /* Changes are reported from the newly selected PHY's state */
+                simMdioMonLink[g] = HostSim_monLink(g);
+            }
+        }
+    }
+    HostSim_mdioUpdateMasked();
+    pthread_mutex_unlock(&simLock);
+}
+
+/**
+ *  \brief Runs one polling round of the MDIO controller and one
+ *  USERACCESS frame per user group.
+ */
+static void HostSim_mdioStep(void)
+{
+    uint32_t alive = 0U, link = 0U;
+    uint32_t access, phyAddr, reg;
+    uint16_t val;
+    bool up;
+    uint32_t i, g;
+
+    for (i = 0U; i < HOSTSIM_PHY_ADDR_NUM; i++)
+    {
+        if (simPhy[i].present)
+        {
+            alive |= 1U << i;
+            link |= simPhy[i].linkUp ? (1U << i) : 0U;
+            simStats.mdioPollReads++;
+        }
+    }
+    simMdio.ALIVE_REG = alive;
+    simMdio.LINK_REG = link;
+
+    for (g = 0U; g < 2U; g++)
+    {
+        if ((simMdio.USER_GROUP[g].USER_PHY_SEL_REG &
+             CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKINT_ENABLE_MASK) != 0U)
+        {
+            up = HostSim_monLink(g);
+            if (up != simMdioMonLink[g])
+            {
+                simMdio.LINK_INT_RAW_REG |= 1U << g;
+            }
+            simMdioMonLink[g] = up;
+        }
+
+        access = simMdio.USER_GROUP[g].USER_ACCESS_REG;
+        if ((access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK) != 0U)
+        {
+            phyAddr = (access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_MASK) >>
+                      CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_SHIFT;
+            reg = (access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_MASK) >>
+                  CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_SHIFT;
+            access &= ~(CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK |
+                        CSL_MDIO_USER_GROUP_USER_ACCESS_REG_ACK_MASK);
+            if ((access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_WRITE_MASK) != 0U)
+            {
+                HostSim_mdioWrite(phyAddr, reg,
+                                  (uint16_t)(access & CSL_MDIO_USER_GROUP_USER_ACCESS_REG_DATA_MASK));
+            }
+            else if (HostSim_mdioRead(phyAddr, reg, &val) == ENETPHY_SOK)
+            {
+                access = (access & ~CSL_MDIO_USER_GROUP_USER_ACCESS_REG_DATA_MASK) |
+                         CSL_MDIO_USER_GROUP_USER_ACCESS_REG_ACK_MASK | val;
+            }
+            simMdio.USER_GROUP[g].USER_ACCESS_REG = access;
+            simMdio.USER_INT_RAW_REG |= 1U << g;
+        }
+    }
+    HostSim_mdioUpdateMasked();
+}
+
+/* ========================================================================== */
+/*                              DMA Model                                     */
+/* ========================================================================== */
+
+/**
+ *  \brief Sends one TX packet to the wire and, with the loopback, back
+ *  into the next free RX buffer.
+ */
+static void HostSim_txOne(HostSim_Port *port, EnetDma_Pkt *pkt)
+{
+    EnetDma_Pkt *rxPkt;
+    uint32_t len = pkt->userBufLen;
+
+    simStats.txFrames++;
+    simStats.txBytes += len;
+    if (port->loopback)
+    {
+        rxPkt = (EnetDma_Pkt *)EnetQueue_deq(&port->rxFree);
+        if (rxPkt != NULL)
+        {
+            if (len > rxPkt->orgBufLen)
+            {
+                len = rxPkt->orgBufLen;
+            }
+            memcpy(rxPkt->bufPtr, pkt->bufPtr, len);
+            rxPkt->userBufLen = len;
+            EnetQueue_enq(&port->rxDone, &rxPkt->node);
+            port->rxRaised = true;
+            simStats.rxFrames++;
+        }
+        else
+        {
+            simStats.rxNoBuf++;
+        }
+    }
+    EnetQueue_enq(&port->txDone, &pkt->node);
+    port->txRaised = true;
+}
+
+static bool HostSim_raise(HostSim_Irq irq, uint32_t idx)
+{
+    HostSim_IsrEntry *entry = &simIsr[irq][idx];
+
+    if (entry->isr == NULL)
+    {
+        return false;
+    }
+    simStats.irqs[irq]++;
+    entry->isr(entry->arg);
+    return true;
+}
+
+/* ========================================================================== */
+/*                        Simulation Control API                              */
+/* ========================================================================== */
+
+void HostSim_init(void)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&simLock);
+    memset(simPhy, 0, sizeof(simPhy));
+    memset(simIsr, 0, sizeof(simIsr));
+    memset(&simStats, 0, sizeof(simStats));
+    memset(&simMdio, 0, sizeof(simMdio));
+    simMdio.VERSION_REG = 0x00070104U;
+    simMdioLinkIntMask = 0U;
+    simMdioUserIntMask = 0U;
+    simMdioMonLink[0] = false;
+    simMdioMonLink[1] = false;
+    for (i = 0U; i < HOSTSIM_PORT_NUM; i++)
+    {
+        EnetQueue_initQ(&simPort[i].rxFree);
+        EnetQueue_initQ(&simPort[i].rxDone);
+        EnetQueue_initQ(&simPort[i].txHw);
+        EnetQueue_initQ(&simPort[i].txDone);
+        simPort[i].loopback = true;
+        simPort[i].holdTx = false;
+        simPort[i].rxSubmitHook = NULL;
+        simPort[i].rxEvent = true;
+        simPort[i].rxRaised = false;
+        simPort[i].txRaised = false;
+    }
+    simTimeOffsetUs = 0U;
+    simAnegUs = 0U;
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_addPhy(uint32_t phyAddr)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    pthread_mutex_lock(&simLock);
+    memset(phy, 0, sizeof(*phy));
+    phy->present = true;
+    phy->partner = SIM_ABILITY_MASK | 0x0001U;
+    HostSim_phyReset(phy, phyAddr);
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_setLink(uint32_t phyAddr, bool up)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    pthread_mutex_lock(&simLock);
+    if (up && !phy->cable)
+    {
+        phy->reg[SIM_INT_SOURCE] |= SIM_INT_ENERGYON;
+    }
+    phy->cable = up;
+    HostSim_phyLink(phy, false);
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_setPartner(uint32_t phyAddr, uint16_t anlpar)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    pthread_mutex_lock(&simLock);
+    phy->partner = anlpar;
+    pthread_mutex_unlock(&simLock);
+}
+
+uint16_t HostSim_getReg(uint32_t phyAddr, uint32_t reg)
+{
+    HostSim_Phy *phy = &simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM];
+    uint16_t val;
+
+    pthread_mutex_lock(&simLock);
+    /* Peeking must not clear the interrupt source */
+    val = (reg == SIM_INT_SOURCE) ? phy->reg[SIM_INT_SOURCE] : HostSim_phyRead(phy, reg & 0x1FU);
+    pthread_mutex_unlock(&simLock);
+    return val;
+}
+
+void HostSim_setReg(uint32_t phyAddr, uint32_t reg, uint16_t val)
+{
+    pthread_mutex_lock(&simLock);
+    simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM].reg[reg & 0x1FU] = val;
+    pthread_mutex_unlock(&simLock);
+}
+
+uint16_t HostSim_getExtReg(uint32_t phyAddr, uint32_t reg)
+{
+    return simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM].ext[reg % SIM_EXT_REG_NUM];
+}
+
+void HostSim_setExtReg(uint32_t phyAddr, uint32_t reg, uint16_t val)
+{
+    simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM].ext[reg % SIM_EXT_REG_NUM] = val;
+}
+
+uint32_t HostSim_getPhyFrames(uint32_t phyAddr)
+{
+    return simPhy[phyAddr % HOSTSIM_PHY_ADDR_NUM].frames;
+}
+
+CSL_mdioRegs *HostSim_mdioRegs(void)
+{
+    return &simMdio;
+}
+
+Enet_Handle HostSim_enet(void)
+{
+    return &simEnet;
+}
+
+void HostSim_setIsr(HostSim_Irq irq, uint32_t idx, HostSim_Isr isr, void *arg)
+{
+    pthread_mutex_lock(&simLock);
+    simIsr[irq][idx % HOSTSIM_PHY_ADDR_NUM].isr = isr;
+    simIsr[irq][idx % HOSTSIM_PHY_ADDR_NUM].arg = arg;
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_setLoopback(Enet_MacPort macPort, bool enable)
+{
+    simPort[macPort % HOSTSIM_PORT_NUM].loopback = enable;
+}
+
+void HostSim_holdTx(Enet_MacPort macPort, bool hold)
+{
+    simPort[macPort % HOSTSIM_PORT_NUM].holdTx = hold;
+}
+
+void HostSim_setRxSubmitHook(Enet_MacPort macPort, HostSim_Isr hook, void *arg)
+{
+    simPort[macPort % HOSTSIM_PORT_NUM].rxSubmitArg = arg;
+    simPort[macPort % HOSTSIM_PORT_NUM].rxSubmitHook = hook;
+}
+
+uint32_t HostSim_completeTx(Enet_MacPort macPort, uint32_t count)
+{
+    HostSim_Port *port = &simPort[macPort % HOSTSIM_PORT_NUM];
+    EnetDma_Pkt *pkt;
+    uint32_t done = 0U;
+
+    pthread_mutex_lock(&simLock);
+    while (done < count)
+    {
+        pkt = (EnetDma_Pkt *)EnetQueue_deq(&port->txHw);
+        if (pkt == NULL)
+        {
+            break;
+        }
+        HostSim_txOne(port, pkt);
+        done++;
+    }
+    pthread_mutex_unlock(&simLock);
+    return done;
+}
+
+int HostSim_injectRx(Enet_MacPort macPort, const void *data, uint32_t len)
+{
+    HostSim_Port *port = &simPort[macPort % HOSTSIM_PORT_NUM];
+    EnetDma_Pkt *pkt;
+    int ret = -1;
+
+    pthread_mutex_lock(&simLock);
+    pkt = (EnetDma_Pkt *)EnetQueue_deq(&port->rxFree);
+    if (pkt != NULL)
+    {
+        if (len > pkt->orgBufLen)
+        {
+            len = pkt->orgBufLen;
+        }
+        memcpy(pkt->bufPtr, data, len);
+        pkt->userBufLen = len;
+        EnetQueue_enq(&port->rxDone, &pkt->node);
+        port->rxRaised = true;
+        simStats.rxFrames++;
+        ret = 0;
+    }
+    else
+    {
+        simStats.rxNoBuf++;
+    }
+    pthread_mutex_unlock(&simLock);
+    return ret;
+}
+
+uint32_t HostSim_rxFreeCount(Enet_MacPort macPort)
+{
+    uint32_t count;
+
+    pthread_mutex_lock(&simLock);
+    count = EnetQueue_getQCount(&simPort[macPort % HOSTSIM_PORT_NUM].rxFree);
+    pthread_mutex_unlock(&simLock);
+    return count;
+}
+
+void HostSim_poll(void)
+{
+    HostSim_Port *port;
+    HostSim_Phy *phy;
+    EnetDma_Pkt *pkt;
+    bool nint;
+    uint32_t i;
+
+    pthread_mutex_lock(&simLock);
+    for (i = 0U; i < HOSTSIM_PHY_ADDR_NUM; i++)
+    {
+        phy = &simPhy[i];
+        if (phy->present && (phy->anegDueUs != 0U) && (TimerP_getTimeInUsecs() >= phy->anegDueUs))
+        {
+            HostSim_phyLink(phy, false);
+        }
+    }
+    HostSim_mdioStep();
+
+    for (i = 0U; i < HOSTSIM_PORT_NUM; i++)
+    {
+        port = &simPort[i];
+        while (!port->holdTx &&
+               ((pkt = (EnetDma_Pkt *)EnetQueue_deq(&port->txHw)) != NULL))
+        {
+            HostSim_txOne(port, pkt);
+        }
+    }
+
+    /* Interrupts, with the handlers run as by the interrupt controller */
+    for (i = 0U; i < HOSTSIM_PHY_ADDR_NUM; i++)
+    {
+        phy = &simPhy[i];
+        nint = phy->present && ((phy->reg[SIM_INT_SOURCE] & phy->reg[SIM_INT_MASK]) != 0U);
+        if (!nint)
+        {
+            phy->nintRaised = false;
+        }
+        else if (!phy->nintRaised)
+        {
+            /* Level triggered: a line asserted before its handler was
+             * connected is delivered once it is */
+            phy->nintRaised = HostSim_raise(HOSTSIM_IRQ_PHY, i);
+        }
+    }
+    if (simMdio.LINK_INT_MASKED_REG != 0U)
+    {
+        HostSim_raise(HOSTSIM_IRQ_MDIO_LINK, 0U);
+    }
+    if (simMdio.USER_INT_MASKED_REG != 0U)
+    {
+        HostSim_raise(HOSTSIM_IRQ_MDIO_USER, 0U);
+    }
+    for (i = 0U; i < HOSTSIM_PORT_NUM; i++)
+    {
+        port = &simPort[i];
+        if (port->txRaised)
+        {
+            port->txRaised = false;
+            HostSim_raise(HOSTSIM_IRQ_DMA_TX, i);
+        }
+        if (port->rxRaised && port->rxEvent)
+        {
+            port->rxRaised = false;
+            HostSim_raise(HOSTSIM_IRQ_DMA_RX, i);
+        }
+    }
+    pthread_mutex_unlock(&simLock);
+}
+
+static void *HostSim_hwMain(void *arg)
+{
+    (void)arg;
+    while (simHwRun)
+    {
+        HostSim_poll();
+        usleep(simHwPeriodUs);
+    }
+    return NULL;
+}
+
+void HostSim_startHw(uint32_t periodUs)
+{
+    if (!simHwRun)
+    {
+        simHwPeriodUs = periodUs;
+        simHwRun = true;
+        pthread_create(&simHwThread, NULL, HostSim_hwMain, NULL);
+    }
+}
+
+void HostSim_stopHw(void)
+{
+    if (simHwRun)
+    {
+        simHwRun = false;
+        pthread_join(simHwThread, NULL);
+    }
+}
+
+void HostSim_advanceTime(uint64_t us)
+{
+    __atomic_fetch_add(&simTimeOffsetUs, us, __ATOMIC_RELAXED);
+}
+
+void HostSim_setAnegTime(uint32_t us)
+{
+    pthread_mutex_lock(&simLock);
+    simAnegUs = us;
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_setCoreId(uint32_t coreId)
+{
+    simCoreId = coreId;
+}
+
+void HostSim_getStats(HostSim_Stats *stats)
+{
+    pthread_mutex_lock(&simLock);
+    *stats = simStats;
+    pthread_mutex_unlock(&simLock);
+}
+
+void HostSim_resetStats(void)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&simLock);
+    memset(&simStats, 0, sizeof(simStats));
+    for (i = 0U; i < HOSTSIM_PHY_ADDR_NUM; i++)
+    {
+        simPhy[i].frames = 0U;
+    }
+    pthread_mutex_unlock(&simLock);
+}
+
+/* ========================================================================== */
+/*                          Enet LLD Stand-ins                                */
+/* ========================================================================== */
+
+void Enet_init(void)
+{
+}
+
+int32_t Enet_open(Enet_Handle hEnet, Enet_IoctlPrms *prms)
+{
+    (void)hEnet;
+    (void)prms;
+    return ENET_SOK;
+}
+
+int32_t Enet_ioctl(Enet_Handle hEnet, uint32_t cmd, void *arg, Enet_IoctlPrms *prms)
+{
+    (void)hEnet;
+    (void)cmd;
+    (void)arg;
+    (void)prms;
+    return ENET_SOK;
+}
+
+EnetDma_Pkt *EnetDma_allocPkt(Enet_Handle hEnet, uint32_t dir)
+{
+    EnetDma_Pkt *pkt = calloc(1U, sizeof(*pkt));
+
+    (void)hEnet;
+    (void)dir;
+    if (pkt != NULL)
+    {
+        pkt->bufPtr = calloc(1U, HOSTSIM_PKT_BUF_SIZE);
+        pkt->orgBufLen = HOSTSIM_PKT_BUF_SIZE;
+        if (pkt->bufPtr == NULL)
+        {
+            free(pkt);
+            pkt = NULL;
+        }
+    }
+    return pkt;
+}
+
+void EnetDma_freePkt(Enet_Handle hEnet, EnetDma_Pkt *pkt)
+{
+    (void)hEnet;
+    if (pkt != NULL)
+    {
+        free(pkt->bufPtr);
+        free(pkt);
+    }
+}
+
+int32_t EnetDma_submitTxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ)
+{
+    (void)hEnet;
+    pthread_mutex_lock(&simLock);
+    EnetQueue_append(&simPort[macPort % HOSTSIM_PORT_NUM].txHw, pktQ);
+    EnetQueue_initQ(pktQ);
+    pthread_mutex_unlock(&simLock);
+    return ENET_SOK;
+}
+
+int32_t EnetDma_retrieveTxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ)
+{
+    HostSim_Port *port = &simPort[macPort % HOSTSIM_PORT_NUM];
+
+    (void)hEnet;
+    pthread_mutex_lock(&simLock);
+    EnetQueue_append(pktQ, &port->txDone);
+    EnetQueue_initQ(&port->txDone);
+    pthread_mutex_unlock(&simLock);
+    return ENET_SOK;
+}
+
+int32_t EnetDma_submitRxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ)
+{
+    HostSim_Port *port = &simPort[macPort % HOSTSIM_PORT_NUM];
+
+    (void)hEnet;
+    pthread_mutex_lock(&simLock);
+    EnetQueue_append(&port->rxFree, pktQ);
+    EnetQueue_initQ(pktQ);
+    pthread_mutex_unlock(&simLock);
+    if (port->rxSubmitHook != NULL)
+    {
+        port->rxSubmitHook(port->rxSubmitArg);
+    }
+    return ENET_SOK;
+}
+
+int32_t EnetDma_retrieveRxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ)
+{
+    HostSim_Port *port = &simPort[macPort % HOSTSIM_PORT_NUM];
+
+    (void)hEnet;
+    pthread_mutex_lock(&simLock);
+    EnetQueue_append(pktQ, &port->rxDone);
+    EnetQueue_initQ(&port->rxDone);
+    pthread_mutex_unlock(&simLock);
+    return ENET_SOK;
+}
+
+int32_t EnetDma_enableRxEvent(Enet_Handle hEnet, Enet_MacPort macPort)
+{
+    (void)hEnet;
+    simPort[macPort % HOSTSIM_PORT_NUM].rxEvent = true;
+    return ENET_SOK;
+}
+
+int32_t EnetDma_disableRxEvent(Enet_Handle hEnet, Enet_MacPort macPort)
+{
+    (void)hEnet;
+    simPort[macPort % HOSTSIM_PORT_NUM].rxEvent = false;
+    return ENET_SOK;
+}
+
+void EnetQueue_initQ(EnetDma_PktQ *queue)
+{
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->count = 0U;
+}
+
+void EnetQueue_enq(EnetDma_PktQ *queue, EnetQ_Node *node)
+{
+    node->next = NULL;
+    if (queue->tail != NULL)
+    {
+        queue->tail->next = node;
+    }
+    else
+    {
+        queue->head = node;
+    }
+    queue->tail = node;
+    queue->count++;
+}
+
+void EnetQueue_enqHead(EnetDma_PktQ *queue, EnetQ_Node *node)
+{
+    node->next = queue->head;
+    queue->head = node;
+    if (queue->tail == NULL)
+    {
+        queue->tail = node;
+    }
+    queue->count++;
+}
+
+EnetQ_Node *EnetQueue_deq(EnetDma_PktQ *queue)
+{
+    EnetQ_Node *node = queue->head;
+
+    if (node != NULL)
+    {
+        queue->head = node->next;
+        if (queue->head == NULL)
+        {
+            queue->tail = NULL;
+        }
+        queue->count--;
+        node->next = NULL;
+    }
+    return node;
+}
+
+uint32_t EnetQueue_getQCount(EnetDma_PktQ *queue)
+{
+    return queue->count;
+}
+
+void EnetQueue_append(EnetDma_PktQ *dst, EnetDma_PktQ *src)
+{
+    if (src->head == NULL)
+    {
+        return;
+    }
+    if (dst->tail != NULL)
+    {
+        dst->tail->next = src->head;
+    }
+    else
+    {
+        dst->head = src->head;
+    }
+    dst->tail = src->tail;
+    dst->count += src->count;
+}
+
+uintptr_t EnetOsal_disableAllIntr(void)
+{
+    pthread_mutex_lock(&simLock);
+    return 0U;
+}
+
+void EnetOsal_restoreAllIntr(uintptr_t key)
+{
+    (void)key;
+    pthread_mutex_unlock(&simLock);
+}
+
+void EnetOsal_sleep(uint32_t ms)
+{
+    usleep(ms * 1000U);
+}
+
+uint32_t EnetSoc_getCoreId(void)
+{
+    return simCoreId;
+}
+
+/* ========================================================================== */
+/*                          EnetPhy Stand-ins                                 */
+/* ========================================================================== */
+
+EnetPhy_Handle EnetPhy_open(Enet_Handle hEnet, Enet_MacPort macPort, const EnetPhy_Cfg *cfg)
+{
+    EnetPhy_Obj *obj = &simPhyObj[cfg->phyAddr % HOSTSIM_PHY_ADDR_NUM];
+
+    (void)hEnet;
+    (void)macPort;
+    obj->addr = cfg->phyAddr;
+    return obj;
+}
+
+void EnetPhy_setExtendedCfg(EnetPhy_Cfg *phyCfg, const void *extendedCfg, uint32_t extendedCfgSize)
+{
+    phyCfg->extendedCfg = extendedCfg;
+    phyCfg->extendedCfgSize = extendedCfgSize;
+}
+
+int32_t EnetPhy_readReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val)
+{
+    int32_t status;
+
+    pthread_mutex_lock(&simLock);
+    status = HostSim_mdioRead(hPhy->addr, reg, val);
+    pthread_mutex_unlock(&simLock);
+    return status;
+}
+
+int32_t EnetPhy_writeReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val)
+{
+    int32_t status;
+
+    pthread_mutex_lock(&simLock);
+    status = HostSim_mdioWrite(hPhy->addr, reg, val);
+    pthread_mutex_unlock(&simLock);
+    return status;
+}
+
+/* ========================================================================== */
+/*                            OSAL Stand-ins                                  */
+/* ========================================================================== */
+
+void SemaphoreP_Params_init(SemaphoreP_Params *params)
+{
+    params->name = NULL;
+    params->mode = SemaphoreP_Mode_COUNTING;
+    params->maxCount = UINT32_MAX;
+}
+
+SemaphoreP_Handle SemaphoreP_create(uint32_t count, const SemaphoreP_Params *params)
+{
+    HostSim_Sem *sem = calloc(1U, sizeof(*sem));
+    pthread_condattr_t attr;
+
+    if (sem == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sem->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    sem->maxCount = ((params != NULL) && (params->mode == SemaphoreP_Mode_BINARY)) ?
+                    1U : UINT32_MAX;
+    sem->count = (count > sem->maxCount) ? sem->maxCount : count;
+    return sem;
+}
+
+SemaphoreP_Status SemaphoreP_delete(SemaphoreP_Handle handle)
+{
+    HostSim_Sem *sem = (HostSim_Sem *)handle;
+
+    if (sem == NULL)
+    {
+        return SemaphoreP_FAILURE;
+    }
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+    return SemaphoreP_OK;
+}
+
+SemaphoreP_Status SemaphoreP_pend(SemaphoreP_Handle handle, uint32_t timeout)
+{
+    HostSim_Sem *sem = (HostSim_Sem *)handle;
+    SemaphoreP_Status status = SemaphoreP_OK;
+    struct timespec deadline;
+    int err = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout != SemaphoreP_WAIT_FOREVER)
+    {
+        deadline.tv_sec += timeout / 1000U;
+        deadline.tv_nsec += (long)(timeout % 1000U) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&sem->lock);
+    while ((sem->count == 0U) && (err != ETIMEDOUT))
+    {
+        if (timeout == SemaphoreP_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        }
+        else
+        {
+            err = pthread_cond_timedwait(&sem->cond, &sem->lock, &deadline);
+        }
+    }
+    if (sem->count > 0U)
+    {
+        sem->count--;
+    }
+    else
+    {
+        status = SemaphoreP_TIMEOUT;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return status;
+}
+
+SemaphoreP_Status SemaphoreP_post(SemaphoreP_Handle handle)
+{
+    HostSim_Sem *sem = (HostSim_Sem *)handle;
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->maxCount)
+    {
+        sem->count++;
+    }
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return SemaphoreP_OK;
+}
+
+void TaskP_yield(void)
+{
+    __atomic_fetch_add(&simStats.yields, 1U, __ATOMIC_RELAXED);
+    sched_yield();
+}
+
+void TaskP_sleep(uint32_t timeout)
+{
+    EnetOsal_sleep(timeout);
+}
+
+uint64_t TimerP_getTimeInUsecs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U) +
+           __atomic_load_n(&simTimeOffsetUs, __ATOMIC_RELAXED);
+}
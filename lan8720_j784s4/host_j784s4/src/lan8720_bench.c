@@ -0,0 +1,714 @@
+/**
+ * @file lan8720_bench.c
+ * @brief Host benchmark of the LAN8720 Ethernet driver
+ *
+ * Runs the driver against the host simulation and reports, for the send
+ * and receive paths and for the PHY configuration hook, the achieved rate,
+ * the bytes the driver copied per frame, the MDIO frames issued and the
+ * call latency. The extended register setup is also compared against
+ * one read-modify-write per setting, and the ring that hands received
+ * frames to the channel workers against a locked queue.
+ *
+ * The driver source is included to reach the ring, which is internal.
+ *
+ * Usage: lan8720_bench [frames]
+ */
+
+/* ========================================================================== */
+/*                             Include Files                                  */
+/* ========================================================================== */
+#include "../../driver_j784s4/src/lan8720.c"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "host_sim.h"
+
+/* ========================================================================== */
+/*                           Macros & Typedefs                                */
+/* ========================================================================== */
+
+#define BENCH_FRAMES_DEFAULT   (20000U)
+#define BENCH_FRAME_LEN        (512U)
+#define BENCH_CONFIG_RUNS      (200U)
+#define BENCH_PHY_ADDR         (0U)
+#define BENCH_CFG_PHY_ADDR     (1U)
+#define BENCH_EXT_REF_PHY_ADDR (2U)
+#define BENCH_EXT_PHY_ADDR     (3U)
+#define BENCH_LINK_TIMEOUT_MS  (2000U)
+#define BENCH_PACE_LOW         (8U)
+#define BENCH_COPY_FRAMES      (1000U)
+#define BENCH_COPY_LEN         (1024U)
+#define BENCH_HDR_LEN          (14U)
+#define BENCH_RING_PKTS        (48U)
+#define BENCH_RING_FRAMES      (1000000U)
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t sumNs;
+    uint64_t maxNs;
+} Bench_Lat;
+
+/* Frames go to the consumer and come back, through the two rings or, for
+ * the baseline, through two queues under one lock */
+typedef struct
+{
+    Ethernet_Ring rxRing;
+    Ethernet_Ring freeRing;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EnetDma_PktQ rxQueue;
+    EnetDma_PktQ freeQueue;
+    bool locked;
+    uint32_t batch;
+    EnetDma_Pkt pkts[BENCH_RING_PKTS];
+} Bench_RingPair;
+
+/* ========================================================================== */
+/*                            Global Variables                                */
+/* ========================================================================== */
+
+static uint8_t benchFrame[BENCH_FRAME_LEN];
+static uint8_t benchRxBuf[1536U];
+static uint8_t benchCopyFrame[BENCH_COPY_LEN];
+
+/* ========================================================================== */
+/*                          Function Definitions                              */
+/* ========================================================================== */
+
+static uint64_t Bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static void Bench_latAdd(Bench_Lat *lat, uint64_t ns)
+{
+    lat->count++;
+    lat->sumNs += ns;
+    if (ns > lat->maxNs)
+    {
+        lat->maxNs = ns;
+    }
+}
+
+static void Bench_latPrint(const char *name, const Bench_Lat *lat)
+{
+    printf("  %-24s avg %8.0f ns  max %8llu ns  (%llu calls)\n", name,
+           (lat->count != 0U) ? ((double)lat->sumNs / (double)lat->count) : 0.0,
+           (unsigned long long)lat->maxNs, (unsigned long long)lat->count);
+}
+
+static void Bench_rxIsr(void *arg)
+{
+    Ethernet_rxNotify(arg);
+}
+
+static void Bench_txIsr(void *arg)
+{
+    Ethernet_txNotify(arg);
+}
+
+/**
+ *  \brief Brings a port up on the simulated PHY and waits for the link.
+ */
+static Lan8720_Ctx *Bench_openPort(void)
+{
+    Ethernet_PortCfg cfg;
+    Lan8720_Ctx *ctx;
+    uint32_t ms;
+
+    HostSim_addPhy(BENCH_PHY_ADDR);
+    HostSim_setLink(BENCH_PHY_ADDR, true);
+
+    Ethernet_initPortCfg(&cfg);
+    cfg.hEnet = HostSim_enet();
+    cfg.phyAddr = BENCH_PHY_ADDR;
+    ctx = Ethernet_init(&cfg);
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_RX, cfg.macPort, Bench_rxIsr, ctx);
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_TX, cfg.macPort, Bench_txIsr, ctx);
+
+    for (ms = 0U; ms < BENCH_LINK_TIMEOUT_MS; ms++)
+    {
+        if (Ethernet_initTick(ctx) == ETHERNET_INIT_LINK_UP)
+        {
+            return ctx;
+        }
+        EnetOsal_sleep(1U);
+    }
+    printf("Link did not come up\n");
+    return NULL;
+}
+
+/**
+ *  \brief Sends frames with Ethernet_sendPacket() as fast as the driver
+ *  accepts them, with the TX completions run by the simulated DMA.
+ */
+static void Bench_send(Lan8720_Ctx *ctx, uint32_t frames)
+{
+    Ethernet_TxReclaimStats reclaim;
+    Ethernet_TxPaceStats pace;
+    Ethernet_PerfStats perf;
+    HostSim_Stats sim;
+    Bench_Lat lat = { 0U, 0U, 0U };
+    uint64_t start, t0, t1;
+    uint32_t sent = 0U, retries = 0U;
+    int ret;
+
+    HostSim_setLoopback(ENET_MAC_PORT_1, false);
+    Ethernet_resetPerfStats(ctx);
+    HostSim_resetStats();
+    start = Bench_nowNs();
+    while (sent < frames)
+    {
+        benchFrame[0] = (uint8_t)sent;
+        t0 = Bench_nowNs();
+        ret = Ethernet_sendPacket(ctx, benchFrame, sizeof(benchFrame));
+        t1 = Bench_nowNs();
+        Bench_latAdd(&lat, t1 - t0);
+        if (ret == 0)
+        {
+            sent++;
+        }
+        else
+        {
+            /* Pool or pacing queue full: let the wire drain half of the
+             * default pacing queue */
+            retries++;
+            do
+            {
+                HostSim_poll();
+                Ethernet_reclaimTx(ctx);
+                Ethernet_getTxPaceStats(ctx, &pace);
+            } while (pace.queued[ETHERNET_TX_PRIO_NORMAL] > BENCH_PACE_LOW);
+        }
+    }
+    /* Wait for the paced and in-flight frames to leave */
+    do
+    {
+        HostSim_poll();
+        Ethernet_reclaimTx(ctx);
+        Ethernet_getTxReclaimStats(ctx, &reclaim);
+        Ethernet_getTxPaceStats(ctx, &pace);
+    } while ((reclaim.inFlight > 0U) ||
+             ((pace.queued[ETHERNET_TX_PRIO_NORMAL] + pace.queued[ETHERNET_TX_PRIO_HIGH]) > 0U));
+    t1 = Bench_nowNs();
+    Ethernet_getPerfStats(ctx, &perf);
+    HostSim_getStats(&sim);
+    HostSim_setLoopback(ENET_MAC_PORT_1, true);
+
+    printf("sendPacket (%u byte frames)\n", (unsigned)BENCH_FRAME_LEN);
+    printf("  frames/s                 %.0f  (%u on the wire, %u retries)\n",
+           (double)sent * 1e9 / (double)(t1 - start), (unsigned)sim.txFrames, (unsigned)retries);
+    printf("  bytes copied per frame   %.1f\n",
+           (perf.txFrames != 0U) ? ((double)perf.txBytesCopied / (double)perf.txFrames) : 0.0);
+    printf("  MDIO frames              %u\n", (unsigned)(sim.mdioReads + sim.mdioWrites));
+    Bench_latPrint("sendPacket", &lat);
+}
+
+/**
+ *  \brief Receives frames with Ethernet_receivePacket(), fed by the
+ *  simulated wire as fast as RX buffers are available.
+ */
+static void Bench_receive(Lan8720_Ctx *ctx, uint32_t frames)
+{
+    Ethernet_PerfStats perf;
+    HostSim_Stats sim;
+    Bench_Lat lat = { 0U, 0U, 0U };
+    uint64_t start, t0, t1;
+    uint32_t received = 0U;
+    int ret;
+
+    Ethernet_resetPerfStats(ctx);
+    HostSim_resetStats();
+    start = Bench_nowNs();
+    while (received < frames)
+    {
+        while (HostSim_rxFreeCount(ENET_MAC_PORT_1) > 0U)
+        {
+            HostSim_injectRx(ENET_MAC_PORT_1, benchFrame, sizeof(benchFrame));
+        }
+        HostSim_poll();
+        do
+        {
+            t0 = Bench_nowNs();
+            ret = Ethernet_receivePacket(ctx, benchRxBuf, sizeof(benchRxBuf));
+            t1 = Bench_nowNs();
+            Bench_latAdd(&lat, t1 - t0);
+            if (ret > 0)
+            {
+                received++;
+            }
+        } while ((ret > 0) && (received < frames));
+    }
+    t1 = Bench_nowNs();
+    Ethernet_getPerfStats(ctx, &perf);
+    HostSim_getStats(&sim);
+
+    printf("receivePacket (%u byte frames)\n", (unsigned)BENCH_FRAME_LEN);
+    printf("  frames/s                 %.0f\n", (double)received * 1e9 / (double)(t1 - start));
+    printf("  bytes copied per frame   %.1f\n",
+           (perf.rxFrames != 0U) ? ((double)perf.rxBytesCopied / (double)perf.rxFrames) : 0.0);
+    printf("  MDIO frames              %u\n", (unsigned)(sim.mdioReads + sim.mdioWrites));
+    Bench_latPrint("receivePacket", &lat);
+}
+
+/**
+ *  \brief Steps the simulated DMA and the TX side of the driver until
+ *  every accepted frame is on the wire.
+ */
+static void Bench_flushTx(Lan8720_Ctx *ctx)
+{
+    Ethernet_TxReclaimStats reclaim;
+    Ethernet_TxPaceStats pace;
+
+    do
+    {
+        HostSim_poll();
+        Ethernet_reclaimTx(ctx);
+        Ethernet_getTxReclaimStats(ctx, &reclaim);
+        Ethernet_getTxPaceStats(ctx, &pace);
+    } while ((reclaim.inFlight > 0U) ||
+             ((pace.queued[ETHERNET_TX_PRIO_NORMAL] + pace.queued[ETHERNET_TX_PRIO_HIGH]) > 0U));
+}
+
+/**
+ *  \brief Sends frames through one of the transmit APIs, each one once the
+ *  previous is on the wire, and returns the bytes the driver copied per
+ *  frame.
+ */
+static double Bench_txCopies(Lan8720_Ctx *ctx, uint32_t api)
+{
+    Ethernet_PerfStats perf;
+    Ethernet_TxFrag frags[2];
+    Ethernet_TxBuf txBuf;
+    int ret = -1;
+    uint32_t i;
+
+    frags[0].buf = benchCopyFrame;
+    frags[0].len = BENCH_HDR_LEN;
+    frags[1].buf = &benchCopyFrame[BENCH_HDR_LEN];
+    frags[1].len = BENCH_COPY_LEN - BENCH_HDR_LEN;
+
+    HostSim_setLoopback(ENET_MAC_PORT_1, false);
+    Ethernet_resetPerfStats(ctx);
+    for (i = 0U; i < BENCH_COPY_FRAMES; i++)
+    {
+        switch (api)
+        {
+            case 0U:
+                ret = Ethernet_sendPacket(ctx, benchCopyFrame, BENCH_COPY_LEN);
+                break;
+            case 1U:
+                ret = Ethernet_sendPacketSg(ctx, frags, 2U);
+                break;
+            default:
+                /* The application builds the frame in the DMA buffer */
+                ret = Ethernet_acquireTxBuffer(ctx, &txBuf);
+                if (ret == 0)
+                {
+                    txBuf.data[0] = (uint8_t)i;
+                    ret = Ethernet_submitTxBuffer(ctx, &txBuf, BENCH_COPY_LEN);
+                }
+                break;
+        }
+        if (ret != 0)
+        {
+            break;
+        }
+        Bench_flushTx(ctx);
+    }
+    Ethernet_getPerfStats(ctx, &perf);
+    HostSim_setLoopback(ENET_MAC_PORT_1, true);
+    return (perf.txFrames != 0U) ? ((double)perf.txBytesCopied / (double)perf.txFrames) : -1.0;
+}
+
+/**
+ *  \brief Receives looped back frames through one of the receive APIs and
+ *  returns the bytes the driver copied per frame.
+ */
+static double Bench_rxCopies(Lan8720_Ctx *ctx, bool loan)
+{
+    Ethernet_PerfStats perf;
+    Ethernet_RxBuf rxBuf;
+    uint32_t i;
+
+    /* Drop what the previous runs left pending */
+    while (Ethernet_receivePacket(ctx, benchRxBuf, sizeof(benchRxBuf)) > 0)
+    {
+    }
+    Ethernet_resetPerfStats(ctx);
+    for (i = 0U; i < BENCH_COPY_FRAMES; i++)
+    {
+        HostSim_injectRx(ENET_MAC_PORT_1, benchCopyFrame, BENCH_COPY_LEN);
+        HostSim_poll();
+        if (loan)
+        {
+            if (Ethernet_receiveLoan(ctx, &rxBuf, 1U) == 1U)
+            {
+                Ethernet_releaseRxPacket(ctx, &rxBuf);
+            }
+        }
+        else
+        {
+            Ethernet_receivePacket(ctx, benchRxBuf, sizeof(benchRxBuf));
+        }
+    }
+    Ethernet_getPerfStats(ctx, &perf);
+    return (perf.rxFrames != 0U) ? ((double)perf.rxBytesCopied / (double)perf.rxFrames) : -1.0;
+}
+
+/**
+ *  \brief Reports the bytes copied by the driver per frame for each
+ *  transmit and receive API.
+ */
+static void Bench_copies(Lan8720_Ctx *ctx)
+{
+    printf("Bytes copied per %u byte frame\n", (unsigned)BENCH_COPY_LEN);
+    printf("  sendPacket               %.1f\n", Bench_txCopies(ctx, 0U));
+    printf("  sendPacketSg (2 frags)   %.1f\n", Bench_txCopies(ctx, 1U));
+    printf("  acquire/submitTxBuffer   %.1f\n", Bench_txCopies(ctx, 2U));
+    printf("  receivePacket            %.1f\n", Bench_rxCopies(ctx, false));
+    printf("  receiveLoan              %.1f\n", Bench_rxCopies(ctx, true));
+}
+
+/**
+ *  \brief Runs the config hook of the PHY driver, right after a reset
+ *  (cold) and again on the configured PHY (warm).
+ */
+static void Bench_config(void)
+{
+    EnetPhy_Obj phy = { BENCH_CFG_PHY_ADDR };
+    EnetPhy_Cfg phyCfg;
+    LAN8720_Cfg cfg;
+    Bench_Lat cold = { 0U, 0U, 0U }, warm = { 0U, 0U, 0U };
+    uint32_t coldFrames = 0U, warmFrames = 0U;
+    uint32_t frames;
+    uint64_t t0;
+    uint32_t i;
+
+    HostSim_addPhy(BENCH_CFG_PHY_ADDR);
+    Lan8720_initCfg(&cfg);
+    memset(&phyCfg, 0, sizeof(phyCfg));
+    phyCfg.phyAddr = BENCH_CFG_PHY_ADDR;
+    EnetPhy_setExtendedCfg(&phyCfg, &cfg, sizeof(cfg));
+
+    for (i = 0U; i < BENCH_CONFIG_RUNS; i++)
+    {
+        gEnetPhyDrvLan8720.reset(&phy);
+        while (!gEnetPhyDrvLan8720.isResetComplete(&phy))
+        {
+        }
+
+        frames = HostSim_getPhyFrames(BENCH_CFG_PHY_ADDR);
+        t0 = Bench_nowNs();
+        gEnetPhyDrvLan8720.config(&phy, &phyCfg, ENETPHY_MAC_MII_RMII);
+        Bench_latAdd(&cold, Bench_nowNs() - t0);
+        coldFrames = HostSim_getPhyFrames(BENCH_CFG_PHY_ADDR) - frames;
+
+        frames = HostSim_getPhyFrames(BENCH_CFG_PHY_ADDR);
+        t0 = Bench_nowNs();
+        gEnetPhyDrvLan8720.config(&phy, &phyCfg, ENETPHY_MAC_MII_RMII);
+        Bench_latAdd(&warm, Bench_nowNs() - t0);
+        warmFrames = HostSim_getPhyFrames(BENCH_CFG_PHY_ADDR) - frames;
+    }
+
+    printf("Lan8720_config (default LAN8720_Cfg, RMII)\n");
+    printf("  MDIO frames              %u after reset, %u when already configured\n",
+           (unsigned)coldFrames, (unsigned)warmFrames);
+    Bench_latPrint("config after reset", &cold);
+    Bench_latPrint("config again", &warm);
+}
+
+/**
+ *  \brief Read-modify-write of an extended register through the MMD
+ *  window, one access per setting as done before batching: 6 frames.
+ */
+static void Bench_rmwExtReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t mask, uint16_t val)
+{
+    uint16_t data = 0U;
+
+    EnetPhy_writeReg(hPhy, PHY_MMD_CR, MMD_CR_ADDR | MMD_CR_DEVADDR);
+    EnetPhy_writeReg(hPhy, PHY_MMD_DR, (uint16_t)reg);
+    EnetPhy_writeReg(hPhy, PHY_MMD_CR, MMD_CR_DATA_NOPOSTINC | MMD_CR_DEVADDR);
+    EnetPhy_readReg(hPhy, PHY_MMD_DR, &data);
+    EnetPhy_writeReg(hPhy, PHY_MMD_CR, MMD_CR_DATA_NOPOSTINC | MMD_CR_DEVADDR);
+    EnetPhy_writeReg(hPhy, PHY_MMD_DR, (data & ~mask) | (val & mask));
+}
+
+/**
+ *  \brief MDIO transactions spent on extended registers by
+ *  Lan8720_config(), against applying each setting of the plan on its own.
+ */
+static void Bench_extRegs(void)
+{
+    EnetPhy_Obj ref = { BENCH_EXT_REF_PHY_ADDR };
+    EnetPhy_Obj phy = { BENCH_EXT_PHY_ADDR };
+    EnetPhy_Cfg phyCfg;
+    LAN8720_Cfg cfg;
+    Lan8720_CfgPlan plan;
+    HostSim_Stats stats;
+    const Lan8720_CfgOp *op;
+    uint32_t settings = 0U, regs = 0U, mismatches = 0U;
+    uint32_t refFrames, frames;
+    uint32_t i, j;
+    uint16_t strap;
+
+    Lan8720_initCfg(&cfg);
+    if (Lan8720_buildCfgPlan(&cfg, ENETPHY_MAC_MII_RMII, &plan) != ENETPHY_SOK)
+    {
+        printf("Extended registers: no plan\n");
+        return;
+    }
+    for (i = 0U; i < plan.num; i++)
+    {
+        if ((plan.ops[i].reg & LAN8720_CFG_OP_EXT) == 0U)
+        {
+            continue;
+        }
+        settings++;
+        for (j = 0U; (j < i) && (plan.ops[j].reg != plan.ops[i].reg); j++)
+        {
+        }
+        regs += (j == i) ? 1U : 0U;
+    }
+
+    /* Reference: the strap check and every setting on its own */
+    HostSim_addPhy(BENCH_EXT_REF_PHY_ADDR);
+    HostSim_resetStats();
+    Bench_rmwExtReg(&ref, LAN8720_STRAPSTS2, 0U, 0U);
+    for (i = 0U; i < plan.num; i++)
+    {
+        op = &plan.ops[i];
+        if ((op->reg & LAN8720_CFG_OP_EXT) != 0U)
+        {
+            Bench_rmwExtReg(&ref, op->reg & ~LAN8720_CFG_OP_EXT, op->mask, op->val);
+        }
+    }
+    HostSim_getStats(&stats);
+    refFrames = stats.mmdFrames;
+
+    HostSim_addPhy(BENCH_EXT_PHY_ADDR);
+    memset(&phyCfg, 0, sizeof(phyCfg));
+    phyCfg.phyAddr = BENCH_EXT_PHY_ADDR;
+    EnetPhy_setExtendedCfg(&phyCfg, &cfg, sizeof(cfg));
+    HostSim_resetStats();
+    gEnetPhyDrvLan8720.config(&phy, &phyCfg, ENETPHY_MAC_MII_RMII);
+    HostSim_getStats(&stats);
+    frames = stats.mmdFrames;
+
+    /* Both must leave the PHY in the same state */
+    strap = HostSim_getExtReg(BENCH_EXT_PHY_ADDR, LAN8720_STRAPSTS2);
+    for (i = 0U; i < plan.num; i++)
+    {
+        op = &plan.ops[i];
+        if (((op->reg & LAN8720_CFG_OP_EXT) != 0U) &&
+            (HostSim_getExtReg(BENCH_EXT_REF_PHY_ADDR, op->reg & ~LAN8720_CFG_OP_EXT) !=
+             HostSim_getExtReg(BENCH_EXT_PHY_ADDR, op->reg & ~LAN8720_CFG_OP_EXT)))
+        {
+            mismatches++;
+        }
+    }
+
+    printf("Extended registers of Lan8720_config (default LAN8720_Cfg, RMII)\n");
+    printf("  settings                 %u on %u registers%s\n", (unsigned)settings, (unsigned)regs,
+           ((strap & STRAPSTS2_FLD_MASK) != 0U) ? ", FLD strap set" : "");
+    printf("  MMD frames               %u one RMW per setting, %u batched (%.0f%% fewer)\n",
+           (unsigned)refFrames, (unsigned)frames,
+           (refFrames > 0U) ? (100.0 * (double)(refFrames - frames) / (double)refFrames) : 0.0);
+    if (mismatches != 0U)
+    {
+        printf("  MISMATCH                 %u registers differ from the reference\n",
+               (unsigned)mismatches);
+    }
+}
+
+/**
+ *  \brief Consumer of the ring benchmark: takes up to batch frames at a
+ *  time and hands them straight back.
+ */
+static void *Bench_ringConsumer(void *arg)
+{
+    Bench_RingPair *rp = (Bench_RingPair *)arg;
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    EnetDma_PktQ freeQueue;
+    uint32_t received = 0U;
+    uint32_t count, i;
+
+    while (received < BENCH_RING_FRAMES)
+    {
+        if (rp->locked)
+        {
+            pthread_mutex_lock(&rp->lock);
+            while (EnetQueue_getQCount(&rp->rxQueue) == 0U)
+            {
+                pthread_cond_wait(&rp->cond, &rp->lock);
+            }
+            for (count = 0U; (count < rp->batch) && (EnetQueue_getQCount(&rp->rxQueue) > 0U); count++)
+            {
+                EnetQueue_enq(&rp->freeQueue, EnetQueue_deq(&rp->rxQueue));
+            }
+            pthread_mutex_unlock(&rp->lock);
+        }
+        else
+        {
+            count = Ethernet_ringWait(&rp->rxRing, pkts, rp->batch);
+            EnetQueue_initQ(&freeQueue);
+            for (i = 0U; i < count; i++)
+            {
+                EnetQueue_enq(&freeQueue, &pkts[i]->node);
+            }
+            i = count;
+            while (Ethernet_ringPut(&rp->freeRing, &freeQueue) < i)
+            {
+                i = EnetQueue_getQCount(&freeQueue);
+                sched_yield();
+            }
+        }
+        received += count;
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Passes BENCH_RING_FRAMES frames to a consumer thread and back.
+ *
+ *  \return Frames per second.
+ */
+static double Bench_ringRun(Bench_RingPair *rp, bool locked, uint32_t batch)
+{
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    EnetDma_PktQ freeQueue;
+    pthread_t consumer;
+    uint32_t sent = 0U;
+    uint32_t count, i;
+    uint64_t t0;
+
+    Ethernet_ringInit(&rp->rxRing, true);
+    Ethernet_ringInit(&rp->freeRing, false);
+    EnetQueue_initQ(&rp->rxQueue);
+    EnetQueue_initQ(&rp->freeQueue);
+    EnetQueue_initQ(&freeQueue);
+    for (i = 0U; i < BENCH_RING_PKTS; i++)
+    {
+        EnetQueue_enq(&freeQueue, &rp->pkts[i].node);
+    }
+    rp->locked = locked;
+    rp->batch = batch;
+
+    t0 = Bench_nowNs();
+    if (pthread_create(&consumer, NULL, Bench_ringConsumer, rp) != 0)
+    {
+        return 0.0;
+    }
+    while (sent < BENCH_RING_FRAMES)
+    {
+        if (locked)
+        {
+            pthread_mutex_lock(&rp->lock);
+            EnetQueue_append(&freeQueue, &rp->freeQueue);
+            EnetQueue_initQ(&rp->freeQueue);
+            count = EnetQueue_getQCount(&freeQueue);
+            if ((sent + count) > BENCH_RING_FRAMES)
+            {
+                count = BENCH_RING_FRAMES - sent;
+            }
+            for (i = 0U; i < count; i++)
+            {
+                EnetQueue_enq(&rp->rxQueue, EnetQueue_deq(&freeQueue));
+            }
+            if (count > 0U)
+            {
+                pthread_cond_signal(&rp->cond);
+            }
+            pthread_mutex_unlock(&rp->lock);
+        }
+        else
+        {
+            do
+            {
+                count = Ethernet_ringGet(&rp->freeRing, pkts, ETHERNET_RX_DRAIN_BATCH);
+                for (i = 0U; i < count; i++)
+                {
+                    EnetQueue_enq(&freeQueue, &pkts[i]->node);
+                }
+            } while (count == ETHERNET_RX_DRAIN_BATCH);
+            while (EnetQueue_getQCount(&freeQueue) > (BENCH_RING_FRAMES - sent))
+            {
+                EnetQueue_deq(&freeQueue);
+            }
+            count = Ethernet_ringPut(&rp->rxRing, &freeQueue);
+        }
+        sent += count;
+        if (count == 0U)
+        {
+            /* Nothing came back yet; the consumer needs the core */
+            sched_yield();
+        }
+    }
+    pthread_join(consumer, NULL);
+    return (double)BENCH_RING_FRAMES * 1e9 / (double)(Bench_nowNs() - t0);
+}
+
+/**
+ *  \brief Rate at which received frames reach a channel worker and come
+ *  back, one frame or a drain batch per ring access, against a queue
+ *  under a mutex and condition variable.
+ */
+static void Bench_ring(void)
+{
+    static Bench_RingPair rp;
+
+    pthread_mutex_init(&rp.lock, NULL);
+    pthread_cond_init(&rp.cond, NULL);
+
+    printf("Channel ring (%u frames, %u packets)\n", (unsigned)BENCH_RING_FRAMES,
+           (unsigned)BENCH_RING_PKTS);
+    printf("  ring, batch 1            %8.2f Mframes/s\n", Bench_ringRun(&rp, false, 1U) / 1e6);
+    printf("  ring, batch %-2u           %8.2f Mframes/s\n", (unsigned)ETHERNET_RX_DRAIN_BATCH,
+           Bench_ringRun(&rp, false, ETHERNET_RX_DRAIN_BATCH) / 1e6);
+    printf("  locked queue, batch 1    %8.2f Mframes/s\n", Bench_ringRun(&rp, true, 1U) / 1e6);
+    printf("  locked queue, batch %-2u   %8.2f Mframes/s\n", (unsigned)ETHERNET_RX_DRAIN_BATCH,
+           Bench_ringRun(&rp, true, ETHERNET_RX_DRAIN_BATCH) / 1e6);
+
+    pthread_cond_destroy(&rp.cond);
+    pthread_mutex_destroy(&rp.lock);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = BENCH_FRAMES_DEFAULT;
+    Lan8720_Ctx *ctx;
+
+    if (argc > 1)
+    {
+        frames = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    memset(benchFrame, 0xA5, sizeof(benchFrame));
+    memset(benchCopyFrame, 0x5A, sizeof(benchCopyFrame));
+
+    HostSim_init();
+    ctx = Bench_openPort();
+    if (ctx == NULL)
+    {
+        return 1;
+    }
+    Bench_send(ctx, frames);
+    Bench_receive(ctx, frames);
+    Bench_copies(ctx);
+    Bench_config();
+    Bench_extRegs();
+    Bench_ring();
+    return 0;
+}
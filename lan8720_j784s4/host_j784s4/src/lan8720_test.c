@@ -0,0 +1,1329 @@
+/**
+ * @file lan8720_test.c
+ * @brief Host tests of the LAN8720 Ethernet driver
+ *
+ * The driver source is included so that the tests can check its internal
+ * state. Each test runs in its own process against a fresh simulation.
+ *
+ * Usage: lan8720_test [name...]
+ */
+
+/* ========================================================================== */
+/*                             Include Files                                  */
+/* ========================================================================== */
+#include "../../driver_j784s4/src/lan8720.c"
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/wait.h>
+#include "host_sim.h"
+
+/* ========================================================================== */
+/*                           Macros & Typedefs                                */
+/* ========================================================================== */
+
+#define TEST_TIMEOUT_S        (30U)
+#define TEST_LINK_TIMEOUT_MS  (2000U)
+#define TEST_HW_PERIOD_US     (100U)
+#define TEST_EVENT_MS         (200U)
+#define TEST_ANEG_US          (20000U)
+#define TEST_FLOWS            (16U)
+#define TEST_FLOW_FRAMES      (500U)
+#define TEST_FLOW_FRAME_LEN   (64U)
+#define TEST_RING_PKTS        (48U)
+#define TEST_RING_ROUNDS      (500000U)
+#define TEST_MMD_PHY_ADDR     (5U)
+#define TEST_MMD_QUEUE_REG    (0x200U)
+#define TEST_MMD_BLOCK_REG    (0x201U)
+#define TEST_MMD_ROUNDS       (200U)
+#define TEST_EXT_RUN_REG      (0x300U)
+#define TEST_EXT_RUN_LEN      (6U)
+#define TEST_RX_REL_ROUNDS    (8U)
+#define TEST_RX_REL_WAIT_MS   (20U)
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                        \
+        }                                                                   \
+    } while (0)
+
+typedef struct
+{
+    Lan8720_Ctx *ctx;
+    pthread_t thread;
+    uint32_t chIdx;
+    uint32_t expected;
+    uint32_t received;
+    uint32_t nextSeq[TEST_FLOWS];
+} Test_Worker;
+
+typedef struct
+{
+    Lan8720_Ctx *ctx;
+    pthread_t thread;
+    Ethernet_RxBuf rxBuf;
+    bool done;
+} Test_Releaser;
+
+typedef struct
+{
+    Ethernet_Ring rxRing;
+    Ethernet_Ring freeRing;
+    EnetDma_Pkt pkts[TEST_RING_PKTS];
+} Test_RingPair;
+
+typedef struct
+{
+    const char *name;
+    void (*fn)(void);
+} Test_Case;
+
+/* ========================================================================== */
+/*                              Helpers                                       */
+/* ========================================================================== */
+
+static void Test_rxIsr(void *arg)
+{
+    Ethernet_rxNotify(arg);
+}
+
+static void Test_txIsr(void *arg)
+{
+    Ethernet_txNotify(arg);
+}
+
+static void Test_phyIsr(void *arg)
+{
+    Ethernet_phyIsr(arg);
+}
+
+static void Test_mdioLinkIsr(void *arg)
+{
+    Ethernet_mdioLinkIsr();
+}
+
+static void Test_mdioQueueIsr(void *arg)
+{
+    Lan8720_mdioQueueIsr();
+}
+
+static void Test_mdioDone(void *cbArg, int32_t status, uint16_t val)
+{
+    CHECK(status == ENETPHY_SOK);
+    __atomic_fetch_add((uint32_t *)cbArg, 1U, __ATOMIC_RELAXED);
+}
+
+static uint64_t Test_nowMs(void)
+{
+    return TimerP_getTimeInUsecs() / 1000U;
+}
+
+static bool Test_linkUp(Lan8720_Ctx *ctx)
+{
+    return __atomic_load_n(&ctx->link.linkUp, __ATOMIC_ACQUIRE) != 0U;
+}
+
+/**
+ *  \brief Waits for the device task to see the link in a given state.
+ *
+ *  \return Milliseconds it took.
+ */
+static uint32_t Test_waitLink(Lan8720_Ctx *ctx, bool up, uint32_t timeoutMs)
+{
+    uint64_t start = Test_nowMs();
+
+    while (Test_linkUp(ctx) != up)
+    {
+        CHECK((Test_nowMs() - start) < timeoutMs);
+        EnetOsal_sleep(1U);
+    }
+    return (uint32_t)(Test_nowMs() - start);
+}
+
+static void *Test_deviceMain(void *arg)
+{
+    Ethernet_deviceMain(arg);
+    return NULL;
+}
+
+/**
+ *  \brief Builds a UDP/IPv4 frame of a flow, carrying the flow and a
+ *  sequence number in its payload.
+ */
+static void Test_udpFrame(uint8_t *frame, uint32_t flow, uint32_t seq)
+{
+    static const uint8_t hdr[] =
+    {
+        0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x01U,  /* Destination MAC */
+        0x02U, 0x00U, 0x00U, 0x00U, 0x00U, 0x02U,  /* Source MAC */
+        0x08U, 0x00U,                              /* IPv4 */
+        0x45U, 0x00U, 0x00U, 0x32U, 0x00U, 0x00U, 0x00U, 0x00U, 0x40U, 0x11U,
+        0x00U, 0x00U, 0x0AU, 0x00U, 0x00U, 0x01U, 0x0AU, 0x00U, 0x00U, 0x02U,
+    };
+    uint32_t port = 1000U + flow;
+
+    memset(frame, 0, TEST_FLOW_FRAME_LEN);
+    memcpy(frame, hdr, sizeof(hdr));
+    frame[34] = (uint8_t)(port >> 8);
+    frame[35] = (uint8_t)port;
+    frame[36] = 0x13U;
+    frame[37] = 0x88U;
+    frame[42] = (uint8_t)flow;
+    memcpy(&frame[43], &seq, sizeof(seq));
+}
+
+/**
+ *  \brief Consumer of one RX channel, on the core the channel is pinned
+ *  to, checking that each flow arrives in order and on its channel.
+ */
+static void *Test_chanWorker(void *arg)
+{
+    Test_Worker *w = (Test_Worker *)arg;
+    Ethernet_RxBuf rxBufs[ETHERNET_RX_DRAIN_BATCH];
+    uint32_t count, flow, seq, i;
+
+    HostSim_setCoreId(w->chIdx);
+    while (w->received < w->expected)
+    {
+        count = Ethernet_receiveChan(w->ctx, w->chIdx, rxBufs, ETHERNET_RX_DRAIN_BATCH, true);
+        for (i = 0U; i < count; i++)
+        {
+            CHECK(rxBufs[i].len == TEST_FLOW_FRAME_LEN);
+            CHECK(Ethernet_flowChannel(w->ctx, rxBufs[i].data, rxBufs[i].len) == w->chIdx);
+            flow = ((const uint8_t *)rxBufs[i].data)[42];
+            memcpy(&seq, &((const uint8_t *)rxBufs[i].data)[43], sizeof(seq));
+            CHECK((flow < TEST_FLOWS) && (seq == w->nextSeq[flow]));
+            w->nextSeq[flow]++;
+            Ethernet_releaseChanPacket(w->ctx, w->chIdx, &rxBufs[i]);
+        }
+        __atomic_add_fetch(&w->received, count, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Consumer side of the ring stress test: takes packets in batches
+ *  of varying size, checks their sequence and hands them back.
+ */
+static void *Test_ringConsumer(void *arg)
+{
+    Test_RingPair *rp = (Test_RingPair *)arg;
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    EnetDma_PktQ freeQueue;
+    uint32_t next = 0U;
+    uint32_t count, want, i;
+
+    while (next < TEST_RING_ROUNDS)
+    {
+        want = 1U + (next % ETHERNET_RX_DRAIN_BATCH);
+        count = Ethernet_ringWait(&rp->rxRing, pkts, want);
+        CHECK((count >= 1U) && (count <= want));
+        EnetQueue_initQ(&freeQueue);
+        for (i = 0U; i < count; i++)
+        {
+            CHECK(pkts[i]->userBufLen == next);
+            next++;
+            EnetQueue_enq(&freeQueue, &pkts[i]->node);
+        }
+        while (Ethernet_ringPut(&rp->freeRing, &freeQueue) < count)
+        {
+            /* Free ring full: the producer has to run first, which on a
+             * single core it only does if we step aside */
+            count = EnetQueue_getQCount(&freeQueue);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ *  \brief Releases a loaned RX packet from another thread, standing in for
+ *  the application on another core.
+ */
+static void *Test_rxReleaser(void *arg)
+{
+    Test_Releaser *r = (Test_Releaser *)arg;
+
+    Ethernet_releaseRxPacket(r->ctx, &r->rxBuf);
+    __atomic_store_n(&r->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/**
+ *  \brief Lets the other thread release its packet while the DMA has just
+ *  taken the released ones, giving it a while if it has to wait.
+ */
+static void Test_rxSubmitHook(void *arg)
+{
+    Test_Releaser *r = (Test_Releaser *)arg;
+    uint32_t ms;
+
+    HostSim_setRxSubmitHook(ENET_MAC_PORT, NULL, NULL);
+    CHECK(pthread_create(&r->thread, NULL, Test_rxReleaser, r) == 0);
+    for (ms = 0U; (ms < TEST_RX_REL_WAIT_MS) && !__atomic_load_n(&r->done, __ATOMIC_ACQUIRE); ms++)
+    {
+        EnetOsal_sleep(1U);
+    }
+}
+
+/**
+ *  \brief Brings up a port on a new simulated PHY with the cable plugged,
+ *  stepping the simulation until the link is up.
+ */
+static Lan8720_Ctx *Test_openPort(Ethernet_PortCfg *cfg)
+{
+    Lan8720_Ctx *ctx;
+    uint32_t ms;
+
+    HostSim_addPhy(cfg->phyAddr);
+    HostSim_setLink(cfg->phyAddr, true);
+    cfg->hEnet = HostSim_enet();
+    ctx = Ethernet_init(cfg);
+    CHECK(ctx != NULL);
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_RX, cfg->macPort, Test_rxIsr, ctx);
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_TX, cfg->macPort, Test_txIsr, ctx);
+
+    for (ms = 0U; ms < TEST_LINK_TIMEOUT_MS; ms++)
+    {
+        HostSim_poll();
+        if (Ethernet_initTick(ctx) == ETHERNET_INIT_LINK_UP)
+        {
+            return ctx;
+        }
+        EnetOsal_sleep(1U);
+    }
+    CHECK(!"link up");
+    return NULL;
+}
+
+/**
+ *  \brief Runs the device task of a port on a new simulated PHY with the
+ *  cable plugged, the hardware in its own thread, until the link is up.
+ */
+static Lan8720_Ctx *Test_startDevice(Ethernet_PortCfg *cfg)
+{
+    Lan8720_Ctx *ctx = &ethCtx[0];
+    pthread_t task;
+    uint64_t start;
+
+    cfg->hEnet = HostSim_enet();
+    HostSim_addPhy(cfg->phyAddr);
+    HostSim_setLink(cfg->phyAddr, true);
+    /* Negotiation has to outlast the bring-up for its interrupt to count */
+    HostSim_setAnegTime(TEST_ANEG_US);
+    HostSim_startHw(TEST_HW_PERIOD_US);
+    CHECK(pthread_create(&task, NULL, Test_deviceMain, cfg) == 0);
+
+    /* Connect the lines once the task has set up its context */
+    start = Test_nowMs();
+    while (!__atomic_load_n(&ctx->inUse, __ATOMIC_ACQUIRE))
+    {
+        CHECK((Test_nowMs() - start) < TEST_LINK_TIMEOUT_MS);
+        EnetOsal_sleep(1U);
+    }
+    HostSim_setIsr(HOSTSIM_IRQ_PHY, cfg->phyAddr, Test_phyIsr, ctx);
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_RX, cfg->macPort, Test_rxIsr, ctx);
+    HostSim_setIsr(HOSTSIM_IRQ_DMA_TX, cfg->macPort, Test_txIsr, ctx);
+    Test_waitLink(ctx, true, TEST_LINK_TIMEOUT_MS);
+    return ctx;
+}
+
+static Lan8720_Ctx *Test_openDefaultPort(void)
+{
+    Ethernet_PortCfg cfg;
+
+    Ethernet_initPortCfg(&cfg);
+    return Test_openPort(&cfg);
+}
+
+/**
+ *  \brief Sends a frame, letting the simulated DMA complete earlier ones
+ *  while the driver has no room.
+ */
+static void Test_send(Lan8720_Ctx *ctx, const void *data, uint32_t len)
+{
+    uint32_t tries;
+
+    for (tries = 0U; Ethernet_sendPacket(ctx, data, len) != 0; tries++)
+    {
+        CHECK(tries < 100000U);
+        HostSim_poll();
+        Ethernet_reclaimTx(ctx);
+    }
+}
+
+/**
+ *  \brief Steps the simulation and the TX side of the driver until every
+ *  accepted frame is on the wire.
+ */
+static void Test_flushTx(Lan8720_Ctx *ctx)
+{
+    Ethernet_TxReclaimStats reclaim;
+    Ethernet_TxPaceStats pace;
+    uint32_t tries = 0U;
+
+    do
+    {
+        CHECK(tries++ < 100000U);
+        HostSim_poll();
+        Ethernet_reclaimTx(ctx);
+        Ethernet_getTxReclaimStats(ctx, &reclaim);
+        Ethernet_getTxPaceStats(ctx, &pace);
+    } while ((reclaim.inFlight > 0U) ||
+             ((pace.queued[ETHERNET_TX_PRIO_NORMAL] + pace.queued[ETHERNET_TX_PRIO_HIGH]) > 0U));
+}
+
+/* ========================================================================== */
+/*                               Tests                                        */
+/* ========================================================================== */
+
+/**
+ *  \brief The port comes up through the bring-up states and negotiates the
+ *  link with the partner.
+ */
+static void Test_bringUp(void)
+{
+    Ethernet_LinkParams params;
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+
+    CHECK(Ethernet_getStatus(ctx) == 1U);
+    CHECK(Ethernet_getLinkParams(ctx, &params) == 0);
+    CHECK((params.speedIndi & PHY_SCS_SPEED_100) != 0U);
+    CHECK((params.speedIndi & PHY_SCS_FULL_DUPLEX) != 0U);
+}
+
+/**
+ *  \brief A link forced from cached parameters comes up without
+ *  auto-negotiation and stays up through its re-check, unless it takes
+ *  symbol errors meanwhile.
+ */
+static void Test_fastLink(void)
+{
+    Ethernet_PortCfg cfg;
+    Ethernet_LinkParams cached;
+    Ethernet_BootStats boot;
+    HostSim_Stats stats;
+    Lan8720_Ctx *ctx;
+    uint32_t i;
+
+    /* What the simulated partner advertises */
+    cached.partnerAbility = ANLPAR_100BASE_TX_FD | ANLPAR_100BASE_TX | ANLPAR_10BASE_T_FD |
+                            ANLPAR_10BASE_T | 0x0001U;
+    cached.speedIndi = PHY_SCS_SPEED_100 | PHY_SCS_FULL_DUPLEX;
+    Ethernet_initPortCfg(&cfg);
+    cfg.linkParams = &cached;
+    HostSim_resetStats();
+    ctx = Test_openPort(&cfg);
+    HostSim_getStats(&stats);
+    CHECK(stats.anegRestarts == 0U);
+
+    HostSim_advanceTime((ETHERNET_CFG_LINK_RECHECK_MS + ETHERNET_LINK_TICK_MS) * 1000U);
+    for (i = 0U; i < 10U; i++)
+    {
+        HostSim_poll();
+        Ethernet_initTick(ctx);
+        CHECK(Ethernet_getStatus(ctx) == 1U);
+        HostSim_advanceTime(ETHERNET_LINK_TICK_MS * 1000U);
+    }
+    CHECK(ctx->link.state == ETHERNET_LINK_DONE);
+    HostSim_getStats(&stats);
+    CHECK(stats.anegRestarts == 0U);
+    Ethernet_getBootStats(ctx, &boot);
+    CHECK(boot.fastLink && !boot.fallback && !boot.partnerChanged);
+
+#if (ETHERNET_CFG_LINK_RECHECK_ANEG == 0)
+    /* A forced link taking symbol errors is auto-negotiated after all */
+    Ethernet_initPortCfg(&cfg);
+    cfg.macPort = ENET_MAC_PORT_2;
+    cfg.phyAddr = ENET_PHY_ADDR + 1U;
+    cfg.linkParams = &cached;
+    HostSim_resetStats();
+    ctx = Test_openPort(&cfg);
+    HostSim_setReg(cfg.phyAddr, LAN8720_SYMBOL_ERROR_COUNTER,
+                   HostSim_getReg(cfg.phyAddr, LAN8720_SYMBOL_ERROR_COUNTER) +
+                   ETHERNET_CFG_LINK_VERIFY_SYM_ERRS + 1U);
+    HostSim_advanceTime((ETHERNET_CFG_LINK_RECHECK_MS + ETHERNET_LINK_TICK_MS) * 1000U);
+    for (i = 0U; (i < 100U) && (ctx->link.state != ETHERNET_LINK_DONE); i++)
+    {
+        HostSim_poll();
+        Ethernet_initTick(ctx);
+        HostSim_advanceTime(ETHERNET_LINK_TICK_MS * 1000U);
+    }
+    CHECK(ctx->link.state == ETHERNET_LINK_DONE);
+    HostSim_getStats(&stats);
+    CHECK(stats.anegRestarts == 1U);
+    Ethernet_getBootStats(ctx, &boot);
+    CHECK(boot.fastLink && !boot.fallback && boot.partnerChanged);
+#endif
+}
+
+/**
+ *  \brief The bring-up applies the MII mode and the LAN8720 configuration
+ *  after the PHY reset, and gives the context back when it fails or the
+ *  configuration is not valid.
+ */
+static void Test_phyConfig(void)
+{
+    Ethernet_PortCfg cfg;
+    LAN8720_Cfg phyCfg, badCfg;
+    HostSim_Stats stats;
+    Lan8720_Ctx *ctx;
+    Lan8720_CfgPlan plan;
+    const Lan8720_CfgOp *op;
+    uint16_t val;
+    uint32_t i;
+
+    /* Nothing answers at the address, so the reset never completes */
+    for (i = 0U; i <= ETHERNET_CFG_PORT_NUM; i++)
+    {
+        Ethernet_initPortCfg(&cfg);
+        cfg.hEnet = HostSim_enet();
+        CHECK(Ethernet_init(&cfg) == NULL);
+    }
+
+    /* Nor does an invalid configuration get written */
+    Lan8720_initCfg(&badCfg);
+    badCfg.txFifoDepth = 5U;
+    Ethernet_initPortCfg(&cfg);
+    cfg.hEnet = HostSim_enet();
+    cfg.phyCfg = &badCfg;
+    HostSim_addPhy(cfg.phyAddr);
+    CHECK(Ethernet_init(&cfg) == NULL);
+
+    Lan8720_initCfg(&phyCfg);
+    Ethernet_initPortCfg(&cfg);
+    cfg.phyCfg = &phyCfg;
+    ctx = Test_openPort(&cfg);
+
+    CHECK(Lan8720_buildCfgPlan(&phyCfg, cfg.mii, &plan) == ENETPHY_SOK);
+    CHECK(plan.num > 1U);
+    for (i = 0U; i < plan.num; i++)
+    {
+        op = &plan.ops[i];
+        if ((op->reg & LAN8720_CFG_OP_EXT) != 0U)
+        {
+            val = HostSim_getExtReg(cfg.phyAddr, op->reg & ~LAN8720_CFG_OP_EXT);
+        }
+        else
+        {
+            val = HostSim_getReg(cfg.phyAddr, op->reg);
+        }
+        CHECK((val & op->mask) == op->val);
+    }
+    CHECK((HostSim_getExtReg(cfg.phyAddr, LAN8720_RMIICTL) & RMIICTL_RMIIEN) != 0U);
+
+    HostSim_resetStats();
+    CHECK(Lan8720_reconfigure(ctx->hPhy, &badCfg, &phyCfg, NULL) == ENETPHY_EINVALIDPARAMS);
+    HostSim_getStats(&stats);
+    CHECK(stats.mdioWrites == 0U);
+}
+
+/**
+ *  \brief A configuration change keeps the MII mode of the port, and is
+ *  what the PHY gets when configured again, even over an installed plan.
+ */
+static void Test_phyReconfig(void)
+{
+    Ethernet_PortCfg cfg;
+    LAN8720_Cfg phyCfg;
+    Lan8720_CfgPlan fixed;
+    Lan8720_Ctx *ctx;
+    uint16_t rmiiCtl;
+
+    Ethernet_initPortCfg(&cfg);
+    cfg.mii = ENETPHY_MAC_MII_MII;
+    CHECK(Lan8720_buildCfgPlan(NULL, cfg.mii, &fixed) == ENETPHY_SOK);
+    Lan8720_setCfgPlan(cfg.phyAddr, &fixed);
+    ctx = Test_openPort(&cfg);
+    CHECK((HostSim_getExtReg(cfg.phyAddr, LAN8720_RMIICTL) & RMIICTL_RMIIEN) == 0U);
+
+    Lan8720_initCfg(&phyCfg);
+    phyCfg.txClkShiftEn = true;
+    CHECK(Ethernet_reconfigurePhy(ctx, &phyCfg) >= 0);
+    rmiiCtl = HostSim_getExtReg(cfg.phyAddr, LAN8720_RMIICTL);
+    CHECK(((rmiiCtl & RMIICTL_RMIIEN) == 0U) && ((rmiiCtl & RMIICTL_TXCLKDLY) != 0U));
+
+    Lan8720_reset(ctx->hPhy);
+    HostSim_poll();
+    CHECK(Lan8720_isResetComplete(ctx->hPhy));
+    CHECK((HostSim_getExtReg(cfg.phyAddr, LAN8720_RMIICTL) & RMIICTL_TXCLKDLY) == 0U);
+    CHECK(Ethernet_config(ctx) == 0);
+    rmiiCtl = HostSim_getExtReg(cfg.phyAddr, LAN8720_RMIICTL);
+    CHECK(((rmiiCtl & RMIICTL_RMIIEN) == 0U) && ((rmiiCtl & RMIICTL_TXCLKDLY) != 0U));
+}
+
+/**
+ *  \brief Frames sent through the loopback come back intact and in order.
+ */
+static void Test_loopback(void)
+{
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+    uint8_t tx[256], rx[1536];
+    uint32_t i, n = 0U;
+    int len;
+
+    for (i = 0U; i < 100U; i++)
+    {
+        memset(tx, (int)i, sizeof(tx));
+        Test_send(ctx, tx, 64U + i);
+        Test_flushTx(ctx);
+        while ((len = Ethernet_receivePacket(ctx, rx, sizeof(rx))) > 0)
+        {
+            CHECK(len == (int)(64U + n));
+            CHECK((rx[0] == (uint8_t)n) && (rx[len - 1] == (uint8_t)n));
+            n++;
+        }
+    }
+    CHECK(n == 100U);
+}
+
+/**
+ *  \brief Each transmit API puts the same frame on the wire, copying it at
+ *  most once, and not at all when built in a loaned DMA buffer.
+ */
+static void Test_txCopies(void)
+{
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+    Ethernet_PerfStats perf;
+    Ethernet_TxFrag frags[3];
+    Ethernet_TxBuf txBuf;
+    Ethernet_RxBuf rxBuf;
+    uint8_t frame[600];
+    uint32_t api, i;
+
+    for (i = 0U; i < sizeof(frame); i++)
+    {
+        frame[i] = (uint8_t)(i * 7U);
+    }
+    frags[0].buf = frame;
+    frags[0].len = 14U;
+    frags[1].buf = &frame[14];
+    frags[1].len = 20U;
+    frags[2].buf = &frame[34];
+    frags[2].len = sizeof(frame) - 34U;
+
+    for (api = 0U; api < 3U; api++)
+    {
+        Ethernet_resetPerfStats(ctx);
+        switch (api)
+        {
+            case 0U:
+                CHECK(Ethernet_sendPacket(ctx, frame, sizeof(frame)) == 0);
+                break;
+            case 1U:
+                CHECK(Ethernet_sendPacketSg(ctx, frags, 3U) == 0);
+                break;
+            default:
+                CHECK(Ethernet_acquireTxBuffer(ctx, &txBuf) == 0);
+                CHECK(txBuf.size >= sizeof(frame));
+                memcpy(txBuf.data, frame, sizeof(frame));
+                CHECK(Ethernet_submitTxBuffer(ctx, &txBuf, sizeof(frame)) == 0);
+                break;
+        }
+        Test_flushTx(ctx);
+        Ethernet_getPerfStats(ctx, &perf);
+        CHECK(perf.txFrames == 1U);
+        CHECK(perf.txBytesCopied == ((api < 2U) ? sizeof(frame) : 0U));
+
+        CHECK(Ethernet_receiveLoan(ctx, &rxBuf, 1U) == 1U);
+        CHECK(rxBuf.len == sizeof(frame));
+        CHECK(memcmp(rxBuf.data, frame, sizeof(frame)) == 0);
+        Ethernet_releaseRxPacket(ctx, &rxBuf);
+        Ethernet_getPerfStats(ctx, &perf);
+        CHECK(perf.rxBytesCopied == 0U);
+    }
+}
+
+/**
+ *  \brief With the pacing queue filling up, only the frames it takes are
+ *  copied into DMA packets.
+ */
+static void Test_txPaceCopies(void)
+{
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+    Ethernet_Frame frames[ETHERNET_CFG_TX_POOL_SIZE];
+    Ethernet_PerfStats perf;
+    uint8_t frame[512];
+    uint32_t accepted = 0U;
+    uint32_t refused = 0U;
+    uint32_t n, i;
+
+    memset(frame, 0x5A, sizeof(frame));
+    for (i = 0U; i < ETHERNET_CFG_TX_POOL_SIZE; i++)
+    {
+        frames[i].buf = frame;
+        frames[i].len = sizeof(frame);
+    }
+
+    /* Completions held, so the queue only drains into the DMA depth */
+    HostSim_setLoopback(ctx->macPort, false);
+    HostSim_holdTx(ctx->macPort, true);
+    Ethernet_resetPerfStats(ctx);
+    for (i = 0U; i < 4U; i++)
+    {
+        n = Ethernet_sendBurst(ctx, frames, 8U);
+        accepted += n;
+        refused += 8U - n;
+    }
+    /* The single frame paths refuse the same way once the queue is full */
+    for (i = 0U; i < 4U; i++)
+    {
+        if (Ethernet_sendPacket(ctx, frame, sizeof(frame)) == 0)
+        {
+            accepted++;
+        }
+        else
+        {
+            refused++;
+        }
+    }
+    CHECK(refused > 0U);
+    Ethernet_getPerfStats(ctx, &perf);
+    CHECK(perf.txBytesCopied == ((uint64_t)accepted * sizeof(frame)));
+
+    HostSim_holdTx(ctx->macPort, false);
+    Test_flushTx(ctx);
+    Ethernet_getPerfStats(ctx, &perf);
+    CHECK(perf.txFrames == accepted);
+}
+
+/**
+ *  \brief Frames sent from one core and reclaimed on another go back to
+ *  the pool of the sending core, leaving the reclaiming core's pool as it
+ *  was.
+ */
+static void Test_txPoolOwner(void)
+{
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+    Ethernet_PoolStats pool0, pool1;
+    uint8_t frame[64];
+    uint32_t i, tries;
+
+    memset(frame, 0x3C, sizeof(frame));
+    HostSim_setLoopback(ENET_MAC_PORT, false);
+    for (i = 0U; i < (ETHERNET_CFG_TX_POOL_SIZE * 4U); i++)
+    {
+        HostSim_setCoreId(1U);
+        for (tries = 0U; Ethernet_sendPacket(ctx, frame, sizeof(frame)) != 0; tries++)
+        {
+            CHECK(tries < 100000U);
+            HostSim_setCoreId(0U);
+            HostSim_poll();
+            Ethernet_reclaimTx(ctx);
+            HostSim_setCoreId(1U);
+        }
+    }
+    HostSim_setCoreId(0U);
+    Test_flushTx(ctx);
+
+    Ethernet_getPoolStats(ctx, 0U, &pool0);
+    Ethernet_getPoolStats(ctx, 1U, &pool1);
+    CHECK(pool0.freeCnt == pool0.size);
+    CHECK(pool1.freeCnt == pool1.size);
+    CHECK(pool1.minFree < pool1.size);
+}
+
+/**
+ *  \brief With two channels, frames are steered by flow to a worker thread
+ *  per channel standing in for a core each. Every flow stays on one
+ *  channel and in order while the workers run concurrently with the
+ *  device task.
+ */
+static void Test_flowSteering(void)
+{
+    static Test_Worker workers[2];
+    Ethernet_PortCfg cfg;
+    Lan8720_Ctx *ctx;
+    Ethernet_ChanStats chanStats;
+    uint8_t frame[TEST_FLOW_FRAME_LEN];
+    uint32_t flow, seq, c, done;
+
+    Ethernet_initPortCfg(&cfg);
+    cfg.numChans = 2U;
+    ctx = Test_openPort(&cfg);
+
+    memset(workers, 0, sizeof(workers));
+    for (flow = 0U; flow < TEST_FLOWS; flow++)
+    {
+        Test_udpFrame(frame, flow, 0U);
+        workers[Ethernet_flowChannel(ctx, frame, sizeof(frame))].expected += TEST_FLOW_FRAMES;
+    }
+    for (c = 0U; c < 2U; c++)
+    {
+        CHECK(workers[c].expected > 0U);
+        workers[c].ctx = ctx;
+        workers[c].chIdx = c;
+        CHECK(pthread_create(&workers[c].thread, NULL, Test_chanWorker, &workers[c]) == 0);
+    }
+
+    /* This thread plays the device task */
+    for (seq = 0U; seq < TEST_FLOW_FRAMES; seq++)
+    {
+        for (flow = 0U; flow < TEST_FLOWS; flow++)
+        {
+            Test_udpFrame(frame, flow, seq);
+            while (HostSim_injectRx(cfg.macPort, frame, sizeof(frame)) != 0)
+            {
+                HostSim_poll();
+                Ethernet_drainRx(ctx, UINT32_MAX);
+            }
+        }
+    }
+    do
+    {
+        HostSim_poll();
+        Ethernet_drainRx(ctx, UINT32_MAX);
+        done = 0U;
+        for (c = 0U; c < 2U; c++)
+        {
+            done += __atomic_load_n(&workers[c].received, __ATOMIC_ACQUIRE);
+        }
+    } while (done < (TEST_FLOWS * TEST_FLOW_FRAMES));
+
+    for (c = 0U; c < 2U; c++)
+    {
+        pthread_join(workers[c].thread, NULL);
+        memset(&chanStats, 0, sizeof(chanStats));
+        Ethernet_getChanStats(ctx, c, &chanStats);
+        CHECK(chanStats.steered == workers[c].expected);
+        CHECK(chanStats.rxFrames == workers[c].expected);
+    }
+}
+
+/**
+ *  \brief A producer and a consumer thread pass packets through a ring and
+ *  back through a second one, as the device task and a channel worker do,
+ *  with more packets than ring slots and the consumer regularly sleeping
+ *  on an empty ring. Every packet must arrive exactly once and in order.
+ */
+static void Test_ringStress(void)
+{
+    static Test_RingPair rp;
+    EnetDma_Pkt *pkts[ETHERNET_RX_DRAIN_BATCH];
+    EnetDma_PktQ freeQueue, batchQueue;
+    EnetDma_Pkt *pkt;
+    pthread_t consumer;
+    uint32_t seq = 0U, rand = 1U;
+    uint32_t count, batch, i;
+
+    Ethernet_ringInit(&rp.rxRing, true);
+    Ethernet_ringInit(&rp.freeRing, false);
+    EnetQueue_initQ(&freeQueue);
+    EnetQueue_initQ(&batchQueue);
+    for (i = 0U; i < TEST_RING_PKTS; i++)
+    {
+        EnetQueue_enq(&freeQueue, &rp.pkts[i].node);
+    }
+    CHECK(pthread_create(&consumer, NULL, Test_ringConsumer, &rp) == 0);
+
+    /* Runs until every packet has come back */
+    while ((seq < TEST_RING_ROUNDS) || (EnetQueue_getQCount(&freeQueue) < TEST_RING_PKTS))
+    {
+        do
+        {
+            count = Ethernet_ringGet(&rp.freeRing, pkts, ETHERNET_RX_DRAIN_BATCH);
+            for (i = 0U; i < count; i++)
+            {
+                EnetQueue_enq(&freeQueue, &pkts[i]->node);
+            }
+        } while (count == ETHERNET_RX_DRAIN_BATCH);
+
+        /* Packets the ring had no room for stay first in line */
+        rand = (rand * 1103515245U) + 12345U;
+        batch = 1U + ((rand >> 16) % 12U);
+        while ((EnetQueue_getQCount(&batchQueue) < batch) && (seq < TEST_RING_ROUNDS) &&
+               ((pkt = (EnetDma_Pkt *)EnetQueue_deq(&freeQueue)) != NULL))
+        {
+            pkt->userBufLen = seq++;
+            EnetQueue_enq(&batchQueue, &pkt->node);
+        }
+        if (Ethernet_ringPut(&rp.rxRing, &batchQueue) == 0U)
+        {
+            sched_yield();
+        }
+
+        if ((seq % 4096U) < batch)
+        {
+            /* Let the consumer run dry and go to sleep */
+            usleep(100U);
+        }
+    }
+    pthread_join(consumer, NULL);
+
+    CHECK(seq == TEST_RING_ROUNDS);
+    CHECK((Ethernet_ringCount(&rp.rxRing) == 0U) && (Ethernet_ringCount(&rp.freeRing) == 0U));
+}
+
+/**
+ *  \brief With the link handed to the simulated MDIO controller, the link
+ *  state is a register read that costs no MDIO frame, and link changes
+ *  come in through the MDIO link interrupt.
+ */
+static void Test_hwLinkPoll(void)
+{
+    CSL_mdioRegs *mdioRegs = HostSim_mdioRegs();
+    HostSim_Stats stats;
+    Lan8720_Ctx *ctx = Test_openDefaultPort();
+    uint32_t phyAddr = ctx->phyCfg.phyAddr;
+    uint32_t i;
+
+    HostSim_setIsr(HOSTSIM_IRQ_MDIO_LINK, 0U, Test_mdioLinkIsr, NULL);
+    HostSim_poll();
+    CHECK(Ethernet_enableHwLinkPoll(ctx, (uintptr_t)mdioRegs) == 0);
+    CHECK(ctx->linkGroup >= 0);
+
+    HostSim_poll();
+    HostSim_resetStats();
+    for (i = 0U; i < 100U; i++)
+    {
+        CHECK(Ethernet_getStatus(ctx) == 1U);
+    }
+    HostSim_getStats(&stats);
+    CHECK((stats.mdioReads == 0U) && (stats.mdioWrites == 0U));
+    CHECK(stats.irqs[HOSTSIM_IRQ_MDIO_LINK] == 0U);
+
+    HostSim_setLink(phyAddr, false);
+    HostSim_poll();
+    CHECK(Ethernet_getStatus(ctx) == 0U);
+    HostSim_getStats(&stats);
+    CHECK(stats.irqs[HOSTSIM_IRQ_MDIO_LINK] == 1U);
+    /* The handler acknowledged it */
+    CHECK(mdioRegs->LINK_INT_RAW_REG == 0U);
+
+    HostSim_setLink(phyAddr, true);
+    HostSim_poll();
+    CHECK(Ethernet_getStatus(ctx) == 1U);
+    HostSim_getStats(&stats);
+    CHECK(stats.irqs[HOSTSIM_IRQ_MDIO_LINK] == 2U);
+    CHECK((stats.mdioReads == 0U) && (stats.mdioWrites == 0U));
+
+    /* Back to reading the PHY */
+    Ethernet_disableHwLinkPoll(ctx);
+    CHECK(mdioRegs->USER_GROUP[0].USER_PHY_SEL_REG == 0U);
+    CHECK(Ethernet_getStatus(ctx) == 1U);
+    HostSim_getStats(&stats);
+    CHECK(stats.mdioReads > 0U);
+}
+
+/**
+ *  \brief An extended register read-modify-write missing the shadow reads
+ *  and writes in one MMD window, on its own as in a batch, and leaves out
+ *  the write when nothing changes.
+ */
+static void Test_extRmw(void)
+{
+    EnetPhy_Obj phy = { TEST_MMD_PHY_ADDR };
+    HostSim_Stats stats;
+
+    HostSim_addPhy(TEST_MMD_PHY_ADDR);
+    HostSim_setExtReg(TEST_MMD_PHY_ADDR, TEST_MMD_QUEUE_REG, 0x1200U);
+    HostSim_setExtReg(TEST_MMD_PHY_ADDR, LAN8720_RMIICTL, 0x0001U);
+
+    HostSim_resetStats();
+    Lan8720_rmwExtReg(&phy, TEST_MMD_QUEUE_REG, 0x00FFU, 0x0034U);
+    HostSim_getStats(&stats);
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_MMD_QUEUE_REG) == 0x1234U);
+    CHECK(stats.mmdFrames == 5U);
+
+    HostSim_resetStats();
+    Lan8720_rmwExtReg(&phy, TEST_MMD_QUEUE_REG, 0x00FFU, 0x0034U);
+    HostSim_getStats(&stats);
+    CHECK(stats.mmdFrames == 4U);
+
+    /* Shadowed: the miss fills the shadow, the next one reads nothing */
+    HostSim_resetStats();
+    Lan8720_rmwExtReg(&phy, LAN8720_RMIICTL, RMIICTL_RMIIEN, RMIICTL_RMIIEN);
+    HostSim_getStats(&stats);
+    CHECK(stats.mmdFrames == 5U);
+    HostSim_resetStats();
+    Lan8720_rmwExtReg(&phy, LAN8720_RMIICTL, RMIICTL_RMIIEN, 0U);
+    HostSim_getStats(&stats);
+    CHECK(stats.mmdFrames == 4U);
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, LAN8720_RMIICTL) == 0x0001U);
+
+    HostSim_resetStats();
+    Lan8720_beginExtBatch(&phy);
+    Lan8720_rmwExtReg(&phy, TEST_MMD_QUEUE_REG, 0xFF00U, 0x5600U);
+    CHECK(Lan8720_commitExtBatch(&phy) == ENETPHY_SOK);
+    HostSim_getStats(&stats);
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_MMD_QUEUE_REG) == 0x5634U);
+    CHECK(stats.mmdFrames == 5U);
+}
+
+/**
+ *  \brief A run of consecutive extended registers is written and read back
+ *  with the MMD window set up once, one MDIO frame per further register.
+ */
+static void Test_extRegRun(void)
+{
+    EnetPhy_Obj phy = { TEST_MMD_PHY_ADDR };
+    Lan8720_MdioStats before, after;
+    uint16_t vals[TEST_EXT_RUN_LEN], back[TEST_EXT_RUN_LEN];
+    uint16_t next;
+    uint32_t i;
+
+    HostSim_addPhy(TEST_MMD_PHY_ADDR);
+    next = HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_EXT_RUN_REG + TEST_EXT_RUN_LEN);
+    for (i = 0U; i < TEST_EXT_RUN_LEN; i++)
+    {
+        vals[i] = (uint16_t)(0xA500U + i);
+    }
+
+    Lan8720_getMdioStats(TEST_MMD_PHY_ADDR, &before);
+    CHECK(Lan8720_writeExtRegs(&phy, TEST_EXT_RUN_REG, vals, TEST_EXT_RUN_LEN) == ENETPHY_SOK);
+    Lan8720_getMdioStats(TEST_MMD_PHY_ADDR, &after);
+    CHECK((after.writes - before.writes) == (3U + TEST_EXT_RUN_LEN));
+    CHECK(after.reads == before.reads);
+    for (i = 0U; i < TEST_EXT_RUN_LEN; i++)
+    {
+        CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_EXT_RUN_REG + i) == vals[i]);
+    }
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_EXT_RUN_REG + TEST_EXT_RUN_LEN) == next);
+
+    before = after;
+    CHECK(Lan8720_readExtRegs(&phy, TEST_EXT_RUN_REG, back, TEST_EXT_RUN_LEN) == ENETPHY_SOK);
+    Lan8720_getMdioStats(TEST_MMD_PHY_ADDR, &after);
+    CHECK((after.writes - before.writes) == 3U);
+    CHECK((after.reads - before.reads) == TEST_EXT_RUN_LEN);
+    CHECK(memcmp(back, vals, sizeof(vals)) == 0);
+
+    /* Empty runs and runs past the last register are refused */
+    CHECK(Lan8720_readExtRegs(&phy, TEST_EXT_RUN_REG, back, 0U) == ENETPHY_EINVALIDPARAMS);
+    CHECK(Lan8720_writeExtRegs(&phy, 0xFFFEU, vals, 3U) == ENETPHY_EINVALIDPARAMS);
+    Lan8720_getMdioStats(TEST_MMD_PHY_ADDR, &before);
+    CHECK((before.reads == after.reads) && (before.writes == after.writes));
+}
+
+/**
+ *  \brief Extended register requests of the MDIO queue and blocking
+ *  extended register accesses to the same PHY share its MMD window without
+ *  corrupting each other's sequence, as the simulated PHY would latch any
+ *  stray address or data frame.
+ */
+static void Test_mmdShared(void)
+{
+    static uint16_t before[0x400];
+    EnetPhy_Obj phy = { TEST_MMD_PHY_ADDR };
+    uint32_t posted = 0U, done = 0U;
+    uint32_t i, j, reg, tries;
+    uint16_t val;
+
+    HostSim_addPhy(TEST_MMD_PHY_ADDR);
+    for (reg = 0U; reg < 0x400U; reg++)
+    {
+        before[reg] = HostSim_getExtReg(TEST_MMD_PHY_ADDR, reg);
+    }
+    HostSim_setIsr(HOSTSIM_IRQ_MDIO_USER, 0U, Test_mdioQueueIsr, NULL);
+    CHECK(Lan8720_openMdioQueue((uintptr_t)HostSim_mdioRegs()) == ENETPHY_SOK);
+    HostSim_startHw(TEST_HW_PERIOD_US);
+
+    for (i = 1U; i <= TEST_MMD_ROUNDS; i++)
+    {
+        for (j = 0U; j < 2U; j++)
+        {
+            for (tries = 0U;
+                 Lan8720_postMdio(TEST_MMD_PHY_ADDR, LAN8720_MDIO_OP_EXT_WRITE, TEST_MMD_QUEUE_REG,
+                                  0U, (uint16_t)i, Test_mdioDone, &done) != ENETPHY_SOK;
+                 tries++)
+            {
+                CHECK(tries < 1000U);
+                EnetOsal_sleep(1U);
+            }
+            posted++;
+        }
+        CHECK(Lan8720_writeExtReg(&phy, TEST_MMD_BLOCK_REG, (uint16_t)i) == ENETPHY_SOK);
+        CHECK(Lan8720_readExtReg(&phy, TEST_MMD_BLOCK_REG, &val) == ENETPHY_SOK);
+        CHECK(val == (uint16_t)i);
+    }
+    for (tries = 0U; __atomic_load_n(&done, __ATOMIC_RELAXED) != posted; tries++)
+    {
+        CHECK(tries < 1000U);
+        EnetOsal_sleep(1U);
+    }
+    HostSim_stopHw();
+
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_MMD_QUEUE_REG) == TEST_MMD_ROUNDS);
+    CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, TEST_MMD_BLOCK_REG) == TEST_MMD_ROUNDS);
+    for (reg = 0U; reg < 0x400U; reg++)
+    {
+        if ((reg != TEST_MMD_QUEUE_REG) && (reg != TEST_MMD_BLOCK_REG))
+        {
+            CHECK(HostSim_getExtReg(TEST_MMD_PHY_ADDR, reg) == before[reg]);
+        }
+    }
+}
+
+/**
+ *  \brief A PHY reset drops fast MDIO and leaves no preamble bypass bit
+ *  set in the other PHYs.
+ */
+static void Test_fastMdioReset(void)
+{
+    Ethernet_PortCfg cfg;
+    Lan8720_Ctx *ctx1, *ctx2;
+
+    ctx1 = Test_openDefaultPort();
+    Ethernet_initPortCfg(&cfg);
+    cfg.macPort = ENET_MAC_PORT_2;
+    cfg.phyAddr = ENET_PHY_ADDR + 1U;
+    ctx2 = Test_openPort(&cfg);
+    CHECK(Ethernet_enableFastMdio((uintptr_t)HostSim_mdioRegs()) == 0);
+    CHECK((HostSim_getReg(ENET_PHY_ADDR + 1U, LAN8720_MODE_CTRL_STATUS) &
+           MODE_CTRL_STATUS_MDPREBP) != 0U);
+
+    Lan8720_reset(ctx1->hPhy);
+    CHECK(fastMdioRegs == NULL);
+    CHECK((HostSim_getReg(ENET_PHY_ADDR + 1U, LAN8720_MODE_CTRL_STATUS) &
+           MODE_CTRL_STATUS_MDPREBP) == 0U);
+    CHECK(Ethernet_getStatus(ctx2) == 1U);
+}
+
+/**
+ *  \brief A loaned frame released by the application while the device
+ *  task hands the released ones back to the DMA is not lost.
+ */
+static void Test_rxReleaseRace(void)
+{
+    static Test_Releaser r;
+    Ethernet_RxBuf rxBufs[2];
+    uint8_t frame[64];
+    uint32_t i;
+
+    r.ctx = Test_openDefaultPort();
+    memset(frame, 0x77, sizeof(frame));
+    for (i = 0U; i < TEST_RX_REL_ROUNDS; i++)
+    {
+        CHECK(HostSim_injectRx(ENET_MAC_PORT, frame, sizeof(frame)) == 0);
+        CHECK(HostSim_injectRx(ENET_MAC_PORT, frame, sizeof(frame)) == 0);
+        CHECK(Ethernet_receiveLoan(r.ctx, rxBufs, 2U) == 2U);
+        Ethernet_releaseRxPacket(r.ctx, &rxBufs[0]);
+
+        /* The device task recycles the first one on an idle wakeup, the
+         * second one is released in the middle of it */
+        r.rxBuf = rxBufs[1];
+        r.done = false;
+        HostSim_setRxSubmitHook(ENET_MAC_PORT, Test_rxSubmitHook, &r);
+        Ethernet_refillRxFreeQ(r.ctx);
+        pthread_join(r.thread, NULL);
+        CHECK(r.done);
+
+        Ethernet_refillRxFreeQ(r.ctx);
+        CHECK(HostSim_rxFreeCount(ENET_MAC_PORT) == ETHERNET_CFG_RX_POOL_SIZE);
+    }
+}
+
+/**
+ *  \brief With a single RX channel the frames stay in place for the
+ *  application while the device task runs, so the receive calls keep
+ *  getting frames well past the size of the RX pool. In event mode the
+ *  RX interrupts switch the device task to busy polling the DMA for them.
+ */
+static void Test_rxInPlace(void)
+{
+    static Ethernet_PortCfg cfg;
+    Lan8720_Ctx *ctx;
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    Ethernet_RxPollStats pollStats;
+    HostSim_Stats stats;
+#endif
+    uint8_t tx[128], rx[1536];
+    uint64_t start;
+    uint32_t i, n;
+    int len;
+
+    Ethernet_initPortCfg(&cfg);
+    ctx = Test_startDevice(&cfg);
+
+    for (i = 0U; i < (4U * ETHERNET_CFG_RX_POOL_SIZE); i += ETHERNET_RX_REFILL_BATCH)
+    {
+        for (n = 0U; n < ETHERNET_RX_REFILL_BATCH; n++)
+        {
+            memset(tx, (int)(i + n), sizeof(tx));
+            CHECK(HostSim_injectRx(cfg.macPort, tx, sizeof(tx)) == 0);
+        }
+        /* Give the device task time to see the RX interrupt */
+        EnetOsal_sleep(5U);
+        start = Test_nowMs();
+        for (n = 0U; n < ETHERNET_RX_REFILL_BATCH; n++)
+        {
+            while ((len = Ethernet_receivePacket(ctx, rx, sizeof(rx))) < 0)
+            {
+                CHECK((Test_nowMs() - start) < TEST_EVENT_MS);
+                EnetOsal_sleep(1U);
+            }
+            memset(tx, (int)(i + n), sizeof(tx));
+            CHECK((len == (int)sizeof(tx)) && (memcmp(rx, tx, sizeof(tx)) == 0));
+        }
+    }
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    Ethernet_getRxPollStats(ctx, &pollStats);
+    CHECK((pollStats.intrToPoll > 0U) && (pollStats.pktsPolled > 0U));
+    HostSim_getStats(&stats);
+    CHECK(stats.yields > 0U);
+#endif
+}
+
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+/**
+ *  \brief The device task is driven by interrupts alone: the hardware runs
+ *  in its own thread, cable changes reach the task through the PHY nINT
+ *  line and received frames through the DMA RX interrupt, well before the
+ *  task's idle timeout would have noticed them. Buffers released short of
+ *  a full batch still make it back to the DMA.
+ */
+static void Test_eventMode(void)
+{
+    static Ethernet_PortCfg cfg;
+    Lan8720_Ctx *ctx;
+    Ethernet_ChanStats chanStats;
+    Ethernet_RxBuf rxBuf;
+    HostSim_Stats stats;
+    uint8_t frame[128];
+    uint64_t start;
+    uint32_t i, c;
+
+    Ethernet_initPortCfg(&cfg);
+    cfg.numChans = 2U;
+    ctx = Test_startDevice(&cfg);
+    memset(&chanStats, 0, sizeof(chanStats));
+
+    for (i = 0U; i < 3U; i++)
+    {
+        HostSim_resetStats();
+        HostSim_setLink(cfg.phyAddr, false);
+        CHECK(Test_waitLink(ctx, false, TEST_EVENT_MS) < TEST_EVENT_MS);
+        HostSim_setLink(cfg.phyAddr, true);
+        Test_waitLink(ctx, true, TEST_LINK_TIMEOUT_MS);
+        HostSim_getStats(&stats);
+        CHECK(stats.irqs[HOSTSIM_IRQ_PHY] >= 2U);
+    }
+
+    /* Fewer frames than a recycling batch */
+    CHECK(ETHERNET_RX_REFILL_BATCH > 3U);
+    for (i = 0U; i < 3U; i++)
+    {
+        memset(frame, (int)i, sizeof(frame));
+        c = Ethernet_flowChannel(ctx, frame, sizeof(frame));
+        start = Test_nowMs();
+        CHECK(HostSim_injectRx(cfg.macPort, frame, sizeof(frame)) == 0);
+        do
+        {
+            CHECK((Test_nowMs() - start) < TEST_EVENT_MS);
+            EnetOsal_sleep(1U);
+            Ethernet_getChanStats(ctx, c, &chanStats);
+        } while (chanStats.steered == chanStats.rxFrames);
+
+        /* The frame is there already, the call does not sleep */
+        CHECK(Ethernet_receiveChan(ctx, c, &rxBuf, 1U, true) == 1U);
+        CHECK((rxBuf.len == sizeof(frame)) && (memcmp(rxBuf.data, frame, sizeof(frame)) == 0));
+        Ethernet_releaseChanPacket(ctx, c, &rxBuf);
+        Ethernet_getChanStats(ctx, c, &chanStats);
+        CHECK(chanStats.wakeups == 0U);
+    }
+    HostSim_getStats(&stats);
+    CHECK(stats.irqs[HOSTSIM_IRQ_DMA_RX] >= 1U);
+
+    start = Test_nowMs();
+    while (HostSim_rxFreeCount(cfg.macPort) < ETHERNET_CFG_RX_POOL_SIZE)
+    {
+        CHECK((Test_nowMs() - start) < TEST_EVENT_MS);
+        EnetOsal_sleep(1U);
+    }
+}
+#endif
+
+static const Test_Case testCases[] =
+{
+    { "bring_up",        Test_bringUp },
+    { "fast_link",       Test_fastLink },
+    { "phy_config",      Test_phyConfig },
+    { "phy_reconfig",    Test_phyReconfig },
+    { "loopback",        Test_loopback },
+    { "tx_copies",       Test_txCopies },
+    { "tx_pace_copies",  Test_txPaceCopies },
+    { "tx_pool_owner",   Test_txPoolOwner },
+    { "flow_steering",   Test_flowSteering },
+    { "ring_stress",     Test_ringStress },
+    { "hw_link_poll",    Test_hwLinkPoll },
+    { "ext_rmw",         Test_extRmw },
+    { "mmd_shared",      Test_mmdShared },
+    { "ext_reg_run",     Test_extRegRun },
+    { "fast_mdio_reset", Test_fastMdioReset },
+    { "rx_in_place",     Test_rxInPlace },
+    { "rx_release_race", Test_rxReleaseRace },
+#if (ETHERNET_CFG_EVENT_MODE == 1)
+    { "event_mode",      Test_eventMode },
+#endif
+};
+
+/* ========================================================================== */
+/*                               Runner                                       */
+/* ========================================================================== */
+
+static bool Test_selected(const char *name, int argc, char **argv)
+{
+    int i;
+
+    if (argc <= 1)
+    {
+        return true;
+    }
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t run = 0U, failed = 0U;
+    uint32_t i;
+    pid_t pid;
+    int wstatus;
+
+    printf("LAN8720 host tests (%s mode)\n", (ETHERNET_CFG_EVENT_MODE == 1) ? "event" : "polled");
+    for (i = 0U; i < (sizeof(testCases) / sizeof(testCases[0])); i++)
+    {
+        if (!Test_selected(testCases[i].name, argc, argv))
+        {
+            continue;
+        }
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0)
+        {
+            /* The driver is chatty, keep its output for failures only */
+            if (freopen("/dev/null", "w", stdout) == NULL)
+            {
+                exit(1);
+            }
+            alarm(TEST_TIMEOUT_S);
+            HostSim_init();
+            testCases[i].fn();
+            exit(0);
+        }
+        waitpid(pid, &wstatus, 0);
+        run++;
+        if (WIFEXITED(wstatus) && (WEXITSTATUS(wstatus) == 0))
+        {
+            printf("  PASS  %s\n", testCases[i].name);
+        }
+        else
+        {
+            failed++;
+            printf("  FAIL  %s\n", testCases[i].name);
+        }
+    }
+    printf("%u run, %u failed\n", (unsigned)run, (unsigned)failed);
+    return (failed == 0U) ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+/*
+ * Host stand-in for the private EnetPhy definitions: the clause 22 MMD
+ * access window.
+ */
+#ifndef ENETPHY_PRIV_H_
+#define ENETPHY_PRIV_H_
+
+#include <ti/drv/enet/include/phy/enetphy.h>
+
+#define PHY_MMD_CR               (0x0DU)
+#define PHY_MMD_DR               (0x0EU)
+
+#define MMD_CR_ADDR              (0x0000U)
+#define MMD_CR_DATA_NOPOSTINC    (0x4000U)
+#define MMD_CR_DATA_POSTINC_RW   (0x8000U)
+#define MMD_CR_DATA_POSTINC_W    (0xC000U)
+#define MMD_CR_FUNC_MASK         (0xC000U)
+#define MMD_CR_DEVADDR           (0x001FU)
+
+#define ENETPHY_DIV_ROUNDUP(val, div)  (((val) + (div) - 1U) / (div))
+
+#endif /* ENETPHY_PRIV_H_ */
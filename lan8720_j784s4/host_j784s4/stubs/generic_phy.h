@@ -0,0 +1,10 @@
+/*
+ * Host stand-in for the generic PHY helpers, not used by the LAN8720
+ * driver beyond the include.
+ */
+#ifndef GENERIC_PHY_H_
+#define GENERIC_PHY_H_
+
+#include <ti/drv/enet/include/phy/enetphy.h>
+
+#endif /* GENERIC_PHY_H_ */
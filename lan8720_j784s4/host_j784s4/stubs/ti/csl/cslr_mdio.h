@@ -0,0 +1,73 @@
+/*
+ * Host stand-in for the MDIO controller register layout. Register writes go
+ * through HostSim_regWrite32() so that the simulated controller can apply
+ * the write-one-to-clear/set semantics and start USERACCESS frames; any
+ * other address is written as plain memory.
+ */
+#ifndef CSLR_MDIO_H_
+#define CSLR_MDIO_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    volatile uint32_t USER_ACCESS_REG;
+    volatile uint32_t USER_PHY_SEL_REG;
+} CSL_MdioUser_groupRegs;
+
+typedef struct
+{
+    volatile uint32_t VERSION_REG;
+    volatile uint32_t CONTROL_REG;
+    volatile uint32_t ALIVE_REG;
+    volatile uint32_t LINK_REG;
+    volatile uint32_t LINK_INT_RAW_REG;
+    volatile uint32_t LINK_INT_MASKED_REG;
+    volatile uint32_t LINK_INT_MASK_SET_REG;
+    volatile uint32_t LINK_INT_MASK_CLEAR_REG;
+    volatile uint32_t USER_INT_RAW_REG;
+    volatile uint32_t USER_INT_MASKED_REG;
+    volatile uint32_t USER_INT_MASK_SET_REG;
+    volatile uint32_t USER_INT_MASK_CLEAR_REG;
+    volatile uint8_t  RSVD0[80];
+    CSL_MdioUser_groupRegs USER_GROUP[2];
+} CSL_mdioRegs;
+
+#define CSL_MDIO_CONTROL_REG_PREAMBLE_MASK                          (0x00100000U)
+#define CSL_MDIO_CONTROL_REG_PREAMBLE_SHIFT                         (20U)
+
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_PHYADR_MON_MASK        (0x0000001FU)
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_PHYADR_MON_SHIFT       (0U)
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKINT_ENABLE_MASK    (0x00000040U)
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKINT_ENABLE_SHIFT   (6U)
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKSEL_MASK           (0x00000080U)
+#define CSL_MDIO_USER_GROUP_USER_PHY_SEL_REG_LINKSEL_SHIFT          (7U)
+
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_GO_MASK                 (0x80000000U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_WRITE_MASK              (0x40000000U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_ACK_MASK                (0x20000000U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_MASK             (0x03E00000U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_REGADR_SHIFT            (21U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_MASK             (0x001F0000U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_PHYADR_SHIFT            (16U)
+#define CSL_MDIO_USER_GROUP_USER_ACCESS_REG_DATA_MASK               (0x0000FFFFU)
+
+void HostSim_regWrite32(volatile uint32_t *addr, uint32_t val);
+
+#define CSL_REG32_RD(p)         (*(volatile const uint32_t *)(p))
+#define CSL_REG32_WR(p, v)      HostSim_regWrite32((volatile uint32_t *)(p), (uint32_t)(v))
+#define CSL_REG32_FEXT(p, fld)  \
+    ((CSL_REG32_RD(p) & CSL_##fld##_MASK) >> CSL_##fld##_SHIFT)
+#define CSL_REG32_FINS(p, fld, v) \
+    CSL_REG32_WR(p, (CSL_REG32_RD(p) & ~CSL_##fld##_MASK) | \
+                    (((uint32_t)(v) << CSL_##fld##_SHIFT) & CSL_##fld##_MASK))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CSLR_MDIO_H_ */
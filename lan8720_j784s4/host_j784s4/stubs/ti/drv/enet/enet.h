@@ -0,0 +1,88 @@
+/*
+ * Host stand-in for the subset of the Enet LLD used by the LAN8720 driver.
+ * Implemented by src/host_sim.c on top of a loopback DMA.
+ */
+#ifndef ENET_H_
+#define ENET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENET_SOK        (0)
+#define ENET_EFAIL      (-1)
+
+typedef struct Enet_Obj_s *Enet_Handle;
+
+typedef struct Enet_IoctlPrms_s
+{
+    const void *inArgs;
+    uint32_t inArgsSize;
+    void *outArgs;
+    uint32_t outArgsSize;
+} Enet_IoctlPrms;
+
+typedef enum Enet_MacPort_e
+{
+    ENET_MAC_PORT_1 = 0U,
+    ENET_MAC_PORT_2 = 1U,
+    ENET_MAC_PORT_3 = 2U,
+    ENET_MAC_PORT_4 = 3U,
+} Enet_MacPort;
+
+typedef struct EnetQ_Node_s
+{
+    struct EnetQ_Node_s *next;
+} EnetQ_Node;
+
+typedef struct EnetDma_PktQ_s
+{
+    EnetQ_Node *head;
+    EnetQ_Node *tail;
+    uint32_t count;
+} EnetDma_PktQ;
+
+typedef struct EnetDma_Pkt_s
+{
+    EnetQ_Node node;
+    uint8_t *bufPtr;
+    uint32_t orgBufLen;
+    uint32_t userBufLen;
+    void *appPriv;
+} EnetDma_Pkt;
+
+void Enet_init(void);
+int32_t Enet_open(Enet_Handle hEnet, Enet_IoctlPrms *prms);
+int32_t Enet_ioctl(Enet_Handle hEnet, uint32_t cmd, void *arg, Enet_IoctlPrms *prms);
+
+EnetDma_Pkt *EnetDma_allocPkt(Enet_Handle hEnet, uint32_t dir);
+void EnetDma_freePkt(Enet_Handle hEnet, EnetDma_Pkt *pkt);
+int32_t EnetDma_submitTxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ);
+int32_t EnetDma_retrieveTxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ);
+int32_t EnetDma_submitRxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ);
+int32_t EnetDma_retrieveRxPktQ(Enet_Handle hEnet, Enet_MacPort macPort, EnetDma_PktQ *pktQ);
+int32_t EnetDma_enableRxEvent(Enet_Handle hEnet, Enet_MacPort macPort);
+int32_t EnetDma_disableRxEvent(Enet_Handle hEnet, Enet_MacPort macPort);
+
+void EnetQueue_initQ(EnetDma_PktQ *queue);
+void EnetQueue_enq(EnetDma_PktQ *queue, EnetQ_Node *node);
+void EnetQueue_enqHead(EnetDma_PktQ *queue, EnetQ_Node *node);
+EnetQ_Node *EnetQueue_deq(EnetDma_PktQ *queue);
+uint32_t EnetQueue_getQCount(EnetDma_PktQ *queue);
+void EnetQueue_append(EnetDma_PktQ *dst, EnetDma_PktQ *src);
+
+uintptr_t EnetOsal_disableAllIntr(void);
+void EnetOsal_restoreAllIntr(uintptr_t key);
+void EnetOsal_sleep(uint32_t ms);
+
+uint32_t EnetSoc_getCoreId(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENET_H_ */
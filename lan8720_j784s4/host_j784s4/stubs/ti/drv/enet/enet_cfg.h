@@ -0,0 +1,18 @@
+/*
+ * Host stand-in for the Enet LLD build configuration.
+ */
+#ifndef ENET_CFG_H_
+#define ENET_CFG_H_
+
+#define ENET_CFG_TRACE_LEVEL_NONE     (0)
+#define ENET_CFG_TRACE_LEVEL_ERROR    (1)
+#define ENET_CFG_TRACE_LEVEL_WARN     (2)
+#define ENET_CFG_TRACE_LEVEL_INFO     (3)
+#define ENET_CFG_TRACE_LEVEL_DEBUG    (4)
+#define ENET_CFG_TRACE_LEVEL_VERBOSE  (5)
+
+#ifndef ENET_CFG_TRACE_LEVEL
+#define ENET_CFG_TRACE_LEVEL          ENET_CFG_TRACE_LEVEL_INFO
+#endif
+
+#endif /* ENET_CFG_H_ */
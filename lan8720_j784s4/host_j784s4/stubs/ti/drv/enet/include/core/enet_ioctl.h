@@ -0,0 +1,10 @@
+/*
+ * Host stand-in for the Enet LLD IOCTL definitions. The driver only uses
+ * commands it defines itself.
+ */
+#ifndef ENET_IOCTL_H_
+#define ENET_IOCTL_H_
+
+#include <ti/drv/enet/enet.h>
+
+#endif /* ENET_IOCTL_H_ */
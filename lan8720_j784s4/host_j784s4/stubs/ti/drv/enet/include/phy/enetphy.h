@@ -0,0 +1,77 @@
+/*
+ * Host stand-in for the EnetPhy interface. EnetPhy_open() only binds the
+ * handle to a PHY of the simulated MDIO bus; the LAN8720 driver runs the
+ * bring-up itself.
+ */
+#ifndef ENETPHY_H_
+#define ENETPHY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <ti/drv/enet/enet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ENETPHY_SOK             (0)
+#define ENETPHY_EFAIL           (-1)
+#define ENETPHY_EBADARGS        (-2)
+#define ENETPHY_EINVALIDPARAMS  (-3)
+#define ENETPHY_ETIMEOUT        (-4)
+#define ENETPHY_EALLOC          (-5)
+#define ENETPHY_EUNEXPECTED     (-6)
+#define ENETPHY_EPERM           (-7)
+#define ENETPHY_ENOTSUPPORTED   (-8)
+
+typedef enum EnetPhy_Mii_e
+{
+    ENETPHY_MAC_MII_MII   = 0U,
+    ENETPHY_MAC_MII_RMII  = 1U,
+    ENETPHY_MAC_MII_RGMII = 2U,
+} EnetPhy_Mii;
+
+typedef struct EnetPhy_Version_s
+{
+    uint32_t oui;
+    uint32_t model;
+    uint32_t revision;
+} EnetPhy_Version;
+
+typedef struct EnetPhy_Cfg_s
+{
+    uint32_t phyAddr;
+    const void *extendedCfg;
+    uint32_t extendedCfgSize;
+} EnetPhy_Cfg;
+
+typedef struct EnetPhy_Obj_s
+{
+    uint32_t addr;
+} EnetPhy_Obj;
+
+typedef EnetPhy_Obj *EnetPhy_Handle;
+
+typedef struct EnetPhy_Drv_s
+{
+    const char *name;
+    bool (*isPhyDevSupported)(EnetPhy_Handle hPhy, const EnetPhy_Version *version);
+    bool (*isMacModeSupported)(EnetPhy_Handle hPhy, EnetPhy_Mii mii);
+    int32_t (*config)(EnetPhy_Handle hPhy, const EnetPhy_Cfg *cfg, EnetPhy_Mii mii);
+    void (*reset)(EnetPhy_Handle hPhy);
+    bool (*isResetComplete)(EnetPhy_Handle hPhy);
+    int32_t (*readExtReg)(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+    int32_t (*writeExtReg)(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+    void (*printRegs)(EnetPhy_Handle hPhy);
+} EnetPhy_Drv;
+
+EnetPhy_Handle EnetPhy_open(Enet_Handle hEnet, Enet_MacPort macPort, const EnetPhy_Cfg *cfg);
+void EnetPhy_setExtendedCfg(EnetPhy_Cfg *phyCfg, const void *extendedCfg, uint32_t extendedCfgSize);
+int32_t EnetPhy_readReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t *val);
+int32_t EnetPhy_writeReg(EnetPhy_Handle hPhy, uint32_t reg, uint16_t val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENETPHY_H_ */
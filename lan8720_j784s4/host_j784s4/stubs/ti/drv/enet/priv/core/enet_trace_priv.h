@@ -0,0 +1,18 @@
+/*
+ * Host stand-in for the Enet LLD trace macros. Errors and warnings go to
+ * stderr, the rest is compiled out.
+ */
+#ifndef ENET_TRACE_PRIV_H_
+#define ENET_TRACE_PRIV_H_
+
+#include <stdio.h>
+#include <ti/drv/enet/enet_cfg.h>
+
+#define ENETTRACE_ERR(status, fmt, ...) \
+    fprintf(stderr, "ERR %d: " fmt "\n", (int)(status), ##__VA_ARGS__)
+#define ENETTRACE_WARN(fmt, ...)     do { } while (0)
+#define ENETTRACE_INFO(fmt, ...)     do { } while (0)
+#define ENETTRACE_DBG(fmt, ...)      do { } while (0)
+#define ENETTRACE_VERBOSE(fmt, ...)  do { } while (0)
+
+#endif /* ENET_TRACE_PRIV_H_ */
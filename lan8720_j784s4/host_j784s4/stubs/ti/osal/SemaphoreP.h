@@ -0,0 +1,49 @@
+/*
+ * Host stand-in for the OSAL semaphores, on POSIX threads. Timeouts are in
+ * milliseconds.
+ */
+#ifndef SEMAPHOREP_H_
+#define SEMAPHOREP_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SemaphoreP_WAIT_FOREVER  (~((uint32_t)0U))
+#define SemaphoreP_NO_WAIT       ((uint32_t)0U)
+
+typedef void *SemaphoreP_Handle;
+
+typedef enum SemaphoreP_Status_e
+{
+    SemaphoreP_OK      = 0,
+    SemaphoreP_FAILURE = -1,
+    SemaphoreP_TIMEOUT = -2,
+} SemaphoreP_Status;
+
+typedef enum SemaphoreP_Mode_e
+{
+    SemaphoreP_Mode_COUNTING = 0,
+    SemaphoreP_Mode_BINARY   = 1,
+} SemaphoreP_Mode;
+
+typedef struct SemaphoreP_Params_s
+{
+    char *name;
+    SemaphoreP_Mode mode;
+    uint32_t maxCount;
+} SemaphoreP_Params;
+
+void SemaphoreP_Params_init(SemaphoreP_Params *params);
+SemaphoreP_Handle SemaphoreP_create(uint32_t count, const SemaphoreP_Params *params);
+SemaphoreP_Status SemaphoreP_delete(SemaphoreP_Handle handle);
+SemaphoreP_Status SemaphoreP_pend(SemaphoreP_Handle handle, uint32_t timeout);
+SemaphoreP_Status SemaphoreP_post(SemaphoreP_Handle handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SEMAPHOREP_H_ */
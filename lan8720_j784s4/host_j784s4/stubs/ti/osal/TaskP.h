@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for the OSAL task services.
+ */
+#ifndef TASKP_H_
+#define TASKP_H_
+
+#include <stdint.h>
+
+void TaskP_yield(void);
+void TaskP_sleep(uint32_t timeout);
+
+#endif /* TASKP_H_ */
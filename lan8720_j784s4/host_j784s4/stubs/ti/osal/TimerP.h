@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for the OSAL timer: the monotonic clock, which the tests
+ * can move forward with HostSim_advanceTime().
+ */
+#ifndef TIMERP_H_
+#define TIMERP_H_
+
+#include <stdint.h>
+
+uint64_t TimerP_getTimeInUsecs(void);
+
+#endif /* TIMERP_H_ */
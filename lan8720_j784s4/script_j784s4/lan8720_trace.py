@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# Decoder for the LAN8720 driver binary trace ring.
+#
+# The ring is returned by Ethernet_getTrace() (symbol gEthernetTrace). Save it
+# to a file, for example with the CCS memory browser or by writing the
+# buffer out from the application, then run:
+#
+#   python3 lan8720_trace.py trace.bin
+#
+# The file may be a larger memory dump; the ring is located by its magic.
+
+import argparse
+import struct
+import sys
+
+TRACE_MAGIC = 0x4C4E5452
+HDR_FMT = "<IHHII"            # magic, recSize, numRecs, head, rsvd
+REC_FMT = "<IHBbII"
+HDR_SIZE = struct.calcsize(HDR_FMT)
+REC_SIZE = struct.calcsize(REC_FMT)
+
+# Must match Ethernet_TraceEvent in lan8720.h
+EVENTS = {
+    1: "TX",
+    2: "TX_BURST",
+    3: "TX_ALLOC_FAIL",
+    4: "TX_RECLAIM",
+    5: "RX",
+    6: "CHAN_RX",
+    7: "DEV_EVENT",
+    8: "LINK",
+}
+
+# Device task event bits, see ETHERNET_EVENT_* in lan8720.c
+DEV_EVENTS = ["PHY", "RX", "TX", "RECYCLE", "LINK"]
+
+
+def find_ring(data):
+    magic = struct.pack("<I", TRACE_MAGIC)
+    off = data.find(magic)
+    while off >= 0:
+        _, rec_size, num_recs, head, _ = struct.unpack_from(HDR_FMT, data, off)
+        end = off + HDR_SIZE + rec_size * num_recs
+        if rec_size == REC_SIZE and num_recs > 0 and end <= len(data):
+            return off, num_recs, head
+        off = data.find(magic, off + 1)
+    return None
+
+
+def describe(event, length, status, arg):
+    if event == 2:
+        return "frames=%u bytes=%u" % (arg, length)
+    if event == 4:
+        return "pkts=%u" % arg
+    if event == 6:
+        return "chan=%u len=%u" % (arg, length)
+    if event == 7:
+        names = [n for i, n in enumerate(DEV_EVENTS) if arg & (1 << i)]
+        return "events=%s" % ("|".join(names) if names else "0x%x" % arg)
+    if event == 8:
+        return "up" if arg else "down"
+    if event == 3:
+        return ""
+    return "len=%u" % length
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a LAN8720 driver trace ring dump")
+    parser.add_argument("dump", help="binary dump containing gEthernetTrace")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as f:
+        data = f.read()
+
+    ring = find_ring(data)
+    if ring is None:
+        sys.exit("no trace ring found in %s" % args.dump)
+    off, num_recs, head = ring
+
+    # head counts every record written; the ring holds the last num_recs
+    count = min(head, num_recs)
+    first = head - count
+    print("%u records written, showing the last %u" % (head, count))
+
+    prev = None
+    for seq in range(first, head):
+        pos = off + HDR_SIZE + (seq % num_recs) * REC_SIZE
+        time_us, event, port, status, length, arg = struct.unpack_from(REC_FMT, data, pos)
+        delta = "" if prev is None else "+%u" % ((time_us - prev) & 0xFFFFFFFF)
+        prev = time_us
+        print("%8u %12u %10s  port %u  %-13s %-4s %s" %
+              (seq, time_us, delta, port, EVENTS.get(event, "EVT%u" % event),
+               "ERR" if status != 0 else "", describe(event, length, status, arg)))
+
+
+if __name__ == "__main__":
+    main()